@@ -40,6 +40,8 @@
 #define COLLIDE_UP (1 << 1)
 #define COLLIDE_LEFT (1 << 2)
 #define COLLIDE_RIGHT (1 << 3)
+#define COLLIDE_HAZARD (1 << 4) // Box touches a SGP_TILE_HAZARD tile (typed levels only)
+#define COLLIDE_SIDES (COLLIDE_DOWN | COLLIDE_UP | COLLIDE_LEFT | COLLIDE_RIGHT)
 
 // Bitwise flag helper macros
 #define SET_ACTIVE(flags, mask) ((flags) |= (mask))
@@ -47,12 +49,117 @@
 #define FLAG_IS_ACTIVE(flags, mask) (((flags) & (mask)) != 0)
 #define FLAG_IS_INACTIVE(flags, mask) (((flags) & (mask)) == 0)
 
+// Camera types (SGPCamera.type)
+#define CAMERA_LOCKED 0   // Camera pinned to the target (default)
+#define CAMERA_DEADZONE 1 // Camera only moves once the target leaves the deadzone window
+#define CAMERA_SMOOTH 2   // Deadzone plus shift-based easing with a sub-pixel position
+
+// Camera shake decay table: 2^SGP_SHAKE_TABLE_SHIFT entries spread over the shake duration
+#define SGP_SHAKE_TABLE_SHIFT 4
+#define SGP_SHAKE_TABLE_SIZE (1 << SGP_SHAKE_TABLE_SHIFT)
+
+// Parallax configuration (define before including sgp.h to override)
+#ifndef SGP_PARALLAX_MAX_BANDS
+#define SGP_PARALLAX_MAX_BANDS 8
+#endif
+#define SGP_PARALLAX_MAX_LINES 240 // Enough scanlines for PAL; tile mode uses the first 30 entries
+#define SGP_PARALLAX_RATIO_ONE 0x100 // 8.8 ratio for a band that scrolls 1:1 with the camera
+#define SGP_PARALLAX_NONE 0xFF
+#if SGP_PARALLAX_MAX_BANDS > 254
+#error "SGP_PARALLAX_MAX_BANDS must be at most 254"
+#endif
+
 #define SGP_OOB_HORIZONTAL_SOLID true
 #define SGP_OOB_HORIZONTAL_PASSABLE false
 
+// Joypads polled by SGP_PollInput (define before including sgp.h to override).
+// Use up to 8 with a Team Player/4-Way Play adapter (see JOY_setSupport).
+#ifndef SGP_INPUT_PAD_COUNT
+#define SGP_INPUT_PAD_COUNT 2
+#endif
+#define SGP_INPUT_PAD_SLOTS 8 // One slot per SGDK JOY_1..JOY_8, indexed with joy & SGP_INPUT_PAD_MASK
+#define SGP_INPUT_PAD_MASK (SGP_INPUT_PAD_SLOTS - 1)
+#if SGP_INPUT_PAD_COUNT < 1 || SGP_INPUT_PAD_COUNT > SGP_INPUT_PAD_SLOTS
+#error "SGP_INPUT_PAD_COUNT must be between 1 and 8"
+#endif
+
+// Input history ring buffer: 2^SGP_INPUT_HISTORY_SHIFT frames per polled pad
+#ifndef SGP_INPUT_HISTORY_SHIFT
+#define SGP_INPUT_HISTORY_SHIFT 5
+#endif
+#define SGP_INPUT_HISTORY_SIZE (1 << SGP_INPUT_HISTORY_SHIFT)
+#define SGP_INPUT_HISTORY_MASK (SGP_INPUT_HISTORY_SIZE - 1)
+#if SGP_INPUT_HISTORY_SHIFT < 1 || SGP_INPUT_HISTORY_SHIFT > 8
+#error "SGP_INPUT_HISTORY_SHIFT must be between 1 and 8"
+#endif
+
 // Maximum number of player entities
 #define SGP_MAX_PLAYER_COUNT 2
 
+// Collision tile size: 2^SGP_COLLISION_TILE_SHIFT pixels (define before including sgp.h to override).
+// 4 matches SGDK's 16x16 metatiles; 3 gives 8x8 collision tiles for finer-grained stages.
+#ifndef SGP_COLLISION_TILE_SHIFT
+#define SGP_COLLISION_TILE_SHIFT 4
+#endif
+#define SGP_COLLISION_TILE_SIZE (1 << SGP_COLLISION_TILE_SHIFT)
+#if SGP_COLLISION_TILE_SHIFT < 3 || SGP_COLLISION_TILE_SHIFT > 7
+#error "SGP_COLLISION_TILE_SHIFT must be between 3 and 7"
+#endif
+
+// Map block size in pixels as a shift: SGDK maps count 128x128 pixel blocks
+#ifndef SGP_MAP_BLOCK_SHIFT
+#define SGP_MAP_BLOCK_SHIFT 7
+#endif
+#if SGP_MAP_BLOCK_SHIFT < SGP_COLLISION_TILE_SHIFT
+#error "SGP_MAP_BLOCK_SHIFT must be at least SGP_COLLISION_TILE_SHIFT"
+#endif
+
+// Block-based collision layouts (deduplicated and streamed) split levels into map-sized blocks
+#define SGP_COLLISION_BLOCK_SHIFT (SGP_MAP_BLOCK_SHIFT - SGP_COLLISION_TILE_SHIFT) // log2 tiles per block side
+#define SGP_COLLISION_BLOCK_TILES (1 << SGP_COLLISION_BLOCK_SHIFT)
+#define SGP_COLLISION_BLOCK_MASK (SGP_COLLISION_BLOCK_TILES - 1)
+#define SGP_COLLISION_MAX_BLOCKS (0x8000 >> SGP_MAP_BLOCK_SHIFT) // Blocks per axis that keep pixels in s16
+
+// Deduplicated block map entries: u16 by default, define SGP_BLOCK_INDEX_U8 for up to 256 patterns
+#ifdef SGP_BLOCK_INDEX_U8
+typedef u8 SGPBlockIndex;
+#define SGP_BLOCK_INDEX_MAX_PATTERNS 256
+#else
+typedef u16 SGPBlockIndex;
+#define SGP_BLOCK_INDEX_MAX_PATTERNS 0xFFFF // Pattern count is a u16
+#endif
+
+// Streamed collision (SGPCollisionStream): levels are stored as compressed map-sized blocks and
+// a resident window of 2^SGP_STREAM_WINDOW_SHIFT_X x 2^SGP_STREAM_WINDOW_SHIFT_Y blocks is cached
+// in RAM. The defaults (1024x512 pixels) cost 2KB with 16px tiles and 8KB with 8px tiles.
+#ifndef SGP_STREAM_WINDOW_SHIFT_X
+#define SGP_STREAM_WINDOW_SHIFT_X 3
+#endif
+#ifndef SGP_STREAM_WINDOW_SHIFT_Y
+#define SGP_STREAM_WINDOW_SHIFT_Y 2
+#endif
+#if SGP_STREAM_WINDOW_SHIFT_X < 2 || SGP_STREAM_WINDOW_SHIFT_Y < 2 || SGP_STREAM_WINDOW_SHIFT_X > 4 || SGP_STREAM_WINDOW_SHIFT_Y > 4
+#error "SGP_STREAM_WINDOW_SHIFT_X/Y must be between 2 and 4 (the window has to cover the screen)"
+#endif
+#define SGP_STREAM_WINDOW_W (1 << SGP_STREAM_WINDOW_SHIFT_X) // Resident window width in blocks
+#define SGP_STREAM_WINDOW_H (1 << SGP_STREAM_WINDOW_SHIFT_Y)
+#define SGP_STREAM_CACHE_COLS (SGP_STREAM_WINDOW_W << SGP_COLLISION_BLOCK_SHIFT) // Resident window in tiles
+#define SGP_STREAM_CACHE_ROWS (SGP_STREAM_WINDOW_H << SGP_COLLISION_BLOCK_SHIFT)
+#define SGP_STREAM_NO_BLOCK 0xFFFF
+
+// Optional fixed level layout (define before including sgp.h). With SGP_LEVEL_ROW_SHIFT every
+// level has 2^SGP_LEVEL_ROW_SHIFT tiles per row, so tile indexing and bounds checks use constants
+// that fold into the collision functions; SGP_LEVEL_ROWS also fixes the row count.
+#ifdef SGP_LEVEL_ROW_SHIFT
+#if SGP_LEVEL_ROW_SHIFT < 1 || SGP_LEVEL_ROW_SHIFT > 12
+#error "SGP_LEVEL_ROW_SHIFT must be between 1 and 12"
+#endif
+#define SGP_LEVEL_ROW_LENGTH (1 << SGP_LEVEL_ROW_SHIFT)
+#endif
+#if defined(SGP_LEVEL_ROWS) && (SGP_LEVEL_ROWS < 1 || SGP_LEVEL_ROWS > 0x7FFF)
+#error "SGP_LEVEL_ROWS must be between 1 and 32767"
+#endif
+
 static const u16 SOLID_TILE = 1;
 /**
  * On the 68000 (m68k) architecture, the m68k-elf-cc compiler (GCC for m68k)
@@ -61,26 +168,74 @@ static const u16 SOLID_TILE = 1;
  * For powers of two (e.g., % 16):
  * The compiler will optimize x % 16 to x & 15 (a bitwise AND), which is very fast and efficient.
  */
-static const u16 COLLISION_TILE_SIZE_MASK = 15;
-static const u16 PIXELS_TO_TILE_SHIFT = 4; // 16 pixels per tile
+static const u16 COLLISION_TILE_SIZE_MASK = SGP_COLLISION_TILE_SIZE - 1;
+static const u16 PIXELS_TO_TILE_SHIFT = SGP_COLLISION_TILE_SHIFT; // 16 pixels per tile by default
 
 // Each metatile is 16x16 pixels, so 128x128 pixels block is 8x8 metatiles
-static inline u16 SGP_MetatilesToPixels(u16 x) { return x << 7; }
+static inline u16 SGP_MetatilesToPixels(u16 x) { return x << SGP_MAP_BLOCK_SHIFT; }
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
 //----------------------------------------------------------------------------------
+// Input modes (SGPInput.mode)
+#define SGP_INPUT_LIVE 0   // Read the joypads
+#define SGP_INPUT_RECORD 1 // Read the joypads and log them to the stream
+#define SGP_INPUT_REPLAY 2 // Feed the stream back instead of reading the joypads
+
+/**
+ * @brief Run-length-encoded pad stream for deterministic record/replay.
+ *
+ * Layout in u16 words: [SGP_INPUT_PAD_COUNT] then records of [run, pad0 .. padN-1],
+ * where run is the number of consecutive frames with those pad states.
+ */
+typedef struct
+{
+    u16 *data;     // Caller-owned buffer
+    u16 capacity;  // Buffer size in words
+    u16 length;    // Words in use
+    u16 pos;       // Replay: next record
+    u16 record;    // Replay: pad words of the current record
+    u16 run_left;  // Replay: frames left in the current record
+    bool overflow; // Record: buffer filled up, later frames dropped
+    bool done;     // Replay: stream exhausted, pads read as idle
+} SGPInputStream;
+
 /**
- * @brief Input state for joypads.
+ * @brief Input state for joypads, indexed by SGDK joy id (JOY_1, JOY_2, ...).
+ *
+ * Edge masks are computed once per frame by SGP_PollInput. Slots beyond
+ * SGP_INPUT_PAD_COUNT stay zero, so unused or invalid ids read as released.
  */
 typedef struct
 {
-    u16 joy1_state;    // Current state of joypad 1
-    u16 joy2_state;    // Current state of joypad 2
-    u16 joy1_previous; // Previous state of joypad 1
-    u16 joy2_previous; // Previous state of joypad 2
+    u16 state[SGP_INPUT_PAD_SLOTS];    // Buttons held this frame (incl. 6-button X/Y/Z/MODE)
+    u16 previous[SGP_INPUT_PAD_SLOTS]; // Buttons held last frame
+    u16 pressed[SGP_INPUT_PAD_SLOTS];  // Buttons that went down this frame
+    u16 released[SGP_INPUT_PAD_SLOTS]; // Buttons that went up this frame
+    u16 joy1_state;                    // Legacy copies of state/previous for JOY_1 and JOY_2,
+    u16 joy2_state;                    // kept in sync by SGP_PollInput
+    u16 joy1_previous;
+    u16 joy2_previous;
+    u16 frame;                         // Frame stamp, incremented by every SGP_PollInput
+    u16 history_len;                   // Valid history entries (saturates at SGP_INPUT_HISTORY_SIZE)
+    u16 history_state[SGP_INPUT_PAD_COUNT][SGP_INPUT_HISTORY_SIZE];   // Held buttons, slot frame & mask
+    u16 history_pressed[SGP_INPUT_PAD_COUNT][SGP_INPUT_HISTORY_SIZE]; // Pressed edges, slot frame & mask
+    u8 mode;                           // SGP_INPUT_LIVE, SGP_INPUT_RECORD or SGP_INPUT_REPLAY
+    SGPInputStream *stream;            // Stream used by record/replay
 } SGPInput;
 
+/**
+ * @brief One step of an input sequence: matches when (buttons & mask) == value.
+ *
+ * With pressed set the step compares the frame's pressed edges instead of held buttons.
+ */
+typedef struct
+{
+    u16 mask;
+    u16 value;
+    bool pressed;
+} SGPInputStep;
+
 typedef struct
 {
     Map *current;
@@ -89,6 +244,38 @@ typedef struct
     u16 width;
 } SGPMap;
 
+/**
+ * @brief One horizontal parallax band: a run of scanlines (or tile rows) scrolling at one rate.
+ */
+typedef struct
+{
+    u16 first; // First scanline (HSCROLL_LINE) or tile row (HSCROLL_TILE) of the band
+    u16 count; // Number of scanlines or tile rows covered
+    u16 ratio; // Scroll rate relative to the camera, 8.8 fixed point (0x100 = 1:1)
+    s16 value; // Last scroll value written to the table
+    bool dirty; // Forces the band to be rewritten on the next update
+} SGPParallaxBand;
+
+/**
+ * @brief Per-plane parallax layer: a band-filled hscroll table uploaded by one queued DMA.
+ *
+ * Attached to the camera with SGP_CameraAddParallax; several layers (e.g. BG_A and BG_B)
+ * are chained through next.
+ */
+typedef struct SGPParallax
+{
+    VDPPlane plane;   // Plane this layer drives
+    u16 mode;         // HSCROLL_PLANE, HSCROLL_LINE or HSCROLL_TILE
+    u8 band_count;
+    SGPParallaxBand bands[SGP_PARALLAX_MAX_BANDS];
+    u16 v_ratio;      // Vertical scroll rate, 8.8 fixed point (clamped to max_vertical_scroll)
+    s16 v_value;      // Last vertical scroll written
+    bool v_dirty;
+    bool dirty;       // A ratio or band changed: the camera updates the layer even if it did not move
+    s16 hscroll[SGP_PARALLAX_MAX_LINES]; // DMA source; must stay valid until VBlank
+    struct SGPParallax *next;
+} SGPParallax;
+
 /**
  * @brief Camera state for smooth scrolling and transformations.
  *
@@ -96,7 +283,7 @@ typedef struct
  */
 typedef struct
 {
-    u8 type;         // Camera type (e.g. CAMERA_SMOOTH)
+    u8 type;         // Camera type (CAMERA_LOCKED, CAMERA_DEADZONE or CAMERA_SMOOTH)
     u32 current_x;   // Camera X position (integer for MAP_scrollTo)
     u32 current_y;   // Camera Y position (integer for MAP_scrollTo)
     Sprite *sprite;
@@ -105,6 +292,21 @@ typedef struct
     u16 map_height;
     u16 map_width;
     u16 max_vertical_scroll; // in Tiles (default 32), used to limit camera scroll
+    u16 stream_budget;       // Plane upload budget in bytes per frame (0 = unlimited)
+    bool stream_pending;     // Camera is still catching up with its target under the budget
+    u16 deadzone_w;          // Half-width of the deadzone window in pixels
+    u16 deadzone_h;          // Half-height of the deadzone window in pixels
+    u8 smooth_shift;         // CAMERA_SMOOTH easing: moves 1/2^shift of the distance per frame
+    fix32 smooth_x;          // CAMERA_SMOOTH sub-pixel position
+    fix32 smooth_y;
+    u16 shake_frames;        // Frames left in the current shake (0 = idle)
+    u16 shake_phase;         // Position in shake_table (8.8 fixed point)
+    u16 shake_step;          // shake_table advance per frame (8.8 fixed point)
+    s16 shake_offset;        // Shake offset committed with the last scroll
+    s16 shake_table[SGP_SHAKE_TABLE_SIZE]; // Decaying magnitudes, filled at shake start
+    SGPParallax *parallax;   // Parallax layers driven by the camera (NULL = legacy BG_B scroll)
+    s16 view_x;              // Scroll position committed last (shake applied), used to place sprites
+    s16 view_y;
 } SGPCamera;
 
 typedef struct
@@ -115,8 +317,115 @@ typedef struct
     u16 h; // Height of the box
 } SGPBox;
 
+// Uniform-grid broadphase configuration (define before including sgp.h to override)
+#ifndef SGP_BROADPHASE_CELL_SHIFT
+#define SGP_BROADPHASE_CELL_SHIFT 6 // 64x64 pixel cells
+#endif
+#ifndef SGP_BROADPHASE_COLS
+#define SGP_BROADPHASE_COLS 5 // 320 / 64
+#endif
+#ifndef SGP_BROADPHASE_ROWS
+#define SGP_BROADPHASE_ROWS 4 // 224 / 64, rounded up
+#endif
+#ifndef SGP_BROADPHASE_MAX_ENTRIES
+#define SGP_BROADPHASE_MAX_ENTRIES 128 // Box-in-cell entries, a box covers 1 to 4 cells on screen
+#endif
+#if SGP_BROADPHASE_MAX_ENTRIES > 255
+#error "SGP_BROADPHASE_MAX_ENTRIES must fit in a u8 index"
+#endif
+#define SGP_BROADPHASE_CELLS (SGP_BROADPHASE_COLS * SGP_BROADPHASE_ROWS)
+#define SGP_BROADPHASE_NONE 0xFF
+
+/**
+ * @brief Screen-space bucket grid of SGPBox references, refilled every frame.
+ *
+ * All storage is static inside the struct. Boxes outside the grid are clamped into the edge
+ * cells, so they are still found, just without the spatial speedup.
+ */
+typedef struct
+{
+    s16 origin_x;                                      // World X of the grid's top-left corner
+    s16 origin_y;                                      // World Y of the grid's top-left corner
+    u16 entry_count;                                   // Entries used this frame
+    u8 cell_head[SGP_BROADPHASE_CELLS];                // First entry per cell, SGP_BROADPHASE_NONE if empty
+    u8 entry_next[SGP_BROADPHASE_MAX_ENTRIES];         // Next entry in the same cell
+    u16 entry_id[SGP_BROADPHASE_MAX_ENTRIES];          // Caller id of the box
+    const SGPBox *entry_box[SGP_BROADPHASE_MAX_ENTRIES]; // Box, must stay valid until the next clear
+} SGPBroadphase;
+
 /**
- * @brief Platform-wide state for input and camera.
+ * @brief Pair iterator state for SGP_BroadphaseNextPair.
+ *
+ * Start it with SGP_BroadphasePairsBegin or zero it (`= {0}`, static storage): both start at
+ * the first cell. a == b only before a cell is loaded, since an entry never follows itself.
+ */
+typedef struct
+{
+    u16 cell;
+    u8 a;
+    u8 b;
+} SGPBroadphasePairIter;
+
+// VDP command queue (see SGP_VdpQueueInit)
+#ifndef SGP_VDP_QUEUE_TEXT_SLOTS
+#define SGP_VDP_QUEUE_TEXT_SLOTS 8 // Queued text runs per frame (debug rows use up to 5)
+#endif
+#define SGP_VDP_QUEUE_TEXT_CHARS 40 // Longest queued text run: one screen row
+
+// SGPVdpQueue.pending / known bits
+#define SGP_VDP_MAP (1 << 0)
+#define SGP_VDP_HSCROLL_A (1 << 1)
+#define SGP_VDP_HSCROLL_B (1 << 2)
+#define SGP_VDP_VSCROLL_A (1 << 3)
+#define SGP_VDP_VSCROLL_B (1 << 4)
+#define SGP_VDP_WINDOW (1 << 5)
+
+/**
+ * @brief One queued text run.
+ */
+typedef struct
+{
+    VDPPlane plane;
+    u16 attr;
+    u16 x;
+    u16 y;
+    char text[SGP_VDP_QUEUE_TEXT_CHARS + 1];
+} SGPVdpText;
+
+/**
+ * @brief VDP writes recorded during the frame, applied once per frame (sgp.vdp).
+ *
+ * Each scroll or register target holds only its last value, text runs at the same position
+ * replace each other, and values equal to the last one written are dropped when applied,
+ * so a frame costs at most one write per target however often SGP updates it. The map scroll
+ * and text are applied from the main loop by SGP_VdpQueueCommit, the scroll and window
+ * registers from VBlank by SGP_VdpQueueFlush.
+ */
+typedef struct
+{
+    bool enabled;      // SGP writes are queued (else issued immediately)
+    u8 pending;        // SGP_VDP_* targets waiting for the flush
+    u8 known;          // SGP_VDP_* targets whose last written value is cached below
+    Map *map;          // Queued MAP_scrollTo
+    u32 map_x;
+    u32 map_y;
+    u32 written_map_x; // Last map scroll written
+    u32 written_map_y;
+    s16 hscroll[2];    // Plane scroll, [0] BG_A, [1] BG_B; queued, then last written
+    s16 vscroll[2];
+    s16 written_hscroll[2];
+    s16 written_vscroll[2];
+    bool window_enable;
+    u16 window_pos;
+    bool written_window_enable;
+    u16 written_window_pos;
+    u8 text_count;
+    SGPVdpText text[SGP_VDP_QUEUE_TEXT_SLOTS];
+    u16 dropped;       // Redundant writes removed since SGP_VdpQueueInit
+} SGPVdpQueue;
+
+/**
+ * @brief Platform-wide state for input, camera and the VDP command queue.
  *
  * Holds current and previous joypad states for both controllers,
  * as well as camera position, zoom, and rotation in fixed-point.
@@ -125,6 +434,7 @@ typedef struct
 {
     SGPInput input;   // Input state
     SGPCamera camera; // Camera state
+    SGPVdpQueue vdp;  // Queued VDP writes
 } SGP;
 
 /**
@@ -138,13 +448,289 @@ typedef enum
     SGP_DIR_RIGHT = 8
 } SGPMovementDirection;
 
+// SGPLevelCollisionData.prepare_flags bitmasks (set by SGP_LevelCollisionPrepare)
+#define SGP_LEVEL_PREPARED (1 << 0)  // total_rows is cached, no division on the query path
+#define SGP_LEVEL_POW2_ROWS (1 << 1) // row_length is a power of two, rows are indexed with row_shift
+#define SGP_LEVEL_ROW_TABLE (1 << 2) // row_offsets holds the start index of every row
+
+// Tile type flags (SGPTileType.flags)
+#define SGP_TILE_SOLID (1 << 0)   // Blocks from every side
+#define SGP_TILE_ONE_WAY (1 << 1) // Floor only: lands from above, passable from below and the sides
+#define SGP_TILE_HAZARD (1 << 2)  // Reported as COLLIDE_HAZARD when touched
+#define SGP_TILE_SLOPE (1 << 3)   // Floor only: surface height per pixel column from heights[]
+#define SGP_NO_FLOOR 0x7FFF       // Floor query result when no surface was found
+
+// Landing band of one-way tiles for post-move DOWN checks (SGP_PlayerLevelCollision)
+#ifndef SGP_ONE_WAY_DEPTH
+#define SGP_ONE_WAY_DEPTH (SGP_COLLISION_TILE_SIZE >> 2)
+#endif
+
+/**
+ * @brief Behaviour of one collision byte value in a typed level.
+ *
+ * A typed level's tile_types table is indexed directly by collision byte, so every check is
+ * one table load instead of a per-tile switch. heights[] holds SGP_COLLISION_TILE_SIZE entries,
+ * the solid height of each pixel column measured from the tile bottom (0 = empty column).
+ */
+typedef struct
+{
+    u8 flags;          // SGP_TILE_* flags
+    const u8 *heights; // SGP_TILE_SLOPE height map, NULL otherwise
+} SGPTileType;
+
+/**
+ * @brief Streamed collision: RLE blocks in ROM, decoded around the camera into a RAM ring cache.
+ *
+ * The level is split into square blocks of SGP_COLLISION_BLOCK_TILES tiles (one SGDK map block,
+ * see SGP_MetatilesToPixels), each compressed with SGP_CollisionStreamEncode. The cache is a
+ * toroidal tile array: block (bx, by) always lands in slot (bx & (W - 1), by & (H - 1)), so
+ * scrolling only decodes the blocks entering the window and a tile lookup is two masks.
+ * Levels are limited to SGP_COLLISION_MAX_BLOCKS blocks per axis, not to 64K tiles.
+ */
+typedef struct
+{
+    const u8 *rle_data;       // Compressed blocks, usually in ROM
+    const u32 *block_offsets; // Start of every block in rle_data, row-major
+    u16 blocks_w;             // Level size in blocks
+    u16 blocks_h;
+    s16 origin_x;             // Resident window top-left, in blocks
+    s16 origin_y;
+    bool pending;             // Last update ran out of budget before the window was resident
+    u16 slot_x[SGP_STREAM_WINDOW_W * SGP_STREAM_WINDOW_H]; // Block held by each slot, SGP_STREAM_NO_BLOCK if none
+    u16 slot_y[SGP_STREAM_WINDOW_W * SGP_STREAM_WINDOW_H];
+    u8 tiles[SGP_STREAM_CACHE_ROWS][SGP_STREAM_CACHE_COLS]; // Toroidal tile cache
+} SGPCollisionStream;
+
 typedef struct
 {
     u16 row_length;
     u16 data_length;
     const u8 *collision_data;
+    // Cached layout, filled by SGP_LevelCollisionPrepare (leave zeroed in initializers)
+    u16 total_rows;         // data_length / row_length
+    u8 prepare_flags;       // SGP_LEVEL_* flags
+    u8 row_shift;           // log2(row_length) when SGP_LEVEL_POW2_ROWS is set
+    const u16 *row_offsets; // Optional row start table (total_rows entries), NULL if unused
+    // Optional 1 bit per tile solid map (see SGP_PackCollisionRows), NULL if unused
+    const u16 *solid_bits;
+    // Optional tile type table indexed by collision byte (covering every byte used), NULL if
+    // only SOLID_TILE is solid. Floor, one-way and hazard queries read collision_data or the stream.
+    const SGPTileType *tile_types;
+    // Streamed level (see SGP_CollisionStreamInit): tiles come from the resident window, NULL if unused
+    const SGPCollisionStream *stream;
+    // Deduplicated level (see SGP_LevelBlocksInit): pattern index per block, NULL if unused
+    const SGPBlockIndex *block_map;        // Rows of 2^block_map_shift entries
+    const u8 *block_patterns;              // Unique blocks, SGP_COLLISION_BLOCK_TILES^2 bytes each
+    u8 block_map_shift;
 } SGPLevelCollisionData;
 
+/**
+ * @brief Caller-owned level collision cache for one entity.
+ *
+ * Embed one per entity (players, enemies, projectiles) instead of relying on the per-player
+ * cache inside SGP_PlayerLevelCollision. Results are cached per direction and stay valid while
+ * the box position and level are unchanged.
+ */
+typedef struct
+{
+    const SGPLevelCollisionData *level; // Level the cached flags belong to
+    s16 x;                              // Collision box left, updated by the owner each frame
+    s16 y;                              // Collision box top, updated by the owner each frame
+    u16 width;                          // Collision box width
+    u16 height;                         // Collision box height
+    s16 last_x;                         // Position the cached flags were resolved at
+    s16 last_y;
+    u16 known;                          // COLLIDE_* bits cached for last_x/last_y
+    u16 flags;                          // Cached COLLIDE_* results
+} SGPCollisionContext;
+
+/**
+ * @brief Segment for SGP_LevelRaycast, world pixels.
+ */
+typedef struct
+{
+    s16 x0; // Origin
+    s16 y0;
+    s16 x1; // End; the ray never looks past it
+    s16 y1;
+} SGPRay;
+
+/**
+ * @brief Result of a raycast.
+ */
+typedef struct
+{
+    bool hit;     // A solid (or OOB) tile was reached before the end
+    u16 side;     // COLLIDE_* side of the ray that met the tile (COLLIDE_RIGHT going right), 0 if none
+    s16 tile_x;   // Hit tile, or the end tile when clear
+    s16 tile_y;
+    s16 x;        // First pixel inside the hit tile along the ray, or the end point when clear
+    s16 y;
+    u16 distance; // Approximate pixel distance from the origin to (x, y), within 7%
+} SGPRayHit;
+
+#define SGP_TRIGGER_NONE 0xFFFF // SGP_TriggerLayerFind result when no trigger covers the tile
+
+/**
+ * @brief One tile of a trigger (door, checkpoint, spike, pickup), in collision tile coordinates.
+ *
+ * A trigger larger than one tile is one entry per covered tile sharing the same id.
+ */
+typedef struct
+{
+    u16 tile_y; // Sort key: row first, then column
+    u16 tile_x;
+    u16 type;   // Caller-defined kind
+    u16 id;     // Caller-defined payload (pickup slot, door target...)
+} SGPTrigger;
+
+/**
+ * @brief Sparse trigger index kept next to a level's SGPLevelCollisionData.
+ *
+ * Entries are sorted by (tile_y, tile_x) at build time (SGP_TriggerSort), so a box query is one
+ * binary search per covered tile row: the cost follows the box size and log2 of the trigger
+ * count, not the number of triggers in the level.
+ */
+typedef struct
+{
+    const SGPTrigger *triggers; // Sorted entries, usually in ROM
+    u16 count;
+} SGPTriggerLayer;
+
+// Flow field window: 2^SGP_FLOW_SHIFT_X x 2^SGP_FLOW_SHIFT_Y tiles around the target (define before
+// including sgp.h to override). The defaults (512x256 pixels with 16px tiles) cost 2KB of RAM.
+#ifndef SGP_FLOW_SHIFT_X
+#define SGP_FLOW_SHIFT_X 5
+#endif
+#ifndef SGP_FLOW_SHIFT_Y
+#define SGP_FLOW_SHIFT_Y 4
+#endif
+#if SGP_FLOW_SHIFT_X < 2 || SGP_FLOW_SHIFT_Y < 2 || SGP_FLOW_SHIFT_X + SGP_FLOW_SHIFT_Y > 12
+#error "SGP_FLOW_SHIFT_X/Y must be at least 2 and cover at most 4096 tiles together"
+#endif
+#define SGP_FLOW_W (1 << SGP_FLOW_SHIFT_X)
+#define SGP_FLOW_H (1 << SGP_FLOW_SHIFT_Y)
+#define SGP_FLOW_NODES (SGP_FLOW_W * SGP_FLOW_H)
+#define SGP_FLOW_REACHED 0x80 // Step byte flag: the tile was reached; the low bits hold its SGP_DIR_* step
+
+/**
+ * @brief Shared BFS flow field toward a target tile, built a few nodes per frame.
+ *
+ * Every passable tile of a window around the target stores the direction of its next step
+ * along a shortest 4-way path, so any number of chasers read their move with one table load.
+ * Builds run into a back buffer while the last finished field stays readable, and a target
+ * change during a build is queued until that build publishes, so chasers never see a half
+ * built field and a fast-moving target cannot starve the rebuild. All storage is static.
+ */
+typedef struct
+{
+    const SGPLevelCollisionData *level; // Passability source: tiles that are not solid
+    s16 target_x;                       // Target tile of the current (or last finished) build
+    s16 target_y;
+    s16 pending_x;                      // Target queued while a build was running
+    s16 pending_y;
+    bool pending;
+    bool building;                      // A build is expanding nodes into the back buffer
+    bool ready;                         // steps[front] holds a finished field
+    u8 front;                           // Buffer read by SGP_FlowFieldStep
+    s16 origin_x[2];                    // Window top-left tile of each buffer
+    s16 origin_y[2];
+    u16 head;                           // BFS queue read position
+    u16 tail;                           // BFS queue write position
+    u16 queue[SGP_FLOW_NODES];          // Window indices in BFS order, each tile enqueued once
+    u8 steps[2][SGP_FLOW_NODES];        // SGP_FLOW_REACHED | SGP_DIR_* per tile, 0 if unreached
+} SGPFlowField;
+
+// Entity pool capacity (define before including sgp.h to override)
+#ifndef SGP_ENTITY_POOL_CAPACITY
+#define SGP_ENTITY_POOL_CAPACITY 32
+#endif
+#if SGP_ENTITY_POOL_CAPACITY > 255
+#error "SGP_ENTITY_POOL_CAPACITY must fit in a u8 handle"
+#endif
+#define SGP_ENTITY_NONE 0xFF
+
+// Entity sprite states (SGPEntityPool.sprite_state), both clear until the first sprite pass
+#define SGP_SPRITE_SHOWN (1 << 0)  // Visible; screen_x/screen_y hold the committed position
+#define SGP_SPRITE_HIDDEN (1 << 1) // Culled and hidden
+
+/**
+ * @brief Fixed-capacity entity storage laid out as structure-of-arrays.
+ *
+ * Each field is its own array indexed by entity handle, so per-frame loops (move, collide,
+ * broadphase) only touch the arrays they need. Spawn and free are O(1) through a free-list;
+ * live handles are kept densely in live[0..live_count) for iteration.
+ */
+typedef struct
+{
+    fix32 x[SGP_ENTITY_POOL_CAPACITY];     // Collision box left, world pixels
+    fix32 y[SGP_ENTITY_POOL_CAPACITY];     // Collision box top, world pixels
+    fix32 vel_x[SGP_ENTITY_POOL_CAPACITY]; // Velocity in pixels per frame
+    fix32 vel_y[SGP_ENTITY_POOL_CAPACITY];
+    SGPBox box[SGP_ENTITY_POOL_CAPACITY];  // Integer collision box, synced from x/y
+    u16 flags[SGP_ENTITY_POOL_CAPACITY];   // Caller-defined flags, cleared on spawn
+    u16 contact[SGP_ENTITY_POOL_CAPACITY]; // COLLIDE_* mask from the last SGP_EntityPoolMove
+    Sprite *sprite[SGP_ENTITY_POOL_CAPACITY];
+    s16 sprite_dx[SGP_ENTITY_POOL_CAPACITY];   // Sprite offset from the collision box
+    s16 sprite_dy[SGP_ENTITY_POOL_CAPACITY];
+    s16 screen_x[SGP_ENTITY_POOL_CAPACITY];    // Last position sent to SPR_setPosition
+    s16 screen_y[SGP_ENTITY_POOL_CAPACITY];
+    u8 sprite_state[SGP_ENTITY_POOL_CAPACITY]; // SGP_SPRITE_* state
+    SGPCollisionContext collision[SGP_ENTITY_POOL_CAPACITY];
+    u8 live[SGP_ENTITY_POOL_CAPACITY];      // Dense list of live handles
+    u8 live_slot[SGP_ENTITY_POOL_CAPACITY]; // Index of each live handle in live
+    u8 next_free[SGP_ENTITY_POOL_CAPACITY]; // Free-list links
+    u8 free_head;
+    u8 live_count;
+} SGPEntityPool;
+
+// Job scheduler configuration (define before including sgp.h to override)
+#ifndef SGP_SCHEDULER_MAX_JOBS
+#define SGP_SCHEDULER_MAX_JOBS 8
+#endif
+#if SGP_SCHEDULER_MAX_JOBS > 254
+#error "SGP_SCHEDULER_MAX_JOBS must fit in a u8 handle"
+#endif
+#ifndef SGP_SCHEDULER_STOP_LINE
+#define SGP_SCHEDULER_STOP_LINE 200 // Default stop line: 24 lines left for sprites and the VBlank wait
+#endif
+#ifndef SGP_FLOW_JOB_NODES
+#define SGP_FLOW_JOB_NODES 16 // BFS nodes per SGP_FlowFieldJobStep call
+#endif
+#define SGP_JOB_NONE 0xFF
+
+// Job step results (SGPJobStep)
+#define SGP_JOB_CONTINUE 0 // More work, may be stepped again this frame
+#define SGP_JOB_YIELD 1    // Nothing more this frame, stepped again next frame
+#define SGP_JOB_DONE 2     // Finished, the slot is freed
+
+// Resumable unit of work: does a small slice (well under a scanline budget) and returns SGP_JOB_*
+typedef u8 (*SGPJobStep)(void *data);
+
+/**
+ * @brief One registered background job.
+ */
+typedef struct
+{
+    SGPJobStep step; // NULL for a free slot
+    void *data;      // Passed to every step
+    u8 priority;     // Lower runs first; equal priorities run in slot order
+    bool yielded;    // Returned SGP_JOB_YIELD during the current run
+} SGPJob;
+
+/**
+ * @brief Cooperative scheduler spending the scanlines left in a frame on background jobs.
+ *
+ * SGP_SchedulerRun steps the most urgent job until it yields or the V-counter reaches the
+ * stop line; whatever is left carries over to the next frame. All storage is static.
+ */
+typedef struct
+{
+    SGPJob jobs[SGP_SCHEDULER_MAX_JOBS];
+    u16 stop_line; // Adjusted V-counter line where a run stops
+    u16 steps;     // Steps taken by the last run
+} SGPScheduler;
+
 /**
  * @brief Global platform state (must be defined in one .c file).
  */
@@ -156,10 +742,29 @@ extern SGP sgp;
  */
 static inline void SGP_init(void)
 {
+    for (u16 i = 0; i < SGP_INPUT_PAD_SLOTS; i++)
+    {
+        sgp.input.state[i] = 0;
+        sgp.input.previous[i] = 0;
+        sgp.input.pressed[i] = 0;
+        sgp.input.released[i] = 0;
+    }
     sgp.input.joy1_state = 0;
     sgp.input.joy2_state = 0;
     sgp.input.joy1_previous = 0;
     sgp.input.joy2_previous = 0;
+    sgp.input.frame = 0;
+    sgp.input.history_len = 0;
+    sgp.input.mode = SGP_INPUT_LIVE;
+    sgp.input.stream = NULL;
+    for (u16 i = 0; i < SGP_INPUT_PAD_COUNT; i++)
+    {
+        for (u16 n = 0; n < SGP_INPUT_HISTORY_SIZE; n++)
+        {
+            sgp.input.history_state[i][n] = 0;
+            sgp.input.history_pressed[i][n] = 0;
+        }
+    }
     sgp.camera.current_x = 0;
     sgp.camera.current_y = 0;
     sgp.camera.active = false;
@@ -167,409 +772,3809 @@ static inline void SGP_init(void)
     sgp.camera.map_height = 0;
     sgp.camera.map_width = 0;
     sgp.camera.max_vertical_scroll = 32;
+    sgp.camera.stream_budget = 0;
+    sgp.camera.stream_pending = false;
+    sgp.camera.type = CAMERA_LOCKED;
+    sgp.camera.deadzone_w = 0;
+    sgp.camera.deadzone_h = 0;
+    sgp.camera.smooth_shift = 3;
+    sgp.camera.smooth_x = FIX32(0);
+    sgp.camera.smooth_y = FIX32(0);
+    sgp.camera.shake_frames = 0;
+    sgp.camera.shake_offset = 0;
+    sgp.camera.parallax = NULL;
+    sgp.camera.view_x = 0;
+    sgp.camera.view_y = 0;
+    sgp.vdp.enabled = false;
+    sgp.vdp.pending = 0;
+    sgp.vdp.known = 0;
+    sgp.vdp.map = NULL;
+    sgp.vdp.text_count = 0;
+    sgp.vdp.dropped = 0;
 }
 
 //----------------------------------------------------------------------------------
-// Debug Functions
+// VDP Command Queue (main loop commit, VBlank flush)
 //----------------------------------------------------------------------------------
-#ifdef DEBUG
-#define MAX_DEBUG_LINES 4
-static bool showDebug = true;
-static inline void SGP_ToggleDebug(void)
+/**
+ * @brief Writes the queued scroll and window registers (VBlank).
+ *
+ * Installed as the VBlank callback by SGP_VdpQueueInit; call it directly from a custom VBlank
+ * handler instead if the game already uses one. The map scroll and text are left for
+ * SGP_VdpQueueCommit, so the callback only issues plain register writes.
+ *
+ * @return Number of VDP writes issued
+ */
+static inline u16 SGP_VdpQueueFlush(void)
 {
-    showDebug = !showDebug;
-}
+    SGPVdpQueue *q = &sgp.vdp;
+    const u8 pending = q->pending & ~SGP_VDP_MAP;
+    u16 writes = 0;
+    q->pending &= SGP_VDP_MAP;
 
-static inline bool SGP_isDebugEnabled(void)
-{
-    return showDebug;
-}
-static inline void SGP_DebugPrint(const char *text, u16 x, u16 y)
-{
-    if (y > MAX_DEBUG_LINES)
-    {
-        return;
-    }
-    if (SGP_isDebugEnabled())
+    for (u8 i = 0; i < 2; i++)
     {
-        VDP_setWindowVPos(false, MAX_DEBUG_LINES + 1);
-        VDP_drawTextEx(WINDOW, text, TILE_ATTR(PAL1, false, false, false), x, y, DMA);
+        const VDPPlane plane = i ? BG_B : BG_A;
+        const u8 hbit = SGP_VDP_HSCROLL_A << i;
+        const u8 vbit = SGP_VDP_VSCROLL_A << i;
+        if (pending & hbit)
+        {
+            if ((q->known & hbit) && q->hscroll[i] == q->written_hscroll[i])
+                q->dropped++;
+            else
+            {
+                VDP_setHorizontalScroll(plane, q->hscroll[i]);
+                q->written_hscroll[i] = q->hscroll[i];
+                q->known |= hbit;
+                writes++;
+            }
+        }
+        if (pending & vbit)
+        {
+            if ((q->known & vbit) && q->vscroll[i] == q->written_vscroll[i])
+                q->dropped++;
+            else
+            {
+                VDP_setVerticalScroll(plane, q->vscroll[i]);
+                q->written_vscroll[i] = q->vscroll[i];
+                q->known |= vbit;
+                writes++;
+            }
+        }
     }
-    else
+    if (pending & SGP_VDP_WINDOW)
     {
-        VDP_setWindowVPos(false, 0);
+        if ((q->known & SGP_VDP_WINDOW) && q->window_enable == q->written_window_enable &&
+            q->window_pos == q->written_window_pos)
+            q->dropped++;
+        else
+        {
+            VDP_setWindowVPos(q->window_enable, q->window_pos);
+            q->written_window_enable = q->window_enable;
+            q->written_window_pos = q->window_pos;
+            q->known |= SGP_VDP_WINDOW;
+            writes++;
+        }
     }
+    return writes;
 }
 
-#endif // DEBUG
-
-static inline void SGP_HandleError(const char *text)
+// VBlank callback signature wrapper
+static inline void SGP_VdpQueueVBlank(void)
 {
-    VDP_drawText(text, 0, 0);
-    while (true)
-    {
-    } // Halt execution
+    SGP_VdpQueueFlush();
 }
 
-//----------------------------------------------------------------------------------
-// Input Functions
-//----------------------------------------------------------------------------------
-
 /**
- * @brief Polls and updates the current and previous state for both controllers.
+ * @brief Starts queueing SGP's VDP writes and flushes the registers from SYS_setVBlankCallback.
  *
- * Call this once per frame before reading input.
+ * The game then calls SGP_VdpQueueCommit once per frame, right before SYS_doVBlankProcess.
+ * Forgets the last written values, so the first flush writes every queued target.
  */
-static inline void SGP_PollInput(void)
+static inline void SGP_VdpQueueInit(void)
 {
-    sgp.input.joy1_previous = sgp.input.joy1_state;
-    sgp.input.joy2_previous = sgp.input.joy2_state;
-    sgp.input.joy1_state = JOY_readJoypad(JOY_1);
-    sgp.input.joy2_state = JOY_readJoypad(JOY_2);
+    sgp.vdp.enabled = true;
+    sgp.vdp.pending = 0;
+    sgp.vdp.known = 0;
+    sgp.vdp.text_count = 0;
+    sgp.vdp.dropped = 0;
+    SYS_setVBlankCallback(SGP_VdpQueueVBlank);
 }
 
 /**
- * @brief Returns true if the specified button(s) were just pressed (edge detection) for the given joypad.
- *
- * @param joy JOY_1 or JOY_2
- * @param button Button mask (e.g. BUTTON_A | BUTTON_B)
+ * @brief Checks whether SGP's VDP writes are queued for the VBlank flush.
  */
-static inline bool SGP_ButtonPressed(u16 joy, u16 button)
+static inline bool SGP_isVdpQueueEnabled(void)
+{
+    return sgp.vdp.enabled;
+}
+
+// Queue slot of a scrolling plane: 0 for BG_A, 1 for BG_B
+static inline u8 SGP_VdpPlaneSlot(VDPPlane plane)
 {
-    u16 state = (joy == JOY_1) ? sgp.input.joy1_state : sgp.input.joy2_state;
-    u16 prev = (joy == JOY_1) ? sgp.input.joy1_previous : sgp.input.joy2_previous;
-    return ((state & button) != 0) && ((prev & button) == 0);
+    return (plane == BG_A) ? 0 : 1;
+}
+
+// Marks a queued target, counting the value it replaces as dropped
+static inline void SGP_VdpQueueMark(u8 bit)
+{
+    if (sgp.vdp.pending & bit)
+        sgp.vdp.dropped++;
+    sgp.vdp.pending |= bit;
 }
 
 /**
- * @brief Returns true if the specified button(s) were just released for the given joypad.
- *
- * @param joy JOY_1 or JOY_2
- * @param button Button mask
+ * @brief MAP_scrollTo, queued for SGP_VdpQueueCommit when the command queue is enabled.
  */
-static inline bool SGP_ButtonReleased(u16 joy, u16 button)
+static inline void SGP_VdpScrollMap(Map *map, u32 x, u32 y)
 {
-    u16 state = (joy == JOY_1) ? sgp.input.joy1_state : sgp.input.joy2_state;
-    u16 prev = (joy == JOY_1) ? sgp.input.joy1_previous : sgp.input.joy2_previous;
-    return ((state & button) == 0) && ((prev & button) != 0);
+    if (!sgp.vdp.enabled)
+    {
+        MAP_scrollTo(map, x, y);
+        return;
+    }
+    if (sgp.vdp.map != map)
+        sgp.vdp.known &= ~SGP_VDP_MAP;
+    sgp.vdp.map = map;
+    sgp.vdp.map_x = x;
+    sgp.vdp.map_y = y;
+    SGP_VdpQueueMark(SGP_VDP_MAP);
 }
 
 /**
- * @brief Returns true if the specified button(s) are currently held down for the given joypad.
- *
- * @param joy JOY_1 or JOY_2
- * @param button Button mask
+ * @brief VDP_setHorizontalScroll for BG_A / BG_B, queued when the command queue is enabled.
  */
-static inline bool SGP_ButtonDown(u16 joy, u16 button)
+static inline void SGP_VdpSetHScroll(VDPPlane plane, s16 value)
 {
-    u16 state = (joy == JOY_1) ? sgp.input.joy1_state : sgp.input.joy2_state;
-    return (state & button) != 0;
+    if (!sgp.vdp.enabled)
+    {
+        VDP_setHorizontalScroll(plane, value);
+        return;
+    }
+    const u8 slot = SGP_VdpPlaneSlot(plane);
+    sgp.vdp.hscroll[slot] = value;
+    SGP_VdpQueueMark(SGP_VDP_HSCROLL_A << slot);
 }
 
-//----------------------------------------------------------------------------------
-// Camera Functions (Fixed Point for Genesis)
-//----------------------------------------------------------------------------------
-typedef struct
+/**
+ * @brief VDP_setVerticalScroll for BG_A / BG_B, queued when the command queue is enabled.
+ */
+static inline void SGP_VdpSetVScroll(VDPPlane plane, s16 value)
 {
-    Sprite *sprite;      // Sprite to follow
-    s32 offset_x;        // Offset from sprite X position (integer)
-    s32 offset_y;        // Offset from sprite Y position (integer)
-    s32 sprite_world_x; // Sprite's world X position (integer)
-    s32 sprite_world_y; // Sprite's world Y position (integer)
-} SGPCameraTarget;
+    if (!sgp.vdp.enabled)
+    {
+        VDP_setVerticalScroll(plane, value);
+        return;
+    }
+    const u8 slot = SGP_VdpPlaneSlot(plane);
+    sgp.vdp.vscroll[slot] = value;
+    SGP_VdpQueueMark(SGP_VDP_VSCROLL_A << slot);
+}
 
 /**
- * @brief Initializes a Camera struct with default values and a given target position.
- * @param cam Pointer to Camera struct
- * @param current_x   Target X position
- * @param current_y   Target Y position
+ * @brief VDP_setWindowVPos, queued when the command queue is enabled.
+ */
+static inline void SGP_VdpSetWindowVPos(bool enable, u16 pos)
+{
+    if (!sgp.vdp.enabled)
+    {
+        VDP_setWindowVPos(enable, pos);
+        return;
+    }
+    sgp.vdp.window_enable = enable;
+    sgp.vdp.window_pos = pos;
+    SGP_VdpQueueMark(SGP_VDP_WINDOW);
+}
+
+/**
+ * @brief VDP_drawTextEx (DMA), queued for SGP_VdpQueueCommit when the command queue is enabled.
+ *
+ * The text is copied (up to SGP_VDP_QUEUE_TEXT_CHARS characters) and replaces any run queued
+ * at the same plane and position. When every slot is taken the run is drawn immediately.
+ */
+static inline void SGP_VdpDrawText(VDPPlane plane, const char *text, u16 attr, u16 x, u16 y)
+{
+    SGPVdpQueue *q = &sgp.vdp;
+    if (!q->enabled)
+    {
+        VDP_drawTextEx(plane, text, attr, x, y, DMA);
+        return;
+    }
+    u8 i = 0;
+    while (i < q->text_count && (q->text[i].plane != plane || q->text[i].x != x || q->text[i].y != y))
+        i++;
+    if (i == SGP_VDP_QUEUE_TEXT_SLOTS)
+    {
+        VDP_drawTextEx(plane, text, attr, x, y, DMA);
+        return;
+    }
+    if (i < q->text_count)
+        q->dropped++;
+
+    SGPVdpText *run = &q->text[i];
+    u16 n = 0;
+    while (text[n] && n < SGP_VDP_QUEUE_TEXT_CHARS)
+    {
+        run->text[n] = text[n];
+        n++;
+    }
+    run->text[n] = '\0';
+    run->plane = plane;
+    run->attr = attr;
+    run->x = x;
+    run->y = y;
+    if (i == q->text_count)
+        q->text_count++;
+}
+
+//----------------------------------------------------------------------------------
+// Debug Functions
+//----------------------------------------------------------------------------------
+#ifdef DEBUG
+#define MAX_DEBUG_LINES 4
+static bool showDebug = true;
+static inline void SGP_ToggleDebug(void)
+{
+    showDebug = !showDebug;
+}
+
+static inline bool SGP_isDebugEnabled(void)
+{
+    return showDebug;
+}
+
+#define SGP_DEBUG_LINE_CHARS 40 // Window row width in characters
+
+/**
+ * @brief Buffered debug window row; SGP_DebugFlush draws only the columns that changed.
+ *
+ * Several prints share a row: each one is merged at its own column, and owner[] remembers which
+ * print covers a column so a shorter reprint blanks only its own stale tail.
+ */
+typedef struct
+{
+    char text[SGP_DEBUG_LINE_CHARS + 1]; // Merged row contents ('\0' = column never printed)
+    u8 owner[SGP_DEBUG_LINE_CHARS];      // 1 + x of the print covering each column, 0 if none
+    u8 dirty_first;                      // Changed columns dirty_first .. dirty_end - 1
+    u8 dirty_end;                        // 0 = row unchanged since the last flush
+} SGPDebugLine;
+
+static SGPDebugLine sgp_debug_lines[MAX_DEBUG_LINES + 1];
+static bool sgp_debug_window_shown = false;
+
+// Writes one column of a buffered row and widens the dirty span only if it changed
+static inline void SGP_DebugPutChar(SGPDebugLine *line, u16 col, char c, u8 owner)
+{
+    line->owner[col] = owner;
+    if (line->text[col] == c)
+        return;
+    line->text[col] = c;
+    if (line->dirty_end == 0 || col < line->dirty_first)
+        line->dirty_first = (u8)col;
+    if (col >= line->dirty_end)
+        line->dirty_end = (u8)(col + 1);
+}
+
+/**
+ * @brief Buffers debug text at a window position; it is drawn by the next SGP_DebugFlush.
+ *
+ * Text is merged into the row at x, so prints at different columns of one row coexist.
+ * Reprinting the same text marks nothing and costs no VRAM traffic; shorter text blanks the
+ * characters left over from the previous print at the same x.
+ *
+ * @param text Text to show
+ * @param x Column
+ * @param y Window row (0 .. MAX_DEBUG_LINES)
+ */
+static inline void SGP_DebugPrint(const char *text, u16 x, u16 y)
+{
+    if (y > MAX_DEBUG_LINES || x >= SGP_DEBUG_LINE_CHARS)
+    {
+        return;
+    }
+
+    SGPDebugLine *line = &sgp_debug_lines[y];
+    const u8 owner = (u8)(x + 1);
+    u16 col = x;
+    while (*text && col < SGP_DEBUG_LINE_CHARS)
+        SGP_DebugPutChar(line, col++, *text++, owner);
+    // Blank what is left of this print's previous text, stepping over columns other prints took
+    for (; col < SGP_DEBUG_LINE_CHARS; col++)
+    {
+        if (line->owner[col] == owner)
+            SGP_DebugPutChar(line, col, ' ', 0);
+    }
+}
+
+/**
+ * @brief Draws the changed debug columns and updates the window only when showDebug flipped.
+ *
+ * Call it once per frame after the last SGP_DebugPrint, right before SYS_doVBlankProcess.
+ * With the VDP command queue enabled SGP_VdpQueueCommit calls it, so no separate call is needed.
+ *
+ * @return Number of rows drawn
+ */
+static inline u16 SGP_DebugFlush(void)
+{
+    if (showDebug != sgp_debug_window_shown)
+    {
+        SGP_VdpSetWindowVPos(false, showDebug ? MAX_DEBUG_LINES + 1 : 0);
+        sgp_debug_window_shown = showDebug;
+    }
+    if (!showDebug)
+    {
+        return 0; // Rows stay dirty and are drawn once the window is shown again
+    }
+
+    u16 drawn = 0;
+    for (u16 y = 0; y <= MAX_DEBUG_LINES; y++)
+    {
+        SGPDebugLine *line = &sgp_debug_lines[y];
+        if (line->dirty_end == 0)
+            continue;
+        // One draw per printed run inside the span; never-printed columns are left alone
+        u16 col = line->dirty_first;
+        while (col < line->dirty_end)
+        {
+            char run[SGP_DEBUG_LINE_CHARS + 1];
+            u16 n = 0;
+            const u16 first = col;
+            while (col < line->dirty_end && line->text[col])
+                run[n++] = line->text[col++];
+            if (n)
+            {
+                run[n] = '\0';
+                SGP_VdpDrawText(WINDOW, run, TILE_ATTR(PAL1, false, false, false), first, y);
+            }
+            while (col < line->dirty_end && !line->text[col])
+                col++;
+        }
+        line->dirty_end = 0;
+        drawn++;
+    }
+    return drawn;
+}
+
+//----------------------------------------------------------------------------------
+// Profiler (DEBUG only; the SGP_PROFILE_* macros compile away in release builds)
+//----------------------------------------------------------------------------------
+#ifndef SGP_PROFILE_MAX_ZONES
+#define SGP_PROFILE_MAX_ZONES MAX_DEBUG_LINES
+#endif
+#ifndef SGP_PROFILE_FRAME_LINES
+#define SGP_PROFILE_FRAME_LINES 262 // Scanlines per frame (262 NTSC, 313 PAL)
+#endif
+#define SGP_PROFILE_BAR_SHIFT 2     // One bar character per 4 scanlines
+#define SGP_PROFILE_BAR_MAX 20
+
+/**
+ * @brief Scanline statistics for one profiled zone.
+ */
+typedef struct
+{
+    const char *name; // Label drawn by SGP_ProfileDraw (NULL = not drawn)
+    u16 start;        // V-counter at the last begin marker
+    u16 current;      // Scanlines accumulated this frame
+    u16 last;         // Scanlines of the last completed frame
+    u16 min;
+    u16 max;
+    u32 total;        // Sum over completed frames, for the average
+    u16 frames;       // Completed frames since the last reset
+} SGPProfileZone;
+
+static SGPProfileZone sgp_profile[SGP_PROFILE_MAX_ZONES];
+
+/**
+ * @brief Clears the statistics of every zone (names are kept).
+ */
+static inline void SGP_ProfileReset(void)
+{
+    for (u16 i = 0; i < SGP_PROFILE_MAX_ZONES; i++)
+    {
+        sgp_profile[i].current = 0;
+        sgp_profile[i].last = 0;
+        sgp_profile[i].min = 0xFFFF;
+        sgp_profile[i].max = 0;
+        sgp_profile[i].total = 0;
+        sgp_profile[i].frames = 0;
+    }
+}
+
+static inline void SGP_ProfileName(u16 zone, const char *name)
+{
+    if (zone < SGP_PROFILE_MAX_ZONES)
+        sgp_profile[zone].name = name;
+}
+
+static inline void SGP_ProfileBegin(u16 zone)
+{
+    if (zone < SGP_PROFILE_MAX_ZONES)
+        sgp_profile[zone].start = VDP_getAdjustedVCounter();
+}
+
+// Adds the scanlines since the matching begin marker; a zone may run several times per frame
+static inline void SGP_ProfileEnd(u16 zone)
+{
+    if (zone >= SGP_PROFILE_MAX_ZONES)
+        return;
+    s16 lines = (s16)(VDP_getAdjustedVCounter() - sgp_profile[zone].start);
+    if (lines < 0)
+        lines += SGP_PROFILE_FRAME_LINES; // Zone ran across the frame boundary
+    sgp_profile[zone].current += (u16)lines;
+}
+
+/**
+ * @brief Folds this frame's scanlines into min/avg/max. Call once per frame.
+ */
+static inline void SGP_ProfileEndFrame(void)
+{
+    for (u16 i = 0; i < SGP_PROFILE_MAX_ZONES; i++)
+    {
+        SGPProfileZone *zone = &sgp_profile[i];
+        if (zone->frames == 0xFFFF)
+        {
+            zone->total = 0;
+            zone->frames = 0;
+        }
+        zone->last = zone->current;
+        if (zone->frames == 0 || zone->current < zone->min)
+            zone->min = zone->current;
+        if (zone->current > zone->max)
+            zone->max = zone->current;
+        zone->total += zone->current;
+        zone->frames++;
+        zone->current = 0;
+    }
+}
+
+static inline u16 SGP_ProfileAverage(u16 zone)
+{
+    if (zone >= SGP_PROFILE_MAX_ZONES || sgp_profile[zone].frames == 0)
+        return 0;
+    return (u16)(sgp_profile[zone].total / sgp_profile[zone].frames);
+}
+
+// Writes value right-aligned in width characters
+static inline char *SGP_ProfileFormatU16(char *dst, u16 value, u16 width)
+{
+    for (u16 i = width; i; i--)
+    {
+        dst[i - 1] = (value || i == width) ? (char)('0' + value % 10) : ' ';
+        value /= 10;
+    }
+    return dst + width;
+}
+
+/**
+ * @brief Draws "name last avg max |bar|" for each named zone in the debug window.
+ * @param first_line Window row of the first zone (rows past MAX_DEBUG_LINES are skipped)
+ */
+static inline void SGP_ProfileDraw(u16 first_line)
+{
+    char line[40];
+    u16 y = first_line;
+    for (u16 i = 0; i < SGP_PROFILE_MAX_ZONES && y <= MAX_DEBUG_LINES; i++)
+    {
+        const SGPProfileZone *zone = &sgp_profile[i];
+        if (zone->name == NULL)
+            continue;
+
+        char *dst = line;
+        const char *name = zone->name;
+        for (u16 n = 0; n < 4; n++)
+            *dst++ = *name ? *name++ : ' ';
+        *dst++ = ' ';
+        dst = SGP_ProfileFormatU16(dst, zone->last, 3);
+        *dst++ = ' ';
+        dst = SGP_ProfileFormatU16(dst, SGP_ProfileAverage(i), 3);
+        *dst++ = ' ';
+        dst = SGP_ProfileFormatU16(dst, zone->max, 3);
+        *dst++ = ' ';
+        u16 bar = zone->last >> SGP_PROFILE_BAR_SHIFT;
+        if (bar > SGP_PROFILE_BAR_MAX)
+            bar = SGP_PROFILE_BAR_MAX;
+        for (u16 n = 0; n < SGP_PROFILE_BAR_MAX; n++)
+            *dst++ = (n < bar) ? '|' : ' ';
+        *dst = '\0';
+
+        SGP_DebugPrint(line, 0, y++);
+    }
+}
+
+#define SGP_PROFILE_NAME(zone, name) SGP_ProfileName(zone, name)
+#define SGP_PROFILE_BEGIN(zone) SGP_ProfileBegin(zone)
+#define SGP_PROFILE_END(zone) SGP_ProfileEnd(zone)
+#define SGP_PROFILE_FRAME() SGP_ProfileEndFrame()
+#define SGP_PROFILE_DRAW(first_line) SGP_ProfileDraw(first_line)
+
+#else
+
+#define SGP_PROFILE_NAME(zone, name) ((void)0)
+#define SGP_PROFILE_BEGIN(zone) ((void)0)
+#define SGP_PROFILE_END(zone) ((void)0)
+#define SGP_PROFILE_FRAME() ((void)0)
+#define SGP_PROFILE_DRAW(first_line) ((void)0)
+
+#endif // DEBUG
+
+//----------------------------------------------------------------------------------
+// VDP Command Queue (main loop commit)
+//----------------------------------------------------------------------------------
+/**
+ * @brief Applies the queued map scroll and text from the main loop (once per frame).
+ *
+ * Call it right before SYS_doVBlankProcess: MAP_scrollTo runs once with the frame's last
+ * position, and text runs go to SGDK's DMA queue, which SYS_doVBlankProcess transfers.
+ * In DEBUG builds it runs SGP_DebugFlush first, so the frame's debug text is queued too.
+ *
+ * @return Number of VDP calls issued
+ */
+static inline u16 SGP_VdpQueueCommit(void)
+{
+    SGPVdpQueue *q = &sgp.vdp;
+    u16 writes = 0;
+#ifdef DEBUG
+    SGP_DebugFlush();
+#endif
+
+    if (q->pending & SGP_VDP_MAP)
+    {
+        q->pending &= ~SGP_VDP_MAP;
+        if ((q->known & SGP_VDP_MAP) && q->map_x == q->written_map_x && q->map_y == q->written_map_y)
+            q->dropped++;
+        else
+        {
+            MAP_scrollTo(q->map, q->map_x, q->map_y);
+            q->written_map_x = q->map_x;
+            q->written_map_y = q->map_y;
+            q->known |= SGP_VDP_MAP;
+            writes++;
+        }
+    }
+    for (u8 i = 0; i < q->text_count; i++)
+    {
+        const SGPVdpText *run = &q->text[i];
+        VDP_drawTextEx(run->plane, run->text, run->attr, run->x, run->y, DMA);
+        writes++;
+    }
+    q->text_count = 0;
+    return writes;
+}
+
+/**
+ * @brief Applies what is still queued and returns to immediate writes.
+ */
+static inline void SGP_VdpQueueDisable(void)
+{
+    SYS_setVBlankCallback(NULL);
+    SGP_VdpQueueCommit();
+    SGP_VdpQueueFlush();
+    sgp.vdp.enabled = false;
+}
+
+static inline void SGP_HandleError(const char *text)
+{
+    VDP_drawText(text, 0, 0);
+    while (true)
+    {
+    } // Halt execution
+}
+
+//----------------------------------------------------------------------------------
+// Input Functions
+//----------------------------------------------------------------------------------
+
+// Appends one frame to the recording, extending the last run when nothing changed. Once a
+// frame was dropped nothing more is recorded: extending a run past the gap would desync replay.
+static inline void SGP_InputRecordFrame(SGPInputStream *stream, const u16 *states)
+{
+    const u16 record_words = 1 + SGP_INPUT_PAD_COUNT;
+    if (stream->overflow)
+        return;
+    if (stream->length > 1)
+    {
+        u16 *last = &stream->data[stream->length - record_words];
+        bool same = last[0] != 0xFFFF;
+        for (u16 joy = 0; same && joy < SGP_INPUT_PAD_COUNT; joy++)
+            same = (last[1 + joy] == states[joy]);
+        if (same)
+        {
+            last[0]++;
+            return;
+        }
+    }
+    if (stream->length + record_words > stream->capacity)
+    {
+        stream->overflow = true;
+        return;
+    }
+    u16 *dst = &stream->data[stream->length];
+    *dst++ = 1;
+    for (u16 joy = 0; joy < SGP_INPUT_PAD_COUNT; joy++)
+        *dst++ = states[joy];
+    stream->length += record_words;
+}
+
+// Fetches one frame from the replay stream; idle pads once it is exhausted
+static inline void SGP_InputReplayFrame(SGPInputStream *stream, u16 *states)
+{
+    if (stream->run_left == 0)
+    {
+        if (stream->pos + 1 + SGP_INPUT_PAD_COUNT > stream->length || stream->data[stream->pos] == 0)
+        {
+            stream->done = true;
+            for (u16 joy = 0; joy < SGP_INPUT_PAD_COUNT; joy++)
+                states[joy] = 0;
+            return;
+        }
+        stream->run_left = stream->data[stream->pos];
+        stream->record = stream->pos + 1;
+        stream->pos += 1 + SGP_INPUT_PAD_COUNT;
+    }
+    stream->run_left--;
+    for (u16 joy = 0; joy < SGP_INPUT_PAD_COUNT; joy++)
+        states[joy] = stream->data[stream->record + joy];
+}
+
+/**
+ * @brief Polls every configured joypad, computes its pressed/released edge masks and
+ * appends the frame to the input history.
+ *
+ * In SGP_INPUT_REPLAY mode the pad states come from the replay stream instead of
+ * JOY_readJoypad; in SGP_INPUT_RECORD mode they are also logged to the stream.
+ * Call this once per frame before reading input.
+ */
+static inline void SGP_PollInput(void)
+{
+    u16 states[SGP_INPUT_PAD_COUNT];
+    if (sgp.input.mode == SGP_INPUT_REPLAY)
+    {
+        SGP_InputReplayFrame(sgp.input.stream, states);
+    }
+    else
+    {
+        for (u16 joy = 0; joy < SGP_INPUT_PAD_COUNT; joy++)
+            states[joy] = JOY_readJoypad(joy);
+        if (sgp.input.mode == SGP_INPUT_RECORD)
+            SGP_InputRecordFrame(sgp.input.stream, states);
+    }
+
+    const u16 slot = ++sgp.input.frame & SGP_INPUT_HISTORY_MASK;
+    for (u16 joy = 0; joy < SGP_INPUT_PAD_COUNT; joy++)
+    {
+        const u16 prev = sgp.input.state[joy];
+        const u16 state = states[joy];
+        const u16 pressed = state & ~prev;
+        sgp.input.previous[joy] = prev;
+        sgp.input.state[joy] = state;
+        sgp.input.pressed[joy] = pressed;
+        sgp.input.released[joy] = prev & ~state;
+        sgp.input.history_state[joy][slot] = state;
+        sgp.input.history_pressed[joy][slot] = pressed;
+    }
+    sgp.input.joy1_state = sgp.input.state[JOY_1];
+    sgp.input.joy2_state = sgp.input.state[JOY_2];
+    sgp.input.joy1_previous = sgp.input.previous[JOY_1];
+    sgp.input.joy2_previous = sgp.input.previous[JOY_2];
+    if (sgp.input.history_len < SGP_INPUT_HISTORY_SIZE)
+        sgp.input.history_len++;
+}
+
+/**
+ * @brief Returns true if any of the specified button(s) was just pressed (edge detection) for the given joypad.
+ *
+ * @param joy JOY_1 .. JOY_8
+ * @param button Button mask (e.g. BUTTON_A | BUTTON_B)
+ */
+static inline bool SGP_ButtonPressed(u16 joy, u16 button)
+{
+    return (sgp.input.pressed[joy & SGP_INPUT_PAD_MASK] & button) != 0;
+}
+
+/**
+ * @brief Returns true if any of the specified button(s) was just released for the given joypad.
+ *
+ * @param joy JOY_1 .. JOY_8
+ * @param button Button mask
+ */
+static inline bool SGP_ButtonReleased(u16 joy, u16 button)
+{
+    return (sgp.input.released[joy & SGP_INPUT_PAD_MASK] & button) != 0;
+}
+
+/**
+ * @brief Returns true if the specified button(s) are currently held down for the given joypad.
+ *
+ * @param joy JOY_1 .. JOY_8
+ * @param button Button mask
+ */
+static inline bool SGP_ButtonDown(u16 joy, u16 button)
+{
+    return (sgp.input.state[joy & SGP_INPUT_PAD_MASK] & button) != 0;
+}
+
+/**
+ * @brief Returns the mask of buttons that went down this frame (for command/combo input).
+ * @param joy JOY_1 .. JOY_8
+ */
+static inline u16 SGP_ButtonsPressedMask(u16 joy)
+{
+    return sgp.input.pressed[joy & SGP_INPUT_PAD_MASK];
+}
+
+/**
+ * @brief Returns the mask of buttons held this frame.
+ * @param joy JOY_1 .. JOY_8
+ */
+static inline u16 SGP_ButtonsDownMask(u16 joy)
+{
+    return sgp.input.state[joy & SGP_INPUT_PAD_MASK];
+}
+
+/**
+ * @brief Returns the frame stamp of the latest SGP_PollInput.
+ */
+static inline u16 SGP_InputFrame(void)
+{
+    return sgp.input.frame;
+}
+
+/**
+ * @brief Returns the buttons held a number of frames ago (0 = this frame).
+ * @param joy Polled pad (below SGP_INPUT_PAD_COUNT)
+ * @param frames_ago Age in frames; 0 when older than the recorded history
+ */
+static inline u16 SGP_InputHistoryState(u16 joy, u16 frames_ago)
+{
+    if (joy >= SGP_INPUT_PAD_COUNT || frames_ago >= sgp.input.history_len)
+        return 0;
+    return sgp.input.history_state[joy][(sgp.input.frame - frames_ago) & SGP_INPUT_HISTORY_MASK];
+}
+
+/**
+ * @brief Returns the buttons pressed a number of frames ago (0 = this frame).
+ */
+static inline u16 SGP_InputHistoryPressed(u16 joy, u16 frames_ago)
+{
+    if (joy >= SGP_INPUT_PAD_COUNT || frames_ago >= sgp.input.history_len)
+        return 0;
+    return sgp.input.history_pressed[joy][(sgp.input.frame - frames_ago) & SGP_INPUT_HISTORY_MASK];
+}
+
+/**
+ * @brief Matches an input sequence (e.g. a quarter-circle motion) against the history.
+ *
+ * The last step must match this frame; earlier steps must appear in order, scanning
+ * backwards, within the window. Frames between steps are ignored.
+ *
+ * @param joy Polled pad (below SGP_INPUT_PAD_COUNT)
+ * @param steps Sequence, oldest step first
+ * @param count Number of steps
+ * @param window Frames to scan, including this one (clamped to the history size)
+ * @return True if the whole sequence was found
+ */
+static inline bool SGP_InputMatchSequence(u16 joy, const SGPInputStep *steps, u8 count, u16 window)
+{
+    if (joy >= SGP_INPUT_PAD_COUNT || count == 0)
+        return false;
+    if (window > sgp.input.history_len)
+        window = sgp.input.history_len;
+
+    const u16 *held = sgp.input.history_state[joy];
+    const u16 *pressed = sgp.input.history_pressed[joy];
+    u16 slot = sgp.input.frame;
+    const SGPInputStep *step = &steps[count - 1];
+
+    for (u16 n = 0; n < window; n++, slot--)
+    {
+        const u16 buttons = step->pressed ? pressed[slot & SGP_INPUT_HISTORY_MASK] : held[slot & SGP_INPUT_HISTORY_MASK];
+        if ((buttons & step->mask) == step->value)
+        {
+            if (step == steps)
+                return true;
+            step--;
+        }
+        else if (n == 0)
+        {
+            return false; // Final step must land on this frame
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Counts consecutive frames with (held & mask) == value, for charge moves.
+ * @param joy Polled pad (below SGP_INPUT_PAD_COUNT)
+ * @param mask Buttons to compare (e.g. the d-pad bits)
+ * @param value Required state of those buttons
+ * @param frames_ago Frame to start counting back from (0 = this frame)
+ * @return Number of matching frames, at most the recorded history
+ */
+static inline u16 SGP_InputHeldFrames(u16 joy, u16 mask, u16 value, u16 frames_ago)
+{
+    if (joy >= SGP_INPUT_PAD_COUNT)
+        return 0;
+
+    const u16 *held = sgp.input.history_state[joy];
+    u16 slot = sgp.input.frame - frames_ago;
+    u16 frames = 0;
+    for (u16 n = frames_ago; n < sgp.input.history_len; n++, slot--)
+    {
+        if ((held[slot & SGP_INPUT_HISTORY_MASK] & mask) != value)
+            break;
+        frames++;
+    }
+    return frames;
+}
+
+/**
+ * @brief Attaches a caller-owned buffer to a record/replay stream.
+ * @param stream Stream to initialize (empty)
+ * @param buffer Word buffer; a record takes 1 + SGP_INPUT_PAD_COUNT words
+ * @param capacity Buffer size in words
+ */
+static inline void SGP_InputStreamInit(SGPInputStream *stream, u16 *buffer, u16 capacity)
+{
+    stream->data = buffer;
+    stream->capacity = capacity;
+    stream->length = 0;
+    stream->pos = 0;
+    stream->record = 0;
+    stream->run_left = 0;
+    stream->overflow = false;
+    stream->done = false;
+}
+
+/**
+ * @brief Starts recording every polled frame into the stream (previous contents are discarded).
+ * @return False if the buffer cannot hold the header
+ */
+static inline bool SGP_InputStartRecord(SGPInputStream *stream)
+{
+    if (stream->capacity < 1)
+        return false;
+    stream->data[0] = SGP_INPUT_PAD_COUNT;
+    stream->length = 1;
+    stream->overflow = false;
+    sgp.input.stream = stream;
+    sgp.input.mode = SGP_INPUT_RECORD;
+    return true;
+}
+
+/**
+ * @brief Starts replaying the stream from its first frame instead of reading the joypads.
+ *
+ * For a bit-exact run, start the replay at the same point the recording started
+ * (e.g. right after level load, with the same SGP_init and RNG seed).
+ *
+ * @return False if the stream is empty or was recorded with a different SGP_INPUT_PAD_COUNT
+ */
+static inline bool SGP_InputStartReplay(SGPInputStream *stream)
+{
+    if (stream->length < 1 || stream->data[0] != SGP_INPUT_PAD_COUNT)
+        return false;
+    stream->pos = 1;
+    stream->run_left = 0;
+    stream->done = false;
+    sgp.input.stream = stream;
+    sgp.input.mode = SGP_INPUT_REPLAY;
+    return true;
+}
+
+/**
+ * @brief Stops recording or replaying and returns to live joypad input.
+ */
+static inline void SGP_InputStop(void)
+{
+    sgp.input.mode = SGP_INPUT_LIVE;
+}
+
+/**
+ * @brief Gets the input mode (SGP_INPUT_LIVE, SGP_INPUT_RECORD or SGP_INPUT_REPLAY).
+ */
+static inline u8 SGP_InputGetMode(void)
+{
+    return sgp.input.mode;
+}
+
+/**
+ * @brief Checks if a replay has run past the end of its stream.
+ */
+static inline bool SGP_isInputReplayDone(void)
+{
+    return sgp.input.mode == SGP_INPUT_REPLAY && sgp.input.stream->done;
+}
+
+/**
+ * @brief Saves a stream to SRAM as [length][data words] starting at a byte offset.
+ * @return Bytes written
+ */
+static inline u32 SGP_InputStreamSaveSRAM(const SGPInputStream *stream, u32 offset)
+{
+    SRAM_enable();
+    SRAM_writeWord(offset, stream->length);
+    for (u16 i = 0; i < stream->length; i++)
+        SRAM_writeWord(offset + 2 + ((u32)i << 1), stream->data[i]);
+    SRAM_disable();
+    return 2 + ((u32)stream->length << 1);
+}
+
+/**
+ * @brief Loads a stream saved by SGP_InputStreamSaveSRAM into the stream's buffer.
+ * @return False if the saved stream is empty or larger than the buffer
+ */
+static inline bool SGP_InputStreamLoadSRAM(SGPInputStream *stream, u32 offset)
+{
+    SRAM_enableRO();
+    const u16 length = SRAM_readWord(offset);
+    const bool fits = length >= 1 && length <= stream->capacity;
+    if (fits)
+    {
+        for (u16 i = 0; i < length; i++)
+            stream->data[i] = SRAM_readWord(offset + 2 + ((u32)i << 1));
+        stream->length = length;
+    }
+    SRAM_disable();
+    return fits;
+}
+
+//----------------------------------------------------------------------------------
+// Camera Functions (Fixed Point for Genesis)
+//----------------------------------------------------------------------------------
+typedef struct
+{
+    Sprite *sprite;      // Sprite to follow
+    s32 offset_x;        // Offset from sprite X position (integer)
+    s32 offset_y;        // Offset from sprite Y position (integer)
+    s32 sprite_world_x; // Sprite's world X position (integer)
+    s32 sprite_world_y; // Sprite's world Y position (integer)
+} SGPCameraTarget;
+
+/**
+ * @brief Initializes a Camera struct with default values and a given target position.
+ * @param cam Pointer to Camera struct
+ * @param current_x   Target X position
+ * @param current_y   Target Y position
  */
 static inline bool SGP_CameraInit(Map *map)
 {
-    if (map == NULL) {
+    if (map == NULL) {
+        return false;
+    }
+    
+    sgp.camera.map = map;
+    sgp.camera.map_height = SGP_MetatilesToPixels(map->h);
+    sgp.camera.map_width = SGP_MetatilesToPixels(map->w);
+    sgp.camera.active = true;
+    return true;
+}
+/**
+ * @brief Clamps the given fixed-point position to the map bounds.
+ * @param x Pointer to X position (fixed-point)
+ * @param y Pointer to Y position (fixed-point)
+ * @param width Width of the entity
+ * @param height Height of the entity
+ */
+static inline void SGP_ClampPositionToMapBounds(fix32 *x, fix32 *y, u16 width, u16 height)
+{
+    s16 pos_x = F32_toInt(*x);
+    s16 pos_y = F32_toInt(*y);
+
+    // Clamp position to map bounds (entity always visible on map, accounting for sprite dimensions)
+    if (pos_x < 0)
+        *x = FIX32(0);
+    if (pos_x > sgp.camera.map_width - 1 - width)
+        *x = FIX32(sgp.camera.map_width - 1 - width);
+    if (pos_y < 0)
+        *y = FIX32(0);
+    if (pos_y > sgp.camera.map_height - height)
+        *y = FIX32(sgp.camera.map_height - height);
+}
+
+/**
+ * @brief Initializes a parallax layer and selects the VDP scrolling mode.
+ *
+ * The VDP scrolling mode is global, so every layer should use the same mode. In line and
+ * tile mode the map's own plane needs a layer too (one 1:1 band over the whole screen).
+ *
+ * @param parallax Layer to initialize
+ * @param plane Plane the layer drives (BG_A or BG_B)
+ * @param mode HSCROLL_PLANE, HSCROLL_LINE or HSCROLL_TILE
+ */
+static inline void SGP_ParallaxInit(SGPParallax *parallax, VDPPlane plane, u16 mode)
+{
+    parallax->plane = plane;
+    parallax->mode = mode;
+    parallax->band_count = 0;
+    parallax->v_ratio = SGP_PARALLAX_RATIO_ONE >> 3; // Matches the legacy BG_B >> 3 rate
+    parallax->v_value = 0;
+    parallax->v_dirty = true;
+    parallax->dirty = true;
+    parallax->next = NULL;
+    // Lines no band covers are uploaded with the span between bands, so they must scroll 0
+    for (u16 line = 0; line < SGP_PARALLAX_MAX_LINES; line++)
+        parallax->hscroll[line] = 0;
+    VDP_setScrollingMode(mode, VSCROLL_PLANE);
+}
+
+/**
+ * @brief Adds a band to a parallax layer.
+ * @param parallax Layer to extend
+ * @param first First scanline (line mode) or tile row (tile mode); ignored in plane mode
+ * @param count Scanlines or tile rows covered
+ * @param ratio Scroll rate relative to the camera, 8.8 fixed point (0x100 = 1:1)
+ * @return Band index, or SGP_PARALLAX_NONE if the layer is full or the band is out of range
+ */
+static inline u8 SGP_ParallaxAddBand(SGPParallax *parallax, u16 first, u16 count, u16 ratio)
+{
+    const u16 rows = (parallax->mode == HSCROLL_TILE) ? (SGP_PARALLAX_MAX_LINES >> 3) : SGP_PARALLAX_MAX_LINES;
+    if (parallax->band_count >= SGP_PARALLAX_MAX_BANDS || count == 0 || first >= rows || count > rows - first)
+        return SGP_PARALLAX_NONE;
+
+    SGPParallaxBand *band = &parallax->bands[parallax->band_count];
+    band->first = first;
+    band->count = count;
+    band->ratio = ratio;
+    band->value = 0;
+    band->dirty = true;
+    parallax->dirty = true;
+    return parallax->band_count++;
+}
+
+/**
+ * @brief Changes a band's scroll rate; it is rewritten on the next camera update, moved or not.
+ */
+static inline void SGP_ParallaxSetBandRatio(SGPParallax *parallax, u8 band, u16 ratio)
+{
+    if (band >= parallax->band_count)
+        return;
+    parallax->bands[band].ratio = ratio;
+    parallax->bands[band].dirty = true;
+    parallax->dirty = true;
+}
+
+/**
+ * @brief Sets the vertical scroll rate of the layer's plane.
+ * @param ratio 8.8 fixed point; the result is clamped to the camera's max_vertical_scroll
+ */
+static inline void SGP_ParallaxSetVerticalRatio(SGPParallax *parallax, u16 ratio)
+{
+    parallax->v_ratio = ratio;
+    parallax->v_dirty = true;
+    parallax->dirty = true;
+}
+
+/**
+ * @brief Recomputes the bands whose value changed and queues the table upload.
+ *
+ * Only changed bands are refilled; the changed span is submitted as a single DMA_QUEUE
+ * transfer, which SGDK flushes during VBlank.
+ *
+ * @param parallax Layer to update
+ * @param camera_x Camera X in pixels
+ * @param camera_y Camera Y in pixels
+ * @return Number of bands rewritten
+ */
+static inline u8 SGP_ParallaxUpdate(SGPParallax *parallax, s16 camera_x, s16 camera_y)
+{
+    u16 dirty_first = SGP_PARALLAX_MAX_LINES;
+    u16 dirty_end = 0;
+    u8 rewritten = 0;
+    parallax->dirty = false;
+
+    for (u8 i = 0; i < parallax->band_count; i++)
+    {
+        SGPParallaxBand *band = &parallax->bands[i];
+        const s16 value = (s16)(0 - (((s32)camera_x * band->ratio) >> 8));
+        if (value == band->value && !band->dirty)
+            continue;
+
+        band->value = value;
+        band->dirty = false;
+        rewritten++;
+
+        if (parallax->mode == HSCROLL_PLANE)
+        {
+            SGP_VdpSetHScroll(parallax->plane, value);
+            continue;
+        }
+
+        s16 *dst = &parallax->hscroll[band->first];
+        for (u16 n = band->count; n; n--)
+            *dst++ = value;
+        if (band->first < dirty_first)
+            dirty_first = band->first;
+        if (band->first + band->count > dirty_end)
+            dirty_end = band->first + band->count;
+    }
+
+    if (dirty_first < dirty_end)
+    {
+        if (parallax->mode == HSCROLL_TILE)
+            VDP_setHorizontalScrollTile(parallax->plane, dirty_first, &parallax->hscroll[dirty_first],
+                                        dirty_end - dirty_first, DMA_QUEUE);
+        else
+            VDP_setHorizontalScrollLine(parallax->plane, dirty_first, &parallax->hscroll[dirty_first],
+                                        dirty_end - dirty_first, DMA_QUEUE);
+    }
+
+    s32 v_value = ((s32)camera_y * parallax->v_ratio) >> 8;
+    if (v_value > sgp.camera.max_vertical_scroll)
+        v_value = sgp.camera.max_vertical_scroll;
+    if (parallax->v_dirty || v_value != parallax->v_value)
+    {
+        parallax->v_value = (s16)v_value;
+        parallax->v_dirty = false;
+        SGP_VdpSetVScroll(parallax->plane, (s16)v_value);
+    }
+    return rewritten;
+}
+
+// Moves a desired camera coordinate so the target stays inside +/- half_size of the current one
+static inline s16 SGP_CameraDeadzoneAxis(s16 current, s16 desired, u16 half_size)
+{
+    if (desired > current + (s16)half_size)
+        return desired - (s16)half_size;
+    if (desired < current - (s16)half_size)
+        return desired + (s16)half_size;
+    return current;
+}
+
+// Eases a sub-pixel position toward target by 1/2^shift of the distance, snapping when the step vanishes
+static inline s16 SGP_CameraSmoothAxis(fix32 *position, s16 target, u8 shift)
+{
+    const fix32 step = (FIX32(target) - *position) >> shift;
+    if (step == 0)
+        *position = FIX32(target);
+    else
+        *position += step;
+    return F32_toInt(*position);
+}
+
+/**
+ * The map engine streams the plane in 16px metatile columns and rows. A column costs two tile
+ * columns of the visible height (plus margin), a row two tile rows of the visible width.
+ */
+#define SGP_STREAM_STEP_SHIFT 4
+static inline u16 SGP_CameraStreamColumnBytes(void) { return ((screenHeight >> 3) + 4) << 2; }
+static inline u16 SGP_CameraStreamRowBytes(void) { return ((screenWidth >> 3) + 4) << 2; }
+
+// Limits one axis of a camera move to at most `steps` newly exposed metatile columns/rows
+static inline s16 SGP_CameraStreamClampAxis(s16 current, s16 target, u16 steps)
+{
+    const s16 current_step = current >> SGP_STREAM_STEP_SHIFT;
+    if (target > current)
+    {
+        const s16 limit = (s16)(((current_step + (s16)steps + 1) << SGP_STREAM_STEP_SHIFT) - 1);
+        return (target > limit) ? limit : target;
+    }
+    const s16 limit = (s16)((current_step - (s16)steps) << SGP_STREAM_STEP_SHIFT);
+    return (target < limit) ? limit : target;
+}
+
+/**
+ * @brief Spreads a camera move over several frames when it exceeds the stream budget.
+ *
+ * Counts the metatile columns and rows the move would expose; if their upload cost fits in
+ * sgp.camera.stream_budget the move is kept, otherwise the budget is handed out one column /
+ * one row at a time (at least one step per moving axis so the camera always progresses).
+ */
+static inline void SGP_CameraApplyStreamBudget(s16 *new_x, s16 *new_y)
+{
+    const s16 cur_x = (s16)sgp.camera.current_x;
+    const s16 cur_y = (s16)sgp.camera.current_y;
+    s16 cols = (*new_x >> SGP_STREAM_STEP_SHIFT) - (cur_x >> SGP_STREAM_STEP_SHIFT);
+    s16 rows = (*new_y >> SGP_STREAM_STEP_SHIFT) - (cur_y >> SGP_STREAM_STEP_SHIFT);
+    if (cols < 0)
+        cols = -cols;
+    if (rows < 0)
+        rows = -rows;
+
+    const u16 col_bytes = SGP_CameraStreamColumnBytes();
+    const u16 row_bytes = SGP_CameraStreamRowBytes();
+    const u32 cost = (u32)cols * col_bytes + (u32)rows * row_bytes;
+    sgp.camera.stream_pending = false;
+    if (sgp.camera.stream_budget == 0 || cost <= sgp.camera.stream_budget)
+        return;
+
+    u16 allowed_cols = (cols > 0) ? 1 : 0;
+    u16 allowed_rows = (rows > 0) ? 1 : 0;
+    const u16 minimum = allowed_cols * col_bytes + allowed_rows * row_bytes;
+    u16 budget = (sgp.camera.stream_budget > minimum) ? sgp.camera.stream_budget - minimum : 0;
+    while (budget > 0)
+    {
+        bool spent = false;
+        if (allowed_cols < (u16)cols && budget >= col_bytes)
+        {
+            allowed_cols++;
+            budget -= col_bytes;
+            spent = true;
+        }
+        if (allowed_rows < (u16)rows && budget >= row_bytes)
+        {
+            allowed_rows++;
+            budget -= row_bytes;
+            spent = true;
+        }
+        if (!spent)
+            break;
+    }
+
+    *new_x = SGP_CameraStreamClampAxis(cur_x, *new_x, allowed_cols);
+    *new_y = SGP_CameraStreamClampAxis(cur_y, *new_y, allowed_rows);
+    sgp.camera.stream_pending = true;
+}
+
+// Next horizontal shake offset; alternates sign each frame and decays along shake_table
+static inline s16 SGP_CameraAdvanceShake(void)
+{
+    if (sgp.camera.shake_frames == 0)
+        return 0;
+
+    u16 index = sgp.camera.shake_phase >> 8;
+    if (index >= SGP_SHAKE_TABLE_SIZE)
+        index = SGP_SHAKE_TABLE_SIZE - 1;
+    s16 offset = sgp.camera.shake_table[index];
+    if (sgp.camera.shake_frames & 1)
+        offset = -offset;
+
+    sgp.camera.shake_phase += sgp.camera.shake_step;
+    sgp.camera.shake_frames--;
+    return offset;
+}
+
+/**
+ * @brief Follows a target position with the camera, clamping to map bounds.
+ * @param target Pointer to CameraTarget struct
+ */
+static inline void SGP_CameraFollowTarget(SGPCameraTarget *target)
+{
+    if (!sgp.camera.active) // Check if camera is active and map is set
+    {
+        return; // Camera not active, skip following
+    }
+
+    // Use target position as camera position, clamp to map bounds
+    s16 new_camera_x = target->sprite_world_x - target->offset_x;
+    s16 new_camera_y = target->sprite_world_y - target->offset_y;
+
+    if (sgp.camera.type != CAMERA_LOCKED)
+    {
+        new_camera_x = SGP_CameraDeadzoneAxis((s16)sgp.camera.current_x, new_camera_x, sgp.camera.deadzone_w);
+        new_camera_y = SGP_CameraDeadzoneAxis((s16)sgp.camera.current_y, new_camera_y, sgp.camera.deadzone_h);
+    }
+
+    if (new_camera_x < 0)
+        new_camera_x = 0;
+    if (new_camera_x > sgp.camera.map_width - screenWidth)
+        new_camera_x = sgp.camera.map_width - screenWidth;
+    if (new_camera_y < 0)
+        new_camera_y = 0;
+    if (new_camera_y > sgp.camera.map_height - screenHeight)
+        new_camera_y = sgp.camera.map_height - screenHeight;
+
+    if (sgp.camera.type == CAMERA_SMOOTH)
+    {
+        new_camera_x = SGP_CameraSmoothAxis(&sgp.camera.smooth_x, new_camera_x, sgp.camera.smooth_shift);
+        new_camera_y = SGP_CameraSmoothAxis(&sgp.camera.smooth_y, new_camera_y, sgp.camera.smooth_shift);
+    }
+
+    SGP_CameraApplyStreamBudget(&new_camera_x, &new_camera_y);
+
+    const s16 shake_offset = SGP_CameraAdvanceShake();
+    const bool moved = (sgp.camera.current_x != (u32)new_camera_x) ||
+                       (sgp.camera.current_y != (u32)new_camera_y) ||
+                       (sgp.camera.shake_offset != shake_offset);
+
+    sgp.camera.current_x = (u32)new_camera_x;
+    sgp.camera.current_y = (u32)new_camera_y;
+    sgp.camera.shake_offset = shake_offset;
+
+    // Shake is applied at commit time only; current_x stays the unshaken position
+    if (shake_offset != 0)
+    {
+        new_camera_x += shake_offset;
+        if (new_camera_x < 0)
+            new_camera_x = 0;
+        if (new_camera_x > sgp.camera.map_width - screenWidth)
+            new_camera_x = sgp.camera.map_width - screenWidth;
+    }
+    sgp.camera.view_x = new_camera_x;
+    sgp.camera.view_y = new_camera_y;
+
+    if (moved)
+    {
+        SGP_VdpScrollMap(sgp.camera.map, new_camera_x, new_camera_y);
+
+        if (sgp.camera.parallax)
+        {
+            for (SGPParallax *layer = sgp.camera.parallax; layer; layer = layer->next)
+                SGP_ParallaxUpdate(layer, new_camera_x, new_camera_y);
+        }
+        else
+        {
+            static s16 bg_hscroll = 0, bg_vscroll = 0;
+            bg_hscroll = (0 - new_camera_x) >> 3; // Convert to tile units (8 pixels)
+            bg_vscroll = new_camera_y >> 3;       // Convert to tile units (8
+
+            if (bg_vscroll > (s16)sgp.camera.max_vertical_scroll)
+            {
+                bg_vscroll = sgp.camera.max_vertical_scroll;
+            }
+
+            SGP_VdpSetHScroll(BG_B, bg_hscroll);
+            SGP_VdpSetVScroll(BG_B, bg_vscroll);
+        }
+    }
+    else
+    {
+        // Ratio changes made while the camera is still apply this frame
+        for (SGPParallax *layer = sgp.camera.parallax; layer; layer = layer->next)
+        {
+            if (layer->dirty)
+                SGP_ParallaxUpdate(layer, new_camera_x, new_camera_y);
+        }
+    }
+    if (target->sprite)
+    {
+        SPR_setPosition(target->sprite,
+                        target->sprite_world_x - new_camera_x,
+                        target->sprite_world_y - new_camera_y);
+    }
+}
+
+/**
+ * @brief Activates the camera, allowing it to follow a target.
+ */
+static inline void SGP_activateCamera(void)
+{
+    sgp.camera.active = true;
+}
+/**
+ * @brief Deactivates the camera, stopping it from following a target.
+ */
+static inline void SGP_deactivateCamera(void)
+{
+    sgp.camera.active = false;
+}
+/**
+ * @brief Checks if the camera is currently active.
+ * @return True if the camera is active, false otherwise.
+ */
+static inline bool SGP_isCameraActive(void)
+{
+    return sgp.camera.active;
+}
+/**
+ * @brief Updates the camera position directly without following a target.
+ * @param x New X position
+ * @param y New Y position
+ */
+static inline void SGP_UpdateCameraPosition(u32 x, u32 y)
+{
+    if (sgp.camera.active)
+    {
+        return; // if active, camera tracks target
+    }
+    sgp.camera.current_x = x;
+    sgp.camera.current_y = y;
+    sgp.camera.smooth_x = FIX32((s16)x);
+    sgp.camera.smooth_y = FIX32((s16)y);
+    sgp.camera.view_x = (s16)x;
+    sgp.camera.view_y = (s16)y;
+    SGP_VdpScrollMap(sgp.camera.map, x, y);
+}
+/**
+ * @brief Attaches a parallax layer to the camera; it is updated on every committed scroll.
+ *
+ * Once a layer is attached the camera stops writing the legacy BG_B scroll pair.
+ * Layers are updated once immediately so the plane matches the current camera.
+ */
+static inline void SGP_CameraAddParallax(SGPParallax *parallax)
+{
+    parallax->next = sgp.camera.parallax;
+    sgp.camera.parallax = parallax;
+    SGP_ParallaxUpdate(parallax, (s16)sgp.camera.current_x, (s16)sgp.camera.current_y);
+}
+
+/**
+ * @brief Detaches every parallax layer and returns to the legacy BG_B scroll.
+ */
+static inline void SGP_CameraClearParallax(void)
+{
+    sgp.camera.parallax = NULL;
+}
+
+/**
+ * @brief Selects how the camera tracks its target.
+ *
+ * CAMERA_DEADZONE and CAMERA_SMOOTH only commit a scroll when the integer camera position
+ * actually changes, so small target jitter inside the deadzone costs no VDP writes.
+ *
+ * @param type CAMERA_LOCKED, CAMERA_DEADZONE or CAMERA_SMOOTH
+ */
+static inline void SGP_CameraSetType(u8 type)
+{
+    sgp.camera.type = type;
+    sgp.camera.smooth_x = FIX32((s16)sgp.camera.current_x);
+    sgp.camera.smooth_y = FIX32((s16)sgp.camera.current_y);
+}
+
+/**
+ * @brief Gets the current camera type.
+ */
+static inline u8 SGP_CameraGetType(void)
+{
+    return sgp.camera.type;
+}
+
+/**
+ * @brief Sets the deadzone window used by CAMERA_DEADZONE and CAMERA_SMOOTH.
+ * @param half_width Target may drift this many pixels left/right before the camera moves
+ * @param half_height Target may drift this many pixels up/down before the camera moves
+ */
+static inline void SGP_CameraSetDeadzone(u16 half_width, u16 half_height)
+{
+    sgp.camera.deadzone_w = half_width;
+    sgp.camera.deadzone_h = half_height;
+}
+
+/**
+ * @brief Sets the CAMERA_SMOOTH easing strength.
+ * @param shift Camera covers 1/2^shift of the remaining distance per frame (e.g. 3 = 1/8)
+ */
+static inline void SGP_CameraSetSmoothing(u8 shift)
+{
+    sgp.camera.smooth_shift = shift;
+}
+
+/**
+ * @brief Enables streaming mode: caps the plane data a camera move may upload per frame.
+ *
+ * Large jumps (fast diagonals, teleports) then scroll over several frames instead of
+ * overrunning VBlank. sgp.camera.current_x/current_y always hold the committed position.
+ *
+ * @param bytes_per_frame Upload budget in bytes, 0 disables the limit
+ */
+static inline void SGP_CameraSetStreamBudget(u16 bytes_per_frame)
+{
+    sgp.camera.stream_budget = bytes_per_frame;
+}
+
+/**
+ * @brief Gets the per-frame plane upload budget (0 = unlimited).
+ */
+static inline u16 SGP_CameraGetStreamBudget(void)
+{
+    return sgp.camera.stream_budget;
+}
+
+/**
+ * @brief Returns true while the camera is still catching up with its target under the budget.
+ */
+static inline bool SGP_isCameraStreaming(void)
+{
+    return sgp.camera.stream_pending;
+}
+
+/**
+ * @brief Sets the horizontal scroll limit for the camera.
+ * @param limit New vertical scroll limit in tiles
+ */
+static inline void SGP_CameraSetVerticalScrollLimit(u16 limit)
+{
+    sgp.camera.max_vertical_scroll = limit;
+}
+
+/**
+ * @brief Gets the vertical scroll limit for the camera.
+ * @return Current vertical scroll limit in tiles
+ */
+static inline u16 SGP_CameraGetVerticalScrollLimit(void)
+{
+    return sgp.camera.max_vertical_scroll;
+}
+
+/**
+ * @brief Starts a non-blocking camera shake advanced by SGP_CameraFollowTarget.
+ *
+ * The horizontal offset alternates sign every frame and decays linearly to zero over
+ * the duration. Magnitudes are precomputed here, so each frame costs a table load.
+ *
+ * @param duration Duration of the shake in frames (0 stops any running shake)
+ * @param intensity Initial shake offset in pixels
+ */
+static inline void SGP_CameraStartShake(u16 duration, s16 intensity)
+{
+    sgp.camera.shake_frames = duration;
+    sgp.camera.shake_phase = 0;
+    if (duration == 0)
+        return;
+
+    for (u16 i = 0; i < SGP_SHAKE_TABLE_SIZE; i++)
+    {
+        sgp.camera.shake_table[i] = (s16)(((s32)intensity * (SGP_SHAKE_TABLE_SIZE - i)) >> SGP_SHAKE_TABLE_SHIFT);
+    }
+
+    const u32 step = ((u32)SGP_SHAKE_TABLE_SIZE << 8) / duration;
+    sgp.camera.shake_step = step ? ((step > 0xFFFF) ? 0xFFFF : (u16)step) : 1;
+}
+
+/**
+ * @brief Stops the current shake; the next SGP_CameraFollowTarget restores the scroll.
+ */
+static inline void SGP_CameraStopShake(void)
+{
+    sgp.camera.shake_frames = 0;
+}
+
+/**
+ * @brief Checks if a camera shake is still running.
+ * @return True while shake frames remain
+ */
+static inline bool SGP_isCameraShaking(void)
+{
+    return sgp.camera.shake_frames != 0;
+}
+
+/**
+ * @brief Shakes the camera for a specified duration and intensity.
+ * @param duration Duration of the shake in frames
+ * @param intensity intensity of the shake (in pixels)
+ *
+ * Blocks the main loop for the whole shake; prefer SGP_CameraStartShake.
+ */
+static inline void SGP_ShakeCamera(u16 duration, s16 intensity)
+{
+    SGP_deactivateCamera(); // Disable camera tracking during shake
+    for (u16 i = 0; i < duration; i++)
+    {
+        s16 shake_x = (i % 2 == 0) ? intensity : -intensity;
+        sgp.camera.current_x += shake_x;
+        SGP_UpdateCameraPosition(sgp.camera.current_x, sgp.camera.current_y);
+        SYS_doVBlankProcess();           // Wait for VBlank to apply shake
+        sgp.camera.current_x -= shake_x; // Restore position for next frame
+    }
+    SGP_activateCamera(); // Re-enable camera tracking after shake
+}
+//----------------------------------------------------------------------------------
+// Collision Functions
+//----------------------------------------------------------------------------------
+static inline bool SGP_CheckBoxCollision(const SGPBox *a, const SGPBox *b)
+{
+    return (a->x < b->x + b->w &&
+            a->x + a->w > b->x &&
+            a->y < b->y + b->h &&
+            a->y + a->h > b->y);
+}
+
+//----------------------------------------------------------------------------------
+// Broadphase (uniform grid)
+//----------------------------------------------------------------------------------
+// Grid column/row of a world coordinate, clamped to the grid
+static inline u16 SGP_BroadphaseCellCoord(s16 local, u16 count)
+{
+    if (local < 0)
+        return 0;
+    u16 cell = (u16)local >> SGP_BROADPHASE_CELL_SHIFT;
+    return (cell >= count) ? count - 1 : cell;
+}
+
+static inline u16 SGP_BroadphaseCellOf(const SGPBroadphase *bp, u16 x, u16 y)
+{
+    const u16 col = SGP_BroadphaseCellCoord((s16)(x - bp->origin_x), SGP_BROADPHASE_COLS);
+    const u16 row = SGP_BroadphaseCellCoord((s16)(y - bp->origin_y), SGP_BROADPHASE_ROWS);
+    return row * SGP_BROADPHASE_COLS + col;
+}
+
+/**
+ * @brief Empties the grid for a new frame.
+ * @param bp Broadphase grid
+ * @param origin_x World X of the grid's top-left corner (usually the camera X)
+ * @param origin_y World Y of the grid's top-left corner (usually the camera Y)
+ */
+static inline void SGP_BroadphaseClear(SGPBroadphase *bp, s16 origin_x, s16 origin_y)
+{
+    bp->origin_x = origin_x;
+    bp->origin_y = origin_y;
+    bp->entry_count = 0;
+    for (u16 i = 0; i < SGP_BROADPHASE_CELLS; i++)
+    {
+        bp->cell_head[i] = SGP_BROADPHASE_NONE;
+    }
+}
+
+/**
+ * @brief Adds a box to every cell it covers.
+ * @param bp Broadphase grid
+ * @param box Box in world pixels, referenced until the next clear
+ * @param id Caller id returned by queries (e.g. entity index)
+ * @return false if the entry pool is full (the box is then not inserted at all)
+ */
+static inline bool SGP_BroadphaseInsert(SGPBroadphase *bp, const SGPBox *box, u16 id)
+{
+    const u16 col0 = SGP_BroadphaseCellCoord((s16)(box->x - bp->origin_x), SGP_BROADPHASE_COLS);
+    const u16 col1 = SGP_BroadphaseCellCoord((s16)(box->x + box->w - 1 - bp->origin_x), SGP_BROADPHASE_COLS);
+    const u16 row0 = SGP_BroadphaseCellCoord((s16)(box->y - bp->origin_y), SGP_BROADPHASE_ROWS);
+    const u16 row1 = SGP_BroadphaseCellCoord((s16)(box->y + box->h - 1 - bp->origin_y), SGP_BROADPHASE_ROWS);
+
+    if (bp->entry_count + (col1 - col0 + 1) * (row1 - row0 + 1) > SGP_BROADPHASE_MAX_ENTRIES)
+        return false;
+
+    for (u16 row = row0; row <= row1; row++)
+    {
+        u16 cell = row * SGP_BROADPHASE_COLS + col0;
+        for (u16 col = col0; col <= col1; col++, cell++)
+        {
+            const u8 entry = (u8)bp->entry_count++;
+            bp->entry_box[entry] = box;
+            bp->entry_id[entry] = id;
+            bp->entry_next[entry] = bp->cell_head[cell];
+            bp->cell_head[cell] = entry;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Collects the ids of inserted boxes overlapping a query box, each reported once.
+ * @param bp Broadphase grid
+ * @param box Query box in world pixels
+ * @param out_ids Output ids
+ * @param max_out Capacity of out_ids
+ * @return Number of ids written
+ */
+static inline u16 SGP_BroadphaseQuery(const SGPBroadphase *bp, const SGPBox *box, u16 *out_ids, u16 max_out)
+{
+    const u16 col0 = SGP_BroadphaseCellCoord((s16)(box->x - bp->origin_x), SGP_BROADPHASE_COLS);
+    const u16 col1 = SGP_BroadphaseCellCoord((s16)(box->x + box->w - 1 - bp->origin_x), SGP_BROADPHASE_COLS);
+    const u16 row0 = SGP_BroadphaseCellCoord((s16)(box->y - bp->origin_y), SGP_BROADPHASE_ROWS);
+    const u16 row1 = SGP_BroadphaseCellCoord((s16)(box->y + box->h - 1 - bp->origin_y), SGP_BROADPHASE_ROWS);
+    u16 count = 0;
+
+    for (u16 row = row0; row <= row1; row++)
+    {
+        u16 cell = row * SGP_BROADPHASE_COLS + col0;
+        for (u16 col = col0; col <= col1; col++, cell++)
+        {
+            for (u8 e = bp->cell_head[cell]; e != SGP_BROADPHASE_NONE; e = bp->entry_next[e])
+            {
+                const SGPBox *other = bp->entry_box[e];
+                if (other == box || !SGP_CheckBoxCollision(box, other))
+                    continue;
+                // Report only from the cell holding the overlap's top-left corner
+                const u16 ox = (box->x > other->x) ? box->x : other->x;
+                const u16 oy = (box->y > other->y) ? box->y : other->y;
+                if (SGP_BroadphaseCellOf(bp, ox, oy) != cell)
+                    continue;
+                if (count == max_out)
+                    return count;
+                out_ids[count++] = bp->entry_id[e];
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Starts iterating overlapping pairs (a zeroed iterator starts the same way).
+ */
+static inline void SGP_BroadphasePairsBegin(SGPBroadphasePairIter *it)
+{
+    it->cell = 0;
+    it->a = SGP_BROADPHASE_NONE;
+    it->b = SGP_BROADPHASE_NONE;
+}
+
+/**
+ * @brief Returns the next pair of overlapping boxes, each pair exactly once per frame.
+ *
+ * Only boxes sharing a cell are compared, so the cost is roughly linear in box count.
+ *
+ * @param bp Broadphase grid
+ * @param it Iterator started with SGP_BroadphasePairsBegin or zeroed
+ * @param id_a Output id of the first box
+ * @param id_b Output id of the second box
+ * @return false when there are no more pairs
+ */
+static inline bool SGP_BroadphaseNextPair(const SGPBroadphase *bp, SGPBroadphasePairIter *it, u16 *id_a, u16 *id_b)
+{
+    while (it->cell < SGP_BROADPHASE_CELLS)
+    {
+        if (it->a == it->b) // Cell not loaded yet: both NONE, or a zeroed iterator
+        {
+            it->a = bp->cell_head[it->cell];
+            it->b = (it->a == SGP_BROADPHASE_NONE) ? SGP_BROADPHASE_NONE : bp->entry_next[it->a];
+        }
+        while (it->a != SGP_BROADPHASE_NONE)
+        {
+            while (it->b != SGP_BROADPHASE_NONE)
+            {
+                const SGPBox *a = bp->entry_box[it->a];
+                const SGPBox *b = bp->entry_box[it->b];
+                const u8 b_entry = it->b;
+                it->b = bp->entry_next[it->b];
+                if (!SGP_CheckBoxCollision(a, b))
+                    continue;
+                const u16 ox = (a->x > b->x) ? a->x : b->x;
+                const u16 oy = (a->y > b->y) ? a->y : b->y;
+                if (SGP_BroadphaseCellOf(bp, ox, oy) != it->cell)
+                    continue;
+                *id_a = bp->entry_id[it->a];
+                *id_b = bp->entry_id[b_entry];
+                return true;
+            }
+            it->a = bp->entry_next[it->a];
+            it->b = (it->a == SGP_BROADPHASE_NONE) ? SGP_BROADPHASE_NONE : bp->entry_next[it->a];
+        }
+        it->cell++;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------
+// Level Tile Collision
+//----------------------------------------------------------------------------------
+/**
+ * @brief Caches the level layout so tile queries never divide or multiply.
+ *
+ * Call once after filling row_length, data_length and collision_data (e.g. on level load).
+ * Stores the row count, detects a power-of-two row length (rows indexed with a shift) and,
+ * when row_offsets is not NULL, fills it with the start index of every row. The table must
+ * hold data_length / row_length entries. Unprepared levels still work, they just pay a
+ * DIVU per query. With a fixed layout (SGP_LEVEL_ROW_SHIFT / SGP_LEVEL_ROWS) queries ignore
+ * these fields, so preparing also checks that the level matches the compiled dimensions.
+ *
+ * @param level Level to prepare
+ * @param row_offsets Optional caller-owned row start table, or NULL
+ * @return false if the level has no rows or does not match the fixed layout
+ */
+static inline bool SGP_LevelCollisionPrepare(SGPLevelCollisionData *level, u16 *row_offsets)
+{
+    level->prepare_flags = 0;
+    level->row_shift = 0;
+    level->row_offsets = NULL;
+    level->total_rows = (level->row_length == 0) ? 0 : (level->data_length / level->row_length);
+    if (level->total_rows == 0)
+    {
+        return false;
+    }
+#ifdef SGP_LEVEL_ROW_SHIFT
+    if (level->row_length != SGP_LEVEL_ROW_LENGTH)
+        return false;
+#endif
+#ifdef SGP_LEVEL_ROWS
+    if (level->total_rows != SGP_LEVEL_ROWS)
+        return false;
+#endif
+
+    if ((level->row_length & (level->row_length - 1)) == 0)
+    {
+        u8 shift = 0;
+        while ((u16)(1 << shift) < level->row_length)
+        {
+            shift++;
+        }
+        level->row_shift = shift;
+        SET_ACTIVE(level->prepare_flags, SGP_LEVEL_POW2_ROWS);
+    }
+    else if (row_offsets != NULL)
+    {
+        u16 offset = 0;
+        for (u16 row = 0; row < level->total_rows; row++)
+        {
+            row_offsets[row] = offset;
+            offset += level->row_length;
+        }
+        level->row_offsets = row_offsets;
+        SET_ACTIVE(level->prepare_flags, SGP_LEVEL_ROW_TABLE);
+    }
+
+    SET_ACTIVE(level->prepare_flags, SGP_LEVEL_PREPARED);
+    return true;
+}
+
+// Helpers for tile collision queries (constants under SGP_LEVEL_ROW_SHIFT / SGP_LEVEL_ROWS)
+static inline u16 SGP_LevelRowLength(const SGPLevelCollisionData *level)
+{
+#ifdef SGP_LEVEL_ROW_SHIFT
+    (void)level;
+    return SGP_LEVEL_ROW_LENGTH;
+#else
+    return level->row_length;
+#endif
+}
+
+static inline u16 SGP_LevelTotalRows(const SGPLevelCollisionData *level)
+{
+#ifdef SGP_LEVEL_ROWS
+    (void)level;
+    return SGP_LEVEL_ROWS;
+#else
+    if (FLAG_IS_ACTIVE(level->prepare_flags, SGP_LEVEL_PREPARED))
+        return level->total_rows;
+    return (level->row_length == 0) ? 0 : (level->data_length / level->row_length);
+#endif
+}
+
+// Index of an in-bounds tile: shift or table load when prepared, multiply otherwise
+static inline u16 SGP_LevelTileIndex(const SGPLevelCollisionData *level, u16 tile_x, u16 tile_y)
+{
+#ifdef SGP_LEVEL_ROW_SHIFT
+    (void)level;
+    return (u16)(tile_y << SGP_LEVEL_ROW_SHIFT) + tile_x;
+#else
+    if (FLAG_IS_ACTIVE(level->prepare_flags, SGP_LEVEL_POW2_ROWS))
+        return (u16)(tile_y << level->row_shift) + tile_x;
+    if (FLAG_IS_ACTIVE(level->prepare_flags, SGP_LEVEL_ROW_TABLE))
+        return level->row_offsets[tile_y] + tile_x;
+    return (u16)(tile_y * level->row_length) + tile_x;
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Streamed Collision (RLE blocks, resident window)
+//----------------------------------------------------------------------------------
+/**
+ * @brief Compresses byte-per-tile collision into streamed blocks (build tools and tests).
+ *
+ * Blocks are emitted row-major; each is a sequence of (count, value) byte pairs, count 1..255,
+ * covering its SGP_COLLISION_BLOCK_TILES rows of SGP_COLLISION_BLOCK_TILES tiles in order. dst needs
+ * 2 bytes per tile in the worst case; flat runs of a real stage compress to a few bytes a block.
+ *
+ * @param src Source tiles, row_length * rows bytes (may exceed 64K)
+ * @param row_length Tiles per row, a multiple of SGP_COLLISION_BLOCK_TILES
+ * @param rows Number of rows, a multiple of SGP_COLLISION_BLOCK_TILES
+ * @param dst Compressed output
+ * @param block_offsets Output, (row_length / SGP_COLLISION_BLOCK_TILES) * (rows / SGP_COLLISION_BLOCK_TILES) entries
+ * @return Bytes written to dst
+ */
+static inline u32 SGP_CollisionStreamEncode(const u8 *src, u16 row_length, u16 rows, u8 *dst, u32 *block_offsets)
+{
+    const u16 blocks_w = row_length >> SGP_COLLISION_BLOCK_SHIFT;
+    const u16 blocks_h = rows >> SGP_COLLISION_BLOCK_SHIFT;
+    u32 size = 0;
+    for (u16 by = 0; by < blocks_h; by++)
+    {
+        for (u16 bx = 0; bx < blocks_w; bx++)
+        {
+            *block_offsets++ = size;
+            u16 run = 0;
+            u8 value = 0;
+            for (u16 y = 0; y < SGP_COLLISION_BLOCK_TILES; y++)
+            {
+                const u8 *tile = src + ((u32)((by << SGP_COLLISION_BLOCK_SHIFT) + y) * row_length) + (bx << SGP_COLLISION_BLOCK_SHIFT);
+                for (u16 x = 0; x < SGP_COLLISION_BLOCK_TILES; x++)
+                {
+                    if (run && (tile[x] != value || run == 255))
+                    {
+                        dst[size++] = (u8)run;
+                        dst[size++] = value;
+                        run = 0;
+                    }
+                    value = tile[x];
+                    run++;
+                }
+            }
+            dst[size++] = (u8)run;
+            dst[size++] = value;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Attaches a streamed collision source to a level.
+ *
+ * Fills the level's layout (row_length, total_rows, prepared) from the block grid and clears
+ * the cache; tile_types is kept, so typed levels can stream as well. Do not call
+ * SGP_LevelCollisionPrepare on a streamed level. Nothing is resident until the first
+ * SGP_CollisionStreamUpdate.
+ *
+ * @param level Level to stream into
+ * @param stream Caller-owned stream state and cache (must outlive the level)
+ * @param rle_data Blocks from SGP_CollisionStreamEncode
+ * @param block_offsets Block offsets from SGP_CollisionStreamEncode
+ * @param blocks_w Level width in blocks
+ * @param blocks_h Level height in blocks
+ * @return false if the block grid is empty, too large or does not match the fixed layout
+ */
+static inline bool SGP_CollisionStreamInit(SGPLevelCollisionData *level, SGPCollisionStream *stream, const u8 *rle_data, const u32 *block_offsets, u16 blocks_w, u16 blocks_h)
+{
+    if (blocks_w == 0 || blocks_h == 0 || blocks_w > SGP_COLLISION_MAX_BLOCKS || blocks_h > SGP_COLLISION_MAX_BLOCKS)
+        return false;
+#ifdef SGP_LEVEL_ROW_SHIFT
+    if ((u16)(blocks_w << SGP_COLLISION_BLOCK_SHIFT) != SGP_LEVEL_ROW_LENGTH)
+        return false;
+#endif
+#ifdef SGP_LEVEL_ROWS
+    if ((u16)(blocks_h << SGP_COLLISION_BLOCK_SHIFT) != SGP_LEVEL_ROWS)
+        return false;
+#endif
+
+    stream->rle_data = rle_data;
+    stream->block_offsets = block_offsets;
+    stream->blocks_w = blocks_w;
+    stream->blocks_h = blocks_h;
+    stream->origin_x = 0;
+    stream->origin_y = 0;
+    stream->pending = true;
+    for (u16 slot = 0; slot < SGP_STREAM_WINDOW_W * SGP_STREAM_WINDOW_H; slot++)
+    {
+        stream->slot_x[slot] = SGP_STREAM_NO_BLOCK;
+        stream->slot_y[slot] = SGP_STREAM_NO_BLOCK;
+    }
+
+    level->row_length = (u16)(blocks_w << SGP_COLLISION_BLOCK_SHIFT);
+    level->data_length = 0; // Unused, the level may exceed 64K tiles
+    level->collision_data = NULL;
+    level->total_rows = (u16)(blocks_h << SGP_COLLISION_BLOCK_SHIFT);
+    level->prepare_flags = SGP_LEVEL_PREPARED;
+    level->row_shift = 0;
+    level->row_offsets = NULL;
+    level->solid_bits = NULL;
+    level->stream = stream;
+    level->block_map = NULL;
+    return true;
+}
+
+// Decodes one block into its cache slot
+static inline void SGP_CollisionStreamDecodeBlock(SGPCollisionStream *stream, u16 block_x, u16 block_y)
+{
+    const u8 *src = stream->rle_data + stream->block_offsets[(u32)block_y * stream->blocks_w + block_x];
+    const u16 slot_col = block_x & (SGP_STREAM_WINDOW_W - 1);
+    const u16 slot_row = block_y & (SGP_STREAM_WINDOW_H - 1);
+    u8 *row = &stream->tiles[slot_row << SGP_COLLISION_BLOCK_SHIFT][slot_col << SGP_COLLISION_BLOCK_SHIFT];
+    u8 run = 0;
+    u8 value = 0;
+    for (u16 y = 0; y < SGP_COLLISION_BLOCK_TILES; y++)
+    {
+        for (u16 x = 0; x < SGP_COLLISION_BLOCK_TILES; x++)
+        {
+            if (run == 0)
+            {
+                run = *src++;
+                value = *src++;
+            }
+            row[x] = value;
+            run--;
+        }
+        row += SGP_STREAM_CACHE_COLS;
+    }
+
+    const u16 slot = (slot_row << SGP_STREAM_WINDOW_SHIFT_X) + slot_col;
+    stream->slot_x[slot] = block_x;
+    stream->slot_y[slot] = block_y;
+}
+
+// Decodes the missing blocks of [block_x0, block_x1] x [block_y0, block_y1] while *budget lasts
+static inline u16 SGP_CollisionStreamFill(SGPCollisionStream *stream, s16 block_x0, s16 block_x1, s16 block_y0, s16 block_y1, u16 *budget)
+{
+    u16 decoded = 0;
+    for (s16 by = block_y0; by <= block_y1; by++)
+    {
+        for (s16 bx = block_x0; bx <= block_x1; bx++)
+        {
+            const u16 slot = ((by & (SGP_STREAM_WINDOW_H - 1)) << SGP_STREAM_WINDOW_SHIFT_X) + (bx & (SGP_STREAM_WINDOW_W - 1));
+            if (stream->slot_x[slot] == (u16)bx && stream->slot_y[slot] == (u16)by)
+                continue;
+            if (*budget == 0)
+            {
+                stream->pending = true;
+                return decoded;
+            }
+            SGP_CollisionStreamDecodeBlock(stream, (u16)bx, (u16)by);
+            (*budget)--;
+            decoded++;
+        }
+    }
+    return decoded;
+}
+
+// Window start on one axis: centered on the view, clamped to the level
+static inline s16 SGP_CollisionStreamOrigin(s16 view, u16 screen_size, u16 window_blocks, u16 level_blocks)
+{
+    s16 origin = (s16)((view + (s16)(screen_size >> 1)) >> SGP_MAP_BLOCK_SHIFT) - (s16)(window_blocks >> 1);
+    if (origin > (s16)level_blocks - (s16)window_blocks)
+        origin = (s16)level_blocks - (s16)window_blocks;
+    if (origin < 0)
+        origin = 0;
+    return origin;
+}
+
+/**
+ * @brief Moves the resident window to the camera and decodes the blocks entering it.
+ *
+ * The window is centered on the view; blocks under the view are decoded before the margin, so
+ * a tight budget still resolves what is on screen first. With a steady scroll only one column
+ * or row of blocks enters at a time. Call once per frame, e.g. with sgp.camera.view_x/view_y.
+ *
+ * @param stream Stream attached with SGP_CollisionStreamInit
+ * @param view_x Camera left edge in pixels
+ * @param view_y Camera top edge in pixels
+ * @param max_blocks Decode budget for this call (0 = unlimited)
+ * @return Number of blocks decoded; stream->pending is set if some are still missing
+ */
+static inline u16 SGP_CollisionStreamUpdate(SGPCollisionStream *stream, s16 view_x, s16 view_y, u16 max_blocks)
+{
+    stream->origin_x = SGP_CollisionStreamOrigin(view_x, screenWidth, SGP_STREAM_WINDOW_W, stream->blocks_w);
+    stream->origin_y = SGP_CollisionStreamOrigin(view_y, screenHeight, SGP_STREAM_WINDOW_H, stream->blocks_h);
+    s16 last_x = stream->origin_x + SGP_STREAM_WINDOW_W - 1;
+    s16 last_y = stream->origin_y + SGP_STREAM_WINDOW_H - 1;
+    if (last_x >= (s16)stream->blocks_w)
+        last_x = (s16)stream->blocks_w - 1;
+    if (last_y >= (s16)stream->blocks_h)
+        last_y = (s16)stream->blocks_h - 1;
+
+    // Blocks under the view, clipped to the window
+    s16 view_x0 = view_x >> SGP_MAP_BLOCK_SHIFT;
+    s16 view_y0 = view_y >> SGP_MAP_BLOCK_SHIFT;
+    s16 view_x1 = (s16)(view_x + (s16)screenWidth - 1) >> SGP_MAP_BLOCK_SHIFT;
+    s16 view_y1 = (s16)(view_y + (s16)screenHeight - 1) >> SGP_MAP_BLOCK_SHIFT;
+    if (view_x0 < stream->origin_x)
+        view_x0 = stream->origin_x;
+    if (view_y0 < stream->origin_y)
+        view_y0 = stream->origin_y;
+    if (view_x1 > last_x)
+        view_x1 = last_x;
+    if (view_y1 > last_y)
+        view_y1 = last_y;
+
+    u16 budget = max_blocks ? max_blocks : SGP_STREAM_WINDOW_W * SGP_STREAM_WINDOW_H;
+    stream->pending = false;
+    u16 decoded = SGP_CollisionStreamFill(stream, view_x0, view_x1, view_y0, view_y1, &budget);
+    if (!stream->pending)
+        decoded += SGP_CollisionStreamFill(stream, stream->origin_x, last_x, stream->origin_y, last_y, &budget);
+    return decoded;
+}
+
+// Collision byte of an in-bounds tile of a streamed level; tiles outside the resident window read 0
+static inline u8 SGP_CollisionStreamTile(const SGPCollisionStream *stream, u16 tile_x, u16 tile_y)
+{
+    const u16 block_x = tile_x >> SGP_COLLISION_BLOCK_SHIFT;
+    const u16 block_y = tile_y >> SGP_COLLISION_BLOCK_SHIFT;
+    const u16 slot = ((block_y & (SGP_STREAM_WINDOW_H - 1)) << SGP_STREAM_WINDOW_SHIFT_X) + (block_x & (SGP_STREAM_WINDOW_W - 1));
+    if (stream->slot_x[slot] != block_x || stream->slot_y[slot] != block_y)
+        return 0;
+    return stream->tiles[tile_y & (SGP_STREAM_CACHE_ROWS - 1)][tile_x & (SGP_STREAM_CACHE_COLS - 1)];
+}
+
+//----------------------------------------------------------------------------------
+// Deduplicated Collision Blocks (block map + unique patterns)
+//----------------------------------------------------------------------------------
+// True if the block at src (rows row_length apart) equals a stored pattern
+static inline bool SGP_BlockMatchesPattern(const u8 *src, u16 row_length, const u8 *pattern)
+{
+    for (u16 y = 0; y < SGP_COLLISION_BLOCK_TILES; y++, src += row_length)
+    {
+        for (u16 x = 0; x < SGP_COLLISION_BLOCK_TILES; x++)
+        {
+            if (src[x] != *pattern++)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Splits byte-per-tile collision into a block map and unique block patterns (build tools and tests).
+ *
+ * Identical blocks share one pattern, so collision ROM grows with the number of distinct blocks
+ * instead of level length. Patterns are stored row by row, SGP_COLLISION_BLOCK_TILES^2 bytes each.
+ *
+ * @param src Source tiles, row_length * rows bytes (may exceed 64K)
+ * @param row_length Tiles per row, a multiple of SGP_COLLISION_BLOCK_TILES
+ * @param rows Number of rows, a multiple of SGP_COLLISION_BLOCK_TILES
+ * @param block_map Output, (rows / SGP_COLLISION_BLOCK_TILES) rows of 2^map_shift entries
+ * @param map_shift log2 of the map row stride, at least log2(row_length / SGP_COLLISION_BLOCK_TILES)
+ * @param patterns Output, max_patterns * SGP_COLLISION_BLOCK_TILES^2 bytes
+ * @param max_patterns Pattern capacity
+ * @return Number of unique patterns, 0 if more than max_patterns are needed (or more than 256 with SGP_BLOCK_INDEX_U8)
+ */
+static inline u16 SGP_LevelBlocksBuild(const u8 *src, u16 row_length, u16 rows, SGPBlockIndex *block_map, u8 map_shift, u8 *patterns, u16 max_patterns)
+{
+    const u16 blocks_w = row_length >> SGP_COLLISION_BLOCK_SHIFT;
+    const u16 blocks_h = rows >> SGP_COLLISION_BLOCK_SHIFT;
+    const u16 block_size = SGP_COLLISION_BLOCK_TILES * SGP_COLLISION_BLOCK_TILES;
+    u16 count = 0;
+    for (u16 by = 0; by < blocks_h; by++)
+    {
+        for (u16 bx = 0; bx < blocks_w; bx++)
+        {
+            // Compare the block in place against the stored patterns
+            const u8 *block = src + ((u32)(by << SGP_COLLISION_BLOCK_SHIFT) * row_length) + (bx << SGP_COLLISION_BLOCK_SHIFT);
+            u16 match = 0;
+            while (match < count && !SGP_BlockMatchesPattern(block, row_length, patterns + (u32)match * block_size))
+                match++;
+
+            // New pattern: only now does it need a free slot
+            if (match == count)
+            {
+                if (count == max_patterns || count == SGP_BLOCK_INDEX_MAX_PATTERNS)
+                    return 0;
+                u8 *pattern = patterns + (u32)count * block_size;
+                for (u16 y = 0; y < SGP_COLLISION_BLOCK_TILES; y++)
+                {
+                    for (u16 x = 0; x < SGP_COLLISION_BLOCK_TILES; x++)
+                        pattern[(y << SGP_COLLISION_BLOCK_SHIFT) + x] = block[(u32)y * row_length + x];
+                }
+                count++;
+            }
+            block_map[(by << map_shift) + bx] = (SGPBlockIndex)match;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Attaches a deduplicated block layout to a level.
+ *
+ * Fills the level's layout (row_length, total_rows, prepared) from the block grid; tile_types is
+ * kept. Lookups resolve with shifts and masks only: block map entry, then pattern byte. Like
+ * streamed levels, the level may exceed 65,535 tiles. Do not call SGP_LevelCollisionPrepare on it.
+ *
+ * @param level Level to fill
+ * @param block_map Pattern index of every block (SGP_LevelBlocksBuild)
+ * @param map_shift log2 of the map row stride
+ * @param patterns Unique block patterns (SGP_LevelBlocksBuild)
+ * @param blocks_w Level width in blocks
+ * @param blocks_h Level height in blocks
+ * @return false if the block grid is empty, too large or does not match the fixed layout
+ */
+static inline bool SGP_LevelBlocksInit(SGPLevelCollisionData *level, const SGPBlockIndex *block_map, u8 map_shift, const u8 *patterns, u16 blocks_w, u16 blocks_h)
+{
+    if (blocks_w == 0 || blocks_h == 0 || blocks_w > SGP_COLLISION_MAX_BLOCKS || blocks_h > SGP_COLLISION_MAX_BLOCKS ||
+        map_shift > 8 || blocks_w > (u16)(1 << map_shift))
+        return false;
+#ifdef SGP_LEVEL_ROW_SHIFT
+    if ((u16)(blocks_w << SGP_COLLISION_BLOCK_SHIFT) != SGP_LEVEL_ROW_LENGTH)
+        return false;
+#endif
+#ifdef SGP_LEVEL_ROWS
+    if ((u16)(blocks_h << SGP_COLLISION_BLOCK_SHIFT) != SGP_LEVEL_ROWS)
+        return false;
+#endif
+
+    level->row_length = (u16)(blocks_w << SGP_COLLISION_BLOCK_SHIFT);
+    level->data_length = 0; // Unused, the level may exceed 64K tiles
+    level->collision_data = NULL;
+    level->total_rows = (u16)(blocks_h << SGP_COLLISION_BLOCK_SHIFT);
+    level->prepare_flags = SGP_LEVEL_PREPARED;
+    level->row_shift = 0;
+    level->row_offsets = NULL;
+    level->solid_bits = NULL;
+    level->stream = NULL;
+    level->block_map = block_map;
+    level->block_patterns = patterns;
+    level->block_map_shift = map_shift;
+    return true;
+}
+
+// Collision byte of an in-bounds tile of a deduplicated level
+static inline u8 SGP_LevelBlocksTile(const SGPLevelCollisionData *level, u16 tile_x, u16 tile_y)
+{
+    const u16 block = level->block_map[((tile_y >> SGP_COLLISION_BLOCK_SHIFT) << level->block_map_shift) +
+                                       (tile_x >> SGP_COLLISION_BLOCK_SHIFT)];
+    return level->block_patterns[((u32)block << (SGP_COLLISION_BLOCK_SHIFT * 2)) +
+                                 ((tile_y & SGP_COLLISION_BLOCK_MASK) << SGP_COLLISION_BLOCK_SHIFT) +
+                                 (tile_x & SGP_COLLISION_BLOCK_MASK)];
+}
+
+// Block-based levels (streamed or deduplicated) have no flat collision_data to walk
+static inline bool SGP_LevelIsBlockBased(const SGPLevelCollisionData *level)
+{
+    return level->stream || level->block_map;
+}
+
+// Collision byte of an in-bounds tile of a block-based level
+static inline u8 SGP_LevelBlockTile(const SGPLevelCollisionData *level, u16 tile_x, u16 tile_y)
+{
+    if (level->stream)
+        return SGP_CollisionStreamTile(level->stream, tile_x, tile_y);
+    return SGP_LevelBlocksTile(level, tile_x, tile_y);
+}
+
+static inline bool SGP_LevelBlockTileIsSolid(const SGPLevelCollisionData *level, u16 tile_x, u16 tile_y)
+{
+    const u8 tile = SGP_LevelBlockTile(level, tile_x, tile_y);
+    if (level->tile_types)
+        return FLAG_IS_ACTIVE(level->tile_types[tile].flags, SGP_TILE_SOLID);
+    return tile == SOLID_TILE;
+}
+
+//----------------------------------------------------------------------------------
+// Packed Collision Rows (1 bit per tile)
+//----------------------------------------------------------------------------------
+/**
+ * Packed rows store one bit per tile, most significant bit first (tile 0 is bit 15 of
+ * word 0), with every row padded to a whole u16. A level using them sets solid_bits;
+ * collision_data may then be NULL, and data_length must still be row_length * rows.
+ */
+static inline u16 SGP_LevelBitRowWords(u16 row_length) { return (row_length + 15) >> 4; }
+
+// First word of a packed row (shift when prepared with a power-of-two row length)
+static inline const u16 *SGP_LevelBitRow(const SGPLevelCollisionData *level, u16 tile_y)
+{
+#ifdef SGP_LEVEL_ROW_SHIFT
+    return level->solid_bits + tile_y * SGP_LevelBitRowWords(SGP_LEVEL_ROW_LENGTH);
+#else
+    if (FLAG_IS_ACTIVE(level->prepare_flags, SGP_LEVEL_POW2_ROWS) && level->row_shift >= 4)
+        return level->solid_bits + (tile_y << (level->row_shift - 4));
+    return level->solid_bits + tile_y * SGP_LevelBitRowWords(level->row_length);
+#endif
+}
+
+/**
+ * @brief Packs one byte per tile collision data into 1 bit per tile rows.
+ * @param src Source tiles (row_length * rows bytes), SOLID_TILE becomes a set bit
+ * @param row_length Tiles per row
+ * @param rows Number of rows
+ * @param dst Destination, SGP_LevelBitRowWords(row_length) * rows words
+ */
+static inline void SGP_PackCollisionRows(const u8 *src, u16 row_length, u16 rows, u16 *dst)
+{
+    const u16 words = SGP_LevelBitRowWords(row_length);
+    for (u16 y = 0; y < rows; y++)
+    {
+        for (u16 w = 0; w < words; w++)
+        {
+            dst[w] = 0;
+        }
+        for (u16 x = 0; x < row_length; x++)
+        {
+            if (*src++ == SOLID_TILE)
+            {
+                dst[x >> 4] |= 0x8000 >> (x & 15);
+            }
+        }
+        dst += words;
+    }
+}
+
+/**
+ * @brief Tests a run of tiles [tile_x0, tile_x1] of one packed row with masked word compares.
+ * Both ends must be in bounds; a run inside one word costs a single load and AND.
+ */
+static inline bool SGP_BitRowSpanIsSolid(const u16 *row, u16 tile_x0, u16 tile_x1)
+{
+    const u16 first_word = tile_x0 >> 4;
+    const u16 last_word = tile_x1 >> 4;
+    const u16 first_mask = 0xFFFF >> (tile_x0 & 15);
+    const u16 last_mask = (u16)(0xFFFF << (15 - (tile_x1 & 15)));
+
+    if (first_word == last_word)
+        return (row[first_word] & first_mask & last_mask) != 0;
+    if (row[first_word] & first_mask)
+        return true;
+    for (u16 w = first_word + 1; w < last_word; w++)
+    {
+        if (row[w])
+            return true;
+    }
+    return (row[last_word] & last_mask) != 0;
+}
+
+/**
+ * @brief Tests whether any tile in the horizontal run [tile_x0, tile_x1] of row tile_y is solid.
+ *
+ * OOB rules match calling SGP_TileIsSolidXY on every tile of the run. Uses the packed rows when
+ * the level has them, otherwise walks the byte row from a single index computation.
+ */
+static inline bool SGP_TileRowSpanIsSolid(const SGPLevelCollisionData *level, s16 tile_x0, s16 tile_x1, s16 tile_y, bool oob_x_is_solid, bool oob_y_is_solid)
+{
+    const u16 row_len = SGP_LevelRowLength(level);
+    if (tile_x0 > tile_x1)
+        return false;
+    if (tile_x0 < 0 || tile_x1 >= (s16)row_len)
+    {
+        if (oob_x_is_solid)
+            return true;
+        if (tile_x0 < 0)
+            tile_x0 = 0;
+        if (tile_x1 >= (s16)row_len)
+            tile_x1 = (s16)row_len - 1;
+        if (tile_x0 > tile_x1)
+            return false;
+    }
+    if (tile_y < 0 || (u16)tile_y >= SGP_LevelTotalRows(level))
+        return oob_y_is_solid;
+
+    if (level->solid_bits)
+        return SGP_BitRowSpanIsSolid(SGP_LevelBitRow(level, (u16)tile_y), (u16)tile_x0, (u16)tile_x1);
+    if (SGP_LevelIsBlockBased(level))
+    {
+        for (s16 x = tile_x0; x <= tile_x1; x++)
+        {
+            if (SGP_LevelBlockTileIsSolid(level, (u16)x, (u16)tile_y))
+                return true;
+        }
+        return false;
+    }
+
+    const u8 *tile = level->collision_data + SGP_LevelTileIndex(level, (u16)tile_x0, (u16)tile_y);
+    const SGPTileType *types = level->tile_types;
+    if (types)
+    {
+        for (s16 x = tile_x0; x <= tile_x1; x++)
+        {
+            if (types[*tile++].flags & SGP_TILE_SOLID)
+                return true;
+        }
+        return false;
+    }
+    for (s16 x = tile_x0; x <= tile_x1; x++)
+    {
+        if (*tile++ == SOLID_TILE)
+            return true;
+    }
+    return false;
+}
+
+// Solidity of one collision byte: the type table when the level has one, SOLID_TILE otherwise
+static inline bool SGP_LevelByteIsSolid(const SGPLevelCollisionData *level, u8 tile)
+{
+    if (level->tile_types)
+        return FLAG_IS_ACTIVE(level->tile_types[tile].flags, SGP_TILE_SOLID);
+    return tile == SOLID_TILE;
+}
+
+// Axis-aware solidity check: control OOB behavior per axis
+static inline bool SGP_TileIsSolidXY(const SGPLevelCollisionData *level, s16 tile_x, s16 tile_y, bool oob_x_is_solid, bool oob_y_is_solid)
+{
+    const u16 row_len = SGP_LevelRowLength(level);
+    const u16 total_rows = SGP_LevelTotalRows(level);
+    if (tile_x < 0 || (u16)tile_x >= row_len)
+        return oob_x_is_solid;
+    if (tile_y < 0 || (u16)tile_y >= total_rows)
+        return oob_y_is_solid;
+
+    if (level->solid_bits)
+    {
+        const u16 *row = SGP_LevelBitRow(level, (u16)tile_y);
+        return (row[(u16)tile_x >> 4] & (0x8000 >> (tile_x & 15))) != 0;
+    }
+    if (SGP_LevelIsBlockBased(level))
+        return SGP_LevelBlockTileIsSolid(level, (u16)tile_x, (u16)tile_y);
+    // In bounds implies idx < total_rows * row_length <= data_length
+    return SGP_LevelByteIsSolid(level, level->collision_data[SGP_LevelTileIndex(level, (u16)tile_x, (u16)tile_y)]);
+}
+
+static inline bool SGP_TileIsSolid(const SGPLevelCollisionData *level, s16 tile_x, s16 tile_y, bool oob_is_solid)
+{
+    return SGP_TileIsSolidXY(level, tile_x, tile_y, oob_is_solid, oob_is_solid);
+}
+
+/**
+ * @brief Tests whether any tile in the vertical run [tile_y0, tile_y1] of column tile_x is solid.
+ *
+ * OOB rules match calling SGP_TileIsSolidXY on every tile of the run. The row address is
+ * advanced by a constant stride, so only the first tile pays for the index computation.
+ */
+static inline bool SGP_TileColumnSpanIsSolid(const SGPLevelCollisionData *level, s16 tile_x, s16 tile_y0, s16 tile_y1, bool oob_x_is_solid, bool oob_y_is_solid)
+{
+    const u16 total_rows = SGP_LevelTotalRows(level);
+    if (tile_y0 > tile_y1)
+        return false;
+    if (tile_x < 0 || (u16)tile_x >= SGP_LevelRowLength(level))
+        return oob_x_is_solid;
+    if (tile_y0 < 0 || tile_y1 >= (s16)total_rows)
+    {
+        if (oob_y_is_solid)
+            return true;
+        if (tile_y0 < 0)
+            tile_y0 = 0;
+        if (tile_y1 >= (s16)total_rows)
+            tile_y1 = (s16)total_rows - 1;
+        if (tile_y0 > tile_y1)
+            return false;
+    }
+
+    if (level->solid_bits)
+    {
+        const u16 stride = SGP_LevelBitRowWords(SGP_LevelRowLength(level));
+        const u16 *word = SGP_LevelBitRow(level, (u16)tile_y0) + ((u16)tile_x >> 4);
+        const u16 mask = 0x8000 >> (tile_x & 15);
+        for (s16 y = tile_y0; y <= tile_y1; y++)
+        {
+            if (*word & mask)
+                return true;
+            word += stride;
+        }
+        return false;
+    }
+    if (SGP_LevelIsBlockBased(level))
+    {
+        for (s16 y = tile_y0; y <= tile_y1; y++)
+        {
+            if (SGP_LevelBlockTileIsSolid(level, (u16)tile_x, (u16)y))
+                return true;
+        }
+        return false;
+    }
+
+    const u16 stride = SGP_LevelRowLength(level);
+    const u8 *tile = level->collision_data + SGP_LevelTileIndex(level, (u16)tile_x, (u16)tile_y0);
+    const SGPTileType *types = level->tile_types;
+    if (types)
+    {
+        for (s16 y = tile_y0; y <= tile_y1; y++)
+        {
+            if (types[*tile].flags & SGP_TILE_SOLID)
+                return true;
+            tile += stride;
+        }
+        return false;
+    }
+    for (s16 y = tile_y0; y <= tile_y1; y++)
+    {
+        if (*tile == SOLID_TILE)
+            return true;
+        tile += stride;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------
+// Typed Tiles (slopes, one-way platforms, hazards)
+//----------------------------------------------------------------------------------
+/**
+ * @brief Highest floor surface in one tile row of a typed level.
+ *
+ * Flat tiles whose flags match flat_mask (SGP_TILE_SOLID and/or SGP_TILE_ONE_WAY) anywhere in
+ * [tile_left, tile_right] return the row top; with SGP_TILE_SOLID in the mask, OOB tiles count
+ * as solid like SGP_TileRowSpanIsSolid. Slopes are sampled at the single pixel column center_x.
+ *
+ * @return Surface pixel y, or SGP_NO_FLOOR
+ */
+static inline s16 SGP_TileRowFloorY(const SGPLevelCollisionData *level, s16 tile_left, s16 tile_right, s16 center_x, s16 tile_y, u8 flat_mask, bool slopes)
+{
+    const u16 row_len = SGP_LevelRowLength(level);
+    const s16 top = tile_y << PIXELS_TO_TILE_SHIFT;
+    const bool oob_solid = FLAG_IS_ACTIVE(flat_mask, SGP_TILE_SOLID);
+
+    if (tile_y < 0 || (u16)tile_y >= SGP_LevelTotalRows(level))
+        return oob_solid ? top : SGP_NO_FLOOR;
+    if (tile_left < 0 || tile_right >= (s16)row_len)
+    {
+        if (oob_solid)
+            return top;
+        if (tile_left < 0)
+            tile_left = 0;
+        if (tile_right >= (s16)row_len)
+            tile_right = (s16)row_len - 1;
+    }
+
+    const SGPTileType *types = level->tile_types;
+    const s16 center_tile = center_x >> PIXELS_TO_TILE_SHIFT;
+    const u8 *tile = SGP_LevelIsBlockBased(level) ? NULL : level->collision_data + SGP_LevelTileIndex(level, (u16)tile_left, (u16)tile_y);
+    s16 floor_y = SGP_NO_FLOOR;
+    for (s16 x = tile_left; x <= tile_right; x++)
+    {
+        const SGPTileType *type = &types[tile ? *tile++ : SGP_LevelBlockTile(level, (u16)x, (u16)tile_y)];
+        if (type->flags & flat_mask)
+            return top; // A flat top is the highest surface a row can have
+        if (slopes && x == center_tile && (type->flags & SGP_TILE_SLOPE))
+        {
+            const u8 height = type->heights[center_x & COLLISION_TILE_SIZE_MASK];
+            if (height)
+                floor_y = top + SGP_COLLISION_TILE_SIZE - height;
+        }
+    }
+    return floor_y;
+}
+
+/**
+ * @brief Floor surface under a collision box in a typed level.
+ *
+ * Looks at the tile row holding the box bottom (and the next one when the bottom sits on a row
+ * boundary): solid and one-way tiles across the box width, slopes at the box's center column.
+ * Snap a grounded entity with y = floor - coll_height.
+ *
+ * @param level Typed level (tile_types set)
+ * @param coll_x Box left edge in pixels
+ * @param coll_y Box top edge in pixels
+ * @param coll_width Box width in pixels
+ * @param coll_height Box height in pixels
+ * @return Surface pixel y, or SGP_NO_FLOOR
+ */
+static inline s16 SGP_LevelFloorY(const SGPLevelCollisionData *level, s16 coll_x, s16 coll_y, u16 coll_width, u16 coll_height)
+{
+    const s16 tile_left = coll_x >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_right = (s16)(coll_x + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+    const s16 center_x = coll_x + (s16)(coll_width >> 1);
+    const s16 bottom = (s16)(coll_y + (s16)coll_height - 1);
+    const s16 row = bottom >> PIXELS_TO_TILE_SHIFT;
+    const s16 floor_y = SGP_TileRowFloorY(level, tile_left, tile_right, center_x, row, SGP_TILE_SOLID | SGP_TILE_ONE_WAY, true);
+    if (floor_y != SGP_NO_FLOOR || ((bottom + 1) >> PIXELS_TO_TILE_SHIFT) == row)
+        return floor_y;
+    // Box resting on a tile boundary: the floor is the top of the next row
+    return SGP_TileRowFloorY(level, tile_left, tile_right, center_x, row + 1, SGP_TILE_SOLID | SGP_TILE_ONE_WAY, true);
+}
+
+/**
+ * @brief ORs the SGP_TILE_* flags of every in-bounds tile a box overlaps (typed levels).
+ * @return Combined flags, 0 for untyped levels
+ */
+static inline u8 SGP_LevelBoxTileFlags(const SGPLevelCollisionData *level, s16 coll_x, s16 coll_y, u16 coll_width, u16 coll_height)
+{
+    const SGPTileType *types = level->tile_types;
+    if (!types)
+        return 0;
+
+    const s16 last_col = (s16)SGP_LevelRowLength(level) - 1;
+    const s16 last_row = (s16)SGP_LevelTotalRows(level) - 1;
+    s16 tile_left = coll_x >> PIXELS_TO_TILE_SHIFT;
+    s16 tile_right = (s16)(coll_x + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+    s16 tile_top = coll_y >> PIXELS_TO_TILE_SHIFT;
+    s16 tile_bottom = (s16)(coll_y + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT;
+    if (tile_left < 0)
+        tile_left = 0;
+    if (tile_right > last_col)
+        tile_right = last_col;
+    if (tile_top < 0)
+        tile_top = 0;
+    if (tile_bottom > last_row)
+        tile_bottom = last_row;
+
+    u8 flags = 0;
+    for (s16 y = tile_top; y <= tile_bottom; y++)
+    {
+        if (SGP_LevelIsBlockBased(level))
+        {
+            for (s16 x = tile_left; x <= tile_right; x++)
+                flags |= types[SGP_LevelBlockTile(level, (u16)x, (u16)y)].flags;
+            continue;
+        }
+        const u8 *tile = level->collision_data + SGP_LevelTileIndex(level, (u16)tile_left, (u16)y);
+        for (s16 x = tile_left; x <= tile_right; x++)
+            flags |= types[*tile++].flags;
+    }
+    return flags;
+}
+
+// Post-move DOWN check of a typed level: solid tiles, one-way tops within SGP_ONE_WAY_DEPTH, slopes
+static inline bool SGP_LevelTypedFloorHit(const SGPLevelCollisionData *level, s16 tile_left, s16 tile_right, s16 center_x, s16 bottom)
+{
+    const s16 tile_bottom = bottom >> PIXELS_TO_TILE_SHIFT;
+    if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID))
+        return true;
+    const s16 one_way = SGP_TileRowFloorY(level, tile_left, tile_right, center_x, tile_bottom, SGP_TILE_ONE_WAY, false);
+    if (one_way != SGP_NO_FLOOR && bottom - one_way < SGP_ONE_WAY_DEPTH)
+        return true;
+    return SGP_TileRowFloorY(level, tile_left, tile_right, center_x, tile_bottom, 0, true) <= bottom;
+}
+
+/**
+ * @brief Tests every tile covered by the leading edge of a collision box.
+ *
+ * Unlike corner sampling, boxes taller or wider than one tile cannot slip past a one-tile
+ * pillar between their corners. Horizontal edges use packed row spans when available.
+ * Priority matches SGP_PlayerLevelCollision: LEFT, RIGHT, UP, DOWN; no direction tests the
+ * whole box with OOB treated as solid. On typed levels only SGP_TILE_SOLID blocks, except DOWN,
+ * which also lands on one-way tops (within SGP_ONE_WAY_DEPTH) and slope surfaces.
+ */
+static inline bool SGP_LevelEdgeIsSolid(const SGPLevelCollisionData *level, s16 coll_x, s16 coll_y, u16 coll_width, u16 coll_height, SGPMovementDirection direction)
+{
+    const s16 tile_left = coll_x >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_right = (s16)(coll_x + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_top = coll_y >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_bottom = (s16)(coll_y + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT;
+
+    if (direction & SGP_DIR_LEFT)
+        return SGP_TileColumnSpanIsSolid(level, tile_left, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE);
+    if (direction & SGP_DIR_RIGHT)
+        return SGP_TileColumnSpanIsSolid(level, tile_right, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE);
+    if (direction & SGP_DIR_UP)
+        return SGP_TileRowSpanIsSolid(level, tile_left, tile_right, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID);
+    if ((direction & SGP_DIR_DOWN) && level->tile_types)
+        return SGP_LevelTypedFloorHit(level, tile_left, tile_right, coll_x + (s16)(coll_width >> 1), (s16)(coll_y + (s16)coll_height - 1));
+    if (direction & SGP_DIR_DOWN)
+        return SGP_TileRowSpanIsSolid(level, tile_left, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID);
+
+    // General rectangle-solid overlap (treat OOB as solid)
+    for (s16 y = tile_top; y <= tile_bottom; y++)
+    {
+        if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, y, true, true))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Resolves all four sides of a collision box in one query.
+ *
+ * Each bit matches SGP_LevelEdgeIsSolid for that direction (COLLIDE_LEFT for SGP_DIR_LEFT and
+ * so on), but the tile bounds are computed once. When the box is inside the level and the rows
+ * are bytes, the perimeter is walked once: the top and bottom rows feed UP/DOWN and the corner
+ * tiles shared with the side columns, which then only visit their interior tiles.
+ *
+ * @return COLLIDE_* mask of the blocked sides
+ */
+static inline u16 SGP_LevelContactMask(const SGPLevelCollisionData *level, s16 coll_x, s16 coll_y, u16 coll_width, u16 coll_height)
+{
+    const s16 tile_left = coll_x >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_right = (s16)(coll_x + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_top = coll_y >> PIXELS_TO_TILE_SHIFT;
+    const s16 tile_bottom = (s16)(coll_y + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT;
+    const SGPTileType *types = level->tile_types;
+    u16 flags = 0;
+
+    if (level->solid_bits || SGP_LevelIsBlockBased(level) || tile_left < 0 || tile_top < 0 || tile_right >= (s16)SGP_LevelRowLength(level) ||
+        tile_bottom >= (s16)SGP_LevelTotalRows(level))
+    {
+        // OOB rules differ per side; packed rows test spans a word at a time, block levels per tile
+        if (SGP_TileColumnSpanIsSolid(level, tile_left, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE))
+            SET_ACTIVE(flags, COLLIDE_LEFT);
+        if (SGP_TileColumnSpanIsSolid(level, tile_right, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE))
+            SET_ACTIVE(flags, COLLIDE_RIGHT);
+        if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID))
+            SET_ACTIVE(flags, COLLIDE_UP);
+        if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID))
+            SET_ACTIVE(flags, COLLIDE_DOWN);
+    }
+    else
+    {
+        const u16 stride = SGP_LevelRowLength(level);
+        const u16 span = (u16)(tile_right - tile_left);
+        const u8 *top_row = level->collision_data + SGP_LevelTileIndex(level, (u16)tile_left, (u16)tile_top);
+        const u8 *bottom_row = top_row + (u16)(tile_bottom - tile_top) * stride;
+
+        for (u16 x = 0; x <= span; x++)
+        {
+            const bool top_solid = types ? FLAG_IS_ACTIVE(types[top_row[x]].flags, SGP_TILE_SOLID) : (top_row[x] == SOLID_TILE);
+            const bool bottom_solid = types ? FLAG_IS_ACTIVE(types[bottom_row[x]].flags, SGP_TILE_SOLID) : (bottom_row[x] == SOLID_TILE);
+            if (top_solid)
+                SET_ACTIVE(flags, COLLIDE_UP);
+            if (bottom_solid)
+                SET_ACTIVE(flags, COLLIDE_DOWN);
+            if ((top_solid || bottom_solid) && x == 0)
+                SET_ACTIVE(flags, COLLIDE_LEFT);
+            if ((top_solid || bottom_solid) && x == span)
+                SET_ACTIVE(flags, COLLIDE_RIGHT);
+        }
+
+        // Interior rows of the side columns, skipped once both sides are known
+        const u8 *left = top_row + stride;
+        for (s16 y = tile_top + 1; y < tile_bottom && (flags & (COLLIDE_LEFT | COLLIDE_RIGHT)) != (COLLIDE_LEFT | COLLIDE_RIGHT); y++)
+        {
+            const bool left_solid = types ? FLAG_IS_ACTIVE(types[left[0]].flags, SGP_TILE_SOLID) : (left[0] == SOLID_TILE);
+            const bool right_solid = types ? FLAG_IS_ACTIVE(types[left[span]].flags, SGP_TILE_SOLID) : (left[span] == SOLID_TILE);
+            if (left_solid)
+                SET_ACTIVE(flags, COLLIDE_LEFT);
+            if (right_solid)
+                SET_ACTIVE(flags, COLLIDE_RIGHT);
+            left += stride;
+        }
+    }
+
+    // Typed levels also land on one-way tops and slopes
+    if (types && FLAG_IS_INACTIVE(flags, COLLIDE_DOWN) &&
+        SGP_LevelTypedFloorHit(level, tile_left, tile_right, coll_x + (s16)(coll_width >> 1), (s16)(coll_y + (s16)coll_height - 1)))
+        SET_ACTIVE(flags, COLLIDE_DOWN);
+    return flags;
+}
+
+// Maps a movement direction to its COLLIDE_* flag (LEFT, RIGHT, UP, DOWN priority, 0 if none)
+static inline u16 SGP_DirectionCollideFlag(SGPMovementDirection direction)
+{
+    if (direction & SGP_DIR_LEFT)
+        return COLLIDE_LEFT;
+    if (direction & SGP_DIR_RIGHT)
+        return COLLIDE_RIGHT;
+    if (direction & SGP_DIR_UP)
+        return COLLIDE_UP;
+    if (direction & SGP_DIR_DOWN)
+        return COLLIDE_DOWN;
+    return 0;
+}
+
+/**
+ * @brief Initializes an entity collision context.
+ * @param ctx Context to initialize
+ * @param level Level to collide against
+ * @param width Collision box width
+ * @param height Collision box height
+ */
+static inline void SGP_CollisionContextInit(SGPCollisionContext *ctx, const SGPLevelCollisionData *level, u16 width, u16 height)
+{
+    ctx->level = level;
+    ctx->x = 0;
+    ctx->y = 0;
+    ctx->width = width;
+    ctx->height = height;
+    ctx->last_x = 0;
+    ctx->last_y = 0;
+    ctx->known = 0;
+    ctx->flags = 0;
+}
+
+/**
+ * @brief Drops all cached results (call after changing the level or box size).
+ */
+static inline void SGP_CollisionContextReset(SGPCollisionContext *ctx)
+{
+    ctx->known = 0;
+}
+
+/**
+ * @brief Post-move level collision for one direction using the context's cache.
+ *
+ * Same semantics as SGP_PlayerLevelCollision, at ctx->x/ctx->y. Repeated queries at an
+ * unchanged position return the cached result without touching the level.
+ */
+static inline bool SGP_ContextLevelCollision(SGPCollisionContext *ctx, SGPMovementDirection direction)
+{
+    const u16 flag = SGP_DirectionCollideFlag(direction);
+    if (flag == 0)
+        return SGP_LevelEdgeIsSolid(ctx->level, ctx->x, ctx->y, ctx->width, ctx->height, direction);
+
+    if (ctx->last_x != ctx->x || ctx->last_y != ctx->y)
+    {
+        ctx->last_x = ctx->x;
+        ctx->last_y = ctx->y;
+        ctx->known = 0;
+    }
+    else if (FLAG_IS_ACTIVE(ctx->known, flag))
+    {
+        return FLAG_IS_ACTIVE(ctx->flags, flag);
+    }
+
+    bool isColliding = SGP_LevelEdgeIsSolid(ctx->level, ctx->x, ctx->y, ctx->width, ctx->height, direction);
+    SET_ACTIVE(ctx->known, flag);
+    if (isColliding)
+        SET_ACTIVE(ctx->flags, flag);
+    else
+        SET_INACTIVE(ctx->flags, flag);
+    return isColliding;
+}
+
+/**
+ * @brief All four sides for the context's box, cached as a whole mask keyed by position.
+ *
+ * Shares the per-direction cache of SGP_ContextLevelCollision: after this call, direction
+ * queries at the same position are served from the mask, and vice versa once all four sides
+ * are known.
+ *
+ * @return COLLIDE_* mask of the blocked sides
+ */
+static inline u16 SGP_ContextContactMask(SGPCollisionContext *ctx)
+{
+    if (ctx->last_x != ctx->x || ctx->last_y != ctx->y)
+    {
+        ctx->last_x = ctx->x;
+        ctx->last_y = ctx->y;
+    }
+    else if ((ctx->known & COLLIDE_SIDES) == COLLIDE_SIDES)
+    {
+        return ctx->flags & COLLIDE_SIDES;
+    }
+
+    ctx->flags = SGP_LevelContactMask(ctx->level, ctx->x, ctx->y, ctx->width, ctx->height);
+    ctx->known = COLLIDE_SIDES;
+    return ctx->flags;
+}
+
+/**
+ * @brief Resolves one direction for an array of contexts against one level in a single loop.
+ *
+ * Each context is queried at its own x/y; the result is left in its flags. Contexts that were
+ * bound to a different level are rebound and their cache dropped.
+ *
+ * @param ctx Array of contexts
+ * @param count Number of contexts
+ * @param level Level to collide against
+ * @param direction Direction to test
+ * @return Number of contexts colliding in that direction
+ */
+static inline u16 SGP_LevelCollisionBatch(SGPCollisionContext *ctx, u16 count, const SGPLevelCollisionData *level, SGPMovementDirection direction)
+{
+    u16 hits = 0;
+    for (u16 i = 0; i < count; i++, ctx++)
+    {
+        if (ctx->level != level)
+        {
+            ctx->level = level;
+            ctx->known = 0;
+        }
+        if (SGP_ContextLevelCollision(ctx, direction))
+            hits++;
+    }
+    return hits;
+}
+
+// Returns the cached context of player_index (< SGP_MAX_PLAYER_COUNT), moved to the given box
+static inline SGPCollisionContext *SGP_PlayerCollisionContext(
+    u16 player_index, s16 player_coll_x, s16 player_coll_y, u16 player_coll_width, u16 player_coll_height,
+    const SGPLevelCollisionData *level)
+{
+    static SGPCollisionContext player_ctx[SGP_MAX_PLAYER_COUNT];
+
+    SGPCollisionContext *ctx = &player_ctx[player_index];
+    if (ctx->level != level || ctx->width != player_coll_width || ctx->height != player_coll_height)
+        SGP_CollisionContextInit(ctx, level, player_coll_width, player_coll_height);
+    ctx->x = player_coll_x;
+    ctx->y = player_coll_y;
+    return ctx;
+}
+
+/**
+ * Checks for player collision against tiles using post-move collision.
+ * Call this AFTER adjusting position for the intended direction; if true, undo that axis move.
+ * The whole leading edge is tested, so hitboxes of any size need a single call per direction.
+ * Indices below SGP_MAX_PLAYER_COUNT are cached; other entities should own an SGPCollisionContext.
+ */
+static inline bool SGP_PlayerLevelCollision(
+    u16 player_index, s16 player_coll_x, s16 player_coll_y, u16 player_coll_width, u16 player_coll_height,
+    const SGPLevelCollisionData *level, SGPMovementDirection direction)
+{
+    if (player_index >= SGP_MAX_PLAYER_COUNT)
+        return SGP_LevelEdgeIsSolid(level, player_coll_x, player_coll_y, player_coll_width, player_coll_height, direction);
+
+    SGPCollisionContext *ctx = SGP_PlayerCollisionContext(player_index, player_coll_x, player_coll_y, player_coll_width, player_coll_height, level);
+    return SGP_ContextLevelCollision(ctx, direction);
+}
+
+/**
+ * @brief All four sides of a player's box in one query (see SGP_LevelContactMask).
+ *
+ * Uses the same per-player cache as SGP_PlayerLevelCollision, so the ground/ceiling/wall checks
+ * of a frame cost one perimeter walk instead of four edge sweeps.
+ *
+ * @return COLLIDE_* mask of the blocked sides
+ */
+static inline u16 SGP_PlayerLevelContacts(
+    u16 player_index, s16 player_coll_x, s16 player_coll_y, u16 player_coll_width, u16 player_coll_height,
+    const SGPLevelCollisionData *level)
+{
+    if (player_index >= SGP_MAX_PLAYER_COUNT)
+        return SGP_LevelContactMask(level, player_coll_x, player_coll_y, player_coll_width, player_coll_height);
+
+    return SGP_ContextContactMask(SGP_PlayerCollisionContext(player_index, player_coll_x, player_coll_y, player_coll_width, player_coll_height, level));
+}
+
+/**
+ * @brief Moves a collision box by a fix32 velocity and stops it flush against solid tiles.
+ *
+ * Replaces the move / SGP_PlayerLevelCollision / undo pattern: X is swept first, then Y from
+ * the resolved X, visiting every tile column or row crossed (fast movers cannot tunnel). On
+ * contact the position is snapped to the tile boundary instead of being rolled back, so the
+ * entity ends up touching the wall. OOB rules match SGP_PlayerLevelCollision: horizontal OOB
+ * is solid, vertical OOB only blocks vertical movement.
+ *
+ * On typed levels falling boxes also land on one-way tops and on slope surfaces sampled at the
+ * box's center column (a slope in the row of the old bottom lifts the box, so walking uphill
+ * with gravity applied follows the surface), and COLLIDE_HAZARD reports touched hazards.
+ *
+ * @param level Level collision data
+ * @param pos_x Box left edge in pixels (fixed-point), updated
+ * @param pos_y Box top edge in pixels (fixed-point), updated
+ * @param vel_x Horizontal velocity for this frame (fixed-point pixels)
+ * @param vel_y Vertical velocity for this frame (fixed-point pixels)
+ * @param coll_width Width of the collision box in pixels
+ * @param coll_height Height of the collision box in pixels
+ * @return COLLIDE_* mask of the sides that were blocked
+ */
+static inline u16 SGP_MoveAndCollide(const SGPLevelCollisionData *level, fix32 *pos_x, fix32 *pos_y, fix32 vel_x, fix32 vel_y, u16 coll_width, u16 coll_height)
+{
+    u16 flags = 0;
+
+    if (vel_x != 0)
+    {
+        const s16 old_left = F32_toInt(*pos_x);
+        fix32 new_x = *pos_x + vel_x;
+        const s16 new_left = F32_toInt(new_x);
+        const s16 top = F32_toInt(*pos_y);
+        const s16 tile_top = top >> PIXELS_TO_TILE_SHIFT;
+        const s16 tile_bottom = (s16)(top + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT;
+
+        if (vel_x > 0)
+        {
+            const s16 to_col = (s16)(new_left + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+            for (s16 col = ((s16)(old_left + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT) + 1; col <= to_col; col++)
+            {
+                if (SGP_TileColumnSpanIsSolid(level, col, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE))
+                {
+                    new_x = FIX32((col << PIXELS_TO_TILE_SHIFT) - (s16)coll_width);
+                    SET_ACTIVE(flags, COLLIDE_RIGHT);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const s16 to_col = new_left >> PIXELS_TO_TILE_SHIFT;
+            for (s16 col = (old_left >> PIXELS_TO_TILE_SHIFT) - 1; col >= to_col; col--)
+            {
+                if (SGP_TileColumnSpanIsSolid(level, col, tile_top, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE))
+                {
+                    new_x = FIX32((col + 1) << PIXELS_TO_TILE_SHIFT);
+                    SET_ACTIVE(flags, COLLIDE_LEFT);
+                    break;
+                }
+            }
+        }
+        *pos_x = new_x;
+    }
+
+    if (vel_y != 0)
+    {
+        const s16 old_top = F32_toInt(*pos_y);
+        fix32 new_y = *pos_y + vel_y;
+        const s16 new_top = F32_toInt(new_y);
+        const s16 left = F32_toInt(*pos_x);
+        const s16 tile_left = left >> PIXELS_TO_TILE_SHIFT;
+        const s16 tile_right = (s16)(left + (s16)coll_width - 1) >> PIXELS_TO_TILE_SHIFT;
+
+        if (vel_y > 0 && level->tile_types)
+        {
+            // Rows from the one holding the old bottom: slopes there can lift the box onto their
+            // surface, flat tops only count below the old bottom (one-way tiles land from above)
+            const s16 center_x = left + (s16)(coll_width >> 1);
+            const s16 old_bottom = (s16)(old_top + (s16)coll_height - 1);
+            const s16 new_bottom = (s16)(new_top + (s16)coll_height - 1);
+            const s16 from_row = old_bottom >> PIXELS_TO_TILE_SHIFT;
+            const s16 to_row = new_bottom >> PIXELS_TO_TILE_SHIFT;
+            for (s16 row = from_row; row <= to_row; row++)
+            {
+                const u8 flat_mask = (row > from_row) ? (SGP_TILE_SOLID | SGP_TILE_ONE_WAY) : 0;
+                const s16 floor_y = SGP_TileRowFloorY(level, tile_left, tile_right, center_x, row, flat_mask, true);
+                if (floor_y <= new_bottom)
+                {
+                    new_y = FIX32(floor_y - (s16)coll_height);
+                    SET_ACTIVE(flags, COLLIDE_DOWN);
+                    break;
+                }
+            }
+        }
+        else if (vel_y > 0)
+        {
+            const s16 to_row = (s16)(new_top + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT;
+            for (s16 row = ((s16)(old_top + (s16)coll_height - 1) >> PIXELS_TO_TILE_SHIFT) + 1; row <= to_row; row++)
+            {
+                if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, row, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID))
+                {
+                    new_y = FIX32((row << PIXELS_TO_TILE_SHIFT) - (s16)coll_height);
+                    SET_ACTIVE(flags, COLLIDE_DOWN);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const s16 to_row = new_top >> PIXELS_TO_TILE_SHIFT;
+            for (s16 row = (old_top >> PIXELS_TO_TILE_SHIFT) - 1; row >= to_row; row--)
+            {
+                if (SGP_TileRowSpanIsSolid(level, tile_left, tile_right, row, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID))
+                {
+                    new_y = FIX32((row + 1) << PIXELS_TO_TILE_SHIFT);
+                    SET_ACTIVE(flags, COLLIDE_UP);
+                    break;
+                }
+            }
+        }
+        *pos_y = new_y;
+    }
+
+    // Hazards touched on any side, including the surface the box now rests against
+    if (level->tile_types &&
+        FLAG_IS_ACTIVE(SGP_LevelBoxTileFlags(level, F32_toInt(*pos_x) - 1, F32_toInt(*pos_y) - 1, coll_width + 2, coll_height + 2), SGP_TILE_HAZARD))
+        SET_ACTIVE(flags, COLLIDE_HAZARD);
+
+    return flags;
+}
+
+//----------------------------------------------------------------------------------
+// Raycasts (grid DDA)
+//----------------------------------------------------------------------------------
+// Octagonal distance estimate: max + 3/8 min, within 7% of the Euclidean length
+static inline u16 SGP_ApproxDistance(s16 dx, s16 dy)
+{
+    u16 a = (u16)(dx < 0 ? -dx : dx);
+    u16 b = (u16)(dy < 0 ? -dy : dy);
+    if (a < b)
+    {
+        const u16 t = a;
+        a = b;
+        b = t;
+    }
+    return a + (b >> 2) + (b >> 3);
+}
+
+// Other coordinate of a ray's entry point after `travelled` pixels on the stepped axis (one division
+// per hit), clamped into the entered tile
+static inline s16 SGP_RayCrossing(s16 from, s16 delta, s16 travelled, u16 span, s16 tile_lo)
+{
+    s16 v = from + (s16)(((s32)delta * travelled) / (s32)span);
+    if (v < tile_lo)
+        v = tile_lo;
+    if (v > tile_lo + SGP_COLLISION_TILE_SIZE - 1)
+        v = tile_lo + SGP_COLLISION_TILE_SIZE - 1;
+    return v;
+}
+
+/**
+ * @brief Walks one ray over the tiles it crosses (shared by the single and batch entry points).
+ *
+ * Integer Amanatides-Woo traversal: the distances to the next column and row boundary are kept
+ * scaled by the other axis' extent, so each step is one compare and one add and every crossed
+ * tile is visited exactly once. On a corner the column is crossed first. Byte levels step the
+ * tile index by +-1 / +-row_length instead of recomputing it.
+ */
+static inline bool SGP_LevelRaycastWalk(const SGPLevelCollisionData *level, u16 row_len, u16 rows, bool bytes, const SGPRay *ray, SGPRayHit *hit)
+{
+    const s16 dx = ray->x1 - ray->x0;
+    const s16 dy = ray->y1 - ray->y0;
+    const u16 adx = (u16)(dx < 0 ? -dx : dx);
+    const u16 ady = (u16)(dy < 0 ? -dy : dy);
+    const s16 step_x = (dx > 0) ? 1 : -1;
+    const s16 step_y = (dy > 0) ? 1 : -1;
+    s16 tile_x = ray->x0 >> PIXELS_TO_TILE_SHIFT;
+    s16 tile_y = ray->y0 >> PIXELS_TO_TILE_SHIFT;
+    u16 steps_x = (u16)(((ray->x1 >> PIXELS_TO_TILE_SHIFT) - tile_x) * step_x); // Tiles left to cross per axis
+    u16 steps_y = (u16)(((ray->y1 >> PIXELS_TO_TILE_SHIFT) - tile_y) * step_y);
+
+    // Pixels to the first boundary on each axis, scaled so both compare in the same units
+    const u16 first_x = (dx > 0) ? (u16)(((tile_x + 1) << PIXELS_TO_TILE_SHIFT) - ray->x0) : (u16)(ray->x0 - (tile_x << PIXELS_TO_TILE_SHIFT));
+    const u16 first_y = (dy > 0) ? (u16)(((tile_y + 1) << PIXELS_TO_TILE_SHIFT) - ray->y0) : (u16)(ray->y0 - (tile_y << PIXELS_TO_TILE_SHIFT));
+    u32 next_x = (u32)first_x * ady;
+    u32 next_y = (u32)first_y * adx;
+    const u32 cell_x = (u32)ady << PIXELS_TO_TILE_SHIFT;
+    const u32 cell_y = (u32)adx << PIXELS_TO_TILE_SHIFT;
+    const s16 stride = bytes ? (s16)row_len * step_y : 0;
+    u16 index = 0;
+    bool indexed = false;
+    u16 side = 0;
+
+    while (true)
+    {
+        const bool inside = tile_x >= 0 && tile_y >= 0 && (u16)tile_x < row_len && (u16)tile_y < rows;
+        bool solid = !inside; // Leaving the level stops the ray
+        if (inside && bytes)
+        {
+            if (!indexed)
+            {
+                index = SGP_LevelTileIndex(level, (u16)tile_x, (u16)tile_y);
+                indexed = true;
+            }
+            solid = SGP_LevelByteIsSolid(level, level->collision_data[index]);
+        }
+        else if (inside)
+        {
+            solid = SGP_TileIsSolidXY(level, tile_x, tile_y, true, true);
+        }
+        if (solid)
+            break;
+
+        if (steps_x == 0 && steps_y == 0)
+        {
+            hit->hit = false;
+            hit->side = 0;
+            hit->tile_x = tile_x;
+            hit->tile_y = tile_y;
+            hit->x = ray->x1;
+            hit->y = ray->y1;
+            hit->distance = SGP_ApproxDistance(dx, dy);
+            return false;
+        }
+        if (steps_x && (steps_y == 0 || next_x <= next_y))
+        {
+            tile_x += step_x;
+            index += step_x;
+            next_x += cell_x;
+            steps_x--;
+            side = (step_x > 0) ? COLLIDE_RIGHT : COLLIDE_LEFT;
+        }
+        else
+        {
+            tile_y += step_y;
+            index += stride;
+            next_y += cell_y;
+            steps_y--;
+            side = (step_y > 0) ? COLLIDE_DOWN : COLLIDE_UP;
+        }
+    }
+
+    hit->hit = true;
+    hit->side = side;
+    hit->tile_x = tile_x;
+    hit->tile_y = tile_y;
+    if (side == 0)
+    {
+        hit->x = ray->x0; // Origin tile itself is solid
+        hit->y = ray->y0;
+    }
+    else if (side & (COLLIDE_LEFT | COLLIDE_RIGHT))
+    {
+        hit->x = (step_x > 0) ? (s16)(tile_x << PIXELS_TO_TILE_SHIFT) : (s16)(((tile_x + 1) << PIXELS_TO_TILE_SHIFT) - 1);
+        hit->y = SGP_RayCrossing(ray->y0, dy, (dx > 0) ? hit->x - ray->x0 : ray->x0 - hit->x, adx, (s16)(tile_y << PIXELS_TO_TILE_SHIFT));
+    }
+    else
+    {
+        hit->y = (step_y > 0) ? (s16)(tile_y << PIXELS_TO_TILE_SHIFT) : (s16)(((tile_y + 1) << PIXELS_TO_TILE_SHIFT) - 1);
+        hit->x = SGP_RayCrossing(ray->x0, dx, (dy > 0) ? hit->y - ray->y0 : ray->y0 - hit->y, ady, (s16)(tile_x << PIXELS_TO_TILE_SHIFT));
+    }
+    hit->distance = SGP_ApproxDistance(hit->x - ray->x0, hit->y - ray->y0);
+    return true;
+}
+
+// Byte levels can walk the tile index directly; other layouts go through SGP_TileIsSolidXY
+static inline bool SGP_LevelRaycastBytes(const SGPLevelCollisionData *level)
+{
+    return level->collision_data && !level->solid_bits && !SGP_LevelIsBlockBased(level);
+}
+
+/**
+ * @brief Casts a ray against the level's solid tiles.
+ *
+ * Visits each tile the segment crosses once (not every pixel) and stops at the first solid or
+ * OOB tile, so a 200px ray costs at most ~14 lookups with 16px tiles. On typed levels only
+ * SGP_TILE_SOLID blocks. A ray starting in a solid tile hits at distance 0 with side 0.
+ *
+ * @param level Level to test
+ * @param ray Segment in world pixels
+ * @param hit Result: hit tile, entry point, side and distance (or the end point when clear)
+ * @return true if a solid tile was hit before the end
+ */
+static inline bool SGP_LevelRaycast(const SGPLevelCollisionData *level, const SGPRay *ray, SGPRayHit *hit)
+{
+    return SGP_LevelRaycastWalk(level, SGP_LevelRowLength(level), SGP_LevelTotalRows(level), SGP_LevelRaycastBytes(level), ray, hit);
+}
+
+/**
+ * @brief Casts many rays against one level; the layout is resolved once for the whole batch.
+ * @return Number of rays that hit
+ */
+static inline u16 SGP_LevelRaycastBatch(const SGPLevelCollisionData *level, const SGPRay *rays, SGPRayHit *hits, u16 count)
+{
+    const u16 row_len = SGP_LevelRowLength(level);
+    const u16 rows = SGP_LevelTotalRows(level);
+    const bool bytes = SGP_LevelRaycastBytes(level);
+    u16 hit_count = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        if (SGP_LevelRaycastWalk(level, row_len, rows, bytes, &rays[i], &hits[i]))
+            hit_count++;
+    }
+    return hit_count;
+}
+
+/**
+ * @brief Tests whether the segment between two points crosses no solid tile.
+ */
+static inline bool SGP_LevelLineOfSight(const SGPLevelCollisionData *level, s16 x0, s16 y0, s16 x1, s16 y1)
+{
+    const SGPRay ray = { x0, y0, x1, y1 };
+    SGPRayHit hit;
+    return !SGP_LevelRaycast(level, &ray, &hit);
+}
+
+//----------------------------------------------------------------------------------
+// Tile Triggers (sorted sparse index)
+//----------------------------------------------------------------------------------
+// Row-major sort key of a trigger tile
+static inline u32 SGP_TriggerKey(u16 tile_x, u16 tile_y) { return ((u32)tile_y << 16) | tile_x; }
+
+/**
+ * @brief Sorts trigger entries into index order (build tools, or once at level load for RAM lists).
+ *
+ * Insertion sort: stable, no extra memory, and near-linear on lists that are already mostly in
+ * row order, which hand-placed level data usually is.
+ */
+static inline void SGP_TriggerSort(SGPTrigger *triggers, u16 count)
+{
+    for (u16 i = 1; i < count; i++)
+    {
+        const SGPTrigger entry = triggers[i];
+        const u32 key = SGP_TriggerKey(entry.tile_x, entry.tile_y);
+        u16 j = i;
+        while (j > 0 && SGP_TriggerKey(triggers[j - 1].tile_x, triggers[j - 1].tile_y) > key)
+        {
+            triggers[j] = triggers[j - 1];
+            j--;
+        }
+        triggers[j] = entry;
+    }
+}
+
+/**
+ * @brief Attaches sorted trigger entries to a layer.
+ * @param layer Layer to fill
+ * @param triggers Entries sorted by (tile_y, tile_x), see SGP_TriggerSort
+ * @param count Number of entries, below SGP_TRIGGER_NONE
+ * @return false if the entries are out of order (the layer is left empty)
+ */
+static inline bool SGP_TriggerLayerInit(SGPTriggerLayer *layer, const SGPTrigger *triggers, u16 count)
+{
+    layer->triggers = triggers;
+    layer->count = 0;
+    if (count == SGP_TRIGGER_NONE)
         return false;
+    for (u16 i = 1; i < count; i++)
+    {
+        if (SGP_TriggerKey(triggers[i].tile_x, triggers[i].tile_y) < SGP_TriggerKey(triggers[i - 1].tile_x, triggers[i - 1].tile_y))
+            return false;
     }
-    
-    sgp.camera.map = map;
-    sgp.camera.map_height = SGP_MetatilesToPixels(map->h);
-    sgp.camera.map_width = SGP_MetatilesToPixels(map->w);
-    sgp.camera.active = true;
+    layer->count = count;
     return true;
 }
+
+// First entry at or after (tile_x, tile_y) in index order, searching from `first`
+static inline u16 SGP_TriggerLowerBound(const SGPTriggerLayer *layer, u16 first, u16 tile_x, u16 tile_y)
+{
+    const u32 key = SGP_TriggerKey(tile_x, tile_y);
+    u16 lo = first, hi = layer->count;
+    while (lo < hi)
+    {
+        const u16 mid = lo + ((hi - lo) >> 1);
+        if (SGP_TriggerKey(layer->triggers[mid].tile_x, layer->triggers[mid].tile_y) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
 /**
- * @brief Clamps the given fixed-point position to the map bounds.
- * @param x Pointer to X position (fixed-point)
- * @param y Pointer to Y position (fixed-point)
- * @param width Width of the entity
- * @param height Height of the entity
+ * @brief Finds the first trigger entry on one tile.
+ * @return Entry index, SGP_TRIGGER_NONE if the tile has no trigger
  */
-static inline void SGP_ClampPositionToMapBounds(fix32 *x, fix32 *y, u16 width, u16 height)
+static inline u16 SGP_TriggerLayerFind(const SGPTriggerLayer *layer, u16 tile_x, u16 tile_y)
 {
-    s16 pos_x = F32_toInt(*x);
-    s16 pos_y = F32_toInt(*y);
-
-    // Clamp position to map bounds (entity always visible on map, accounting for sprite dimensions)
-    if (pos_x < 0)
-        *x = FIX32(0);
-    if (pos_x > sgp.camera.map_width - 1 - width)
-        *x = FIX32(sgp.camera.map_width - 1 - width);
-    if (pos_y < 0)
-        *y = FIX32(0);
-    if (pos_y > sgp.camera.map_height - height)
-        *y = FIX32(sgp.camera.map_height - height);
+    const u16 i = SGP_TriggerLowerBound(layer, 0, tile_x, tile_y);
+    if (i < layer->count && layer->triggers[i].tile_x == tile_x && layer->triggers[i].tile_y == tile_y)
+        return i;
+    return SGP_TRIGGER_NONE;
 }
 
 /**
- * @brief Follows a target position with the camera, clamping to map bounds.
- * @param target Pointer to CameraTarget struct
+ * @brief Collects the trigger entries on the tiles a box covers, in index order.
+ *
+ * One binary search per covered tile row (each starting where the previous row stopped), then a
+ * walk over that row's entries inside the box columns.
+ *
+ * @param layer Trigger layer
+ * @param box Query box in world pixels
+ * @param out_entries Output entry indices into layer->triggers
+ * @param max_out Capacity of out_entries
+ * @return Number of entries written
  */
-static inline void SGP_CameraFollowTarget(SGPCameraTarget *target)
+static inline u16 SGP_TriggerLayerQuery(const SGPTriggerLayer *layer, const SGPBox *box, u16 *out_entries, u16 max_out)
 {
-    if (!sgp.camera.active) // Check if camera is active and map is set
+    if (box->w == 0 || box->h == 0)
+        return 0;
+    const u16 tile_x0 = box->x >> PIXELS_TO_TILE_SHIFT;
+    const u16 tile_x1 = (u16)(box->x + box->w - 1) >> PIXELS_TO_TILE_SHIFT;
+    const u16 tile_y0 = box->y >> PIXELS_TO_TILE_SHIFT;
+    const u16 tile_y1 = (u16)(box->y + box->h - 1) >> PIXELS_TO_TILE_SHIFT;
+    u16 count = 0;
+    u16 i = 0;
+
+    for (u16 tile_y = tile_y0; tile_y <= tile_y1; tile_y++)
     {
-        return; // Camera not active, skip following
+        i = SGP_TriggerLowerBound(layer, i, tile_x0, tile_y);
+        if (i == layer->count)
+            break;
+        while (i < layer->count && layer->triggers[i].tile_y == tile_y && layer->triggers[i].tile_x <= tile_x1)
+        {
+            if (count == max_out)
+                return count;
+            out_entries[count++] = i++;
+        }
     }
+    return count;
+}
 
-    // Use target position directly as camera position, clamp to map bounds
-    s16 new_camera_x = target->sprite_world_x - target->offset_x;
-    s16 new_camera_y = target->sprite_world_y - target->offset_y;
+//----------------------------------------------------------------------------------
+// Flow Fields (time-sliced BFS)
+//----------------------------------------------------------------------------------
+/**
+ * @brief Resets a flow field to empty (no target, nothing ready).
+ */
+static inline void SGP_FlowFieldInit(SGPFlowField *field, const SGPLevelCollisionData *level)
+{
+    field->level = level;
+    field->target_x = field->target_y = -1;
+    field->pending = false;
+    field->building = false;
+    field->ready = false;
+    field->front = 0;
+    field->head = field->tail = 0;
+}
 
-    if (new_camera_x < 0)
-        new_camera_x = 0;
-    if (new_camera_x > sgp.camera.map_width - screenWidth)
-        new_camera_x = sgp.camera.map_width - screenWidth;
-    if (new_camera_y < 0)
-        new_camera_y = 0;
-    if (new_camera_y > sgp.camera.map_height - screenHeight)
-        new_camera_y = sgp.camera.map_height - screenHeight;
+// Window start on one axis: the target centered, clamped to the level
+static inline s16 SGP_FlowFieldOrigin(s16 target, u16 window, u16 level_tiles)
+{
+    s16 origin = target - (s16)(window >> 1);
+    if (origin > (s16)level_tiles - (s16)window)
+        origin = (s16)level_tiles - (s16)window;
+    if (origin < 0)
+        origin = 0;
+    return origin;
+}
+
+// Clears the back buffer and seeds a build from the target tile
+static inline void SGP_FlowFieldStart(SGPFlowField *field, s16 tile_x, s16 tile_y)
+{
+    const u8 back = field->front ^ 1;
+    u8 *steps = field->steps[back];
+    for (u16 i = 0; i < SGP_FLOW_NODES; i++)
+        steps[i] = 0;
+
+    const s16 ox = SGP_FlowFieldOrigin(tile_x, SGP_FLOW_W, SGP_LevelRowLength(field->level));
+    const s16 oy = SGP_FlowFieldOrigin(tile_y, SGP_FLOW_H, SGP_LevelTotalRows(field->level));
+    const u16 seed = ((u16)(tile_y - oy) << SGP_FLOW_SHIFT_X) + (u16)(tile_x - ox);
+    field->origin_x[back] = ox;
+    field->origin_y[back] = oy;
+    field->target_x = tile_x;
+    field->target_y = tile_y;
+    steps[seed] = SGP_FLOW_REACHED;
+    field->queue[0] = seed;
+    field->head = 0;
+    field->tail = 1;
+    field->building = true;
+}
+
+/**
+ * @brief Points the field at a new target tile (e.g. the player's), starting or queueing a rebuild.
+ *
+ * Does nothing while the target stays on the same tile. While a build is running the new tile is
+ * queued and rebuilt as soon as that build publishes.
+ *
+ * @return false if the tile is outside the level (the request is ignored)
+ */
+static inline bool SGP_FlowFieldSetTarget(SGPFlowField *field, s16 tile_x, s16 tile_y)
+{
+    if ((u16)tile_x >= SGP_LevelRowLength(field->level) || (u16)tile_y >= SGP_LevelTotalRows(field->level))
+        return false;
+    if (field->building)
+    {
+        field->pending = (tile_x != field->target_x || tile_y != field->target_y);
+        field->pending_x = tile_x;
+        field->pending_y = tile_y;
+        return true;
+    }
+    if (!field->ready || tile_x != field->target_x || tile_y != field->target_y)
+        SGP_FlowFieldStart(field, tile_x, tile_y);
+    return true;
+}
+
+// Queues one neighbour of a BFS node if it is inside the window, new and passable
+static inline void SGP_FlowFieldVisit(SGPFlowField *field, u8 *steps, u16 node, s16 tile_x, s16 tile_y, u8 step)
+{
+    if (steps[node] != 0 || SGP_TileIsSolidXY(field->level, tile_x, tile_y, true, true))
+        return;
+    steps[node] = SGP_FLOW_REACHED | step;
+    field->queue[field->tail++] = node;
+}
 
-    if ((sgp.camera.current_x != (u32)new_camera_x) ||
-        (sgp.camera.current_y != (u32)new_camera_y))
+/**
+ * @brief Expands up to max_nodes BFS nodes of the running build; publishes it when done.
+ *
+ * Each node costs at most four tile checks. Call once per frame with a budget that fits the
+ * frame; after publishing, a queued target starts at once and shares the remaining budget.
+ *
+ * @param field Flow field
+ * @param max_nodes Nodes to expand in this call (0 = until the build finishes)
+ * @return Number of nodes expanded
+ */
+static inline u16 SGP_FlowFieldUpdate(SGPFlowField *field, u16 max_nodes)
+{
+    u16 expanded = 0;
+    while (field->building && (max_nodes == 0 || expanded < max_nodes))
     {
-        sgp.camera.current_x = (u32)new_camera_x;
-        sgp.camera.current_y = (u32)new_camera_y;
+        const u8 back = field->front ^ 1;
+        u8 *steps = field->steps[back];
+        const u16 node = field->queue[field->head++];
+        const u16 lx = node & (SGP_FLOW_W - 1);
+        const u16 ly = node >> SGP_FLOW_SHIFT_X;
+        const s16 tile_x = field->origin_x[back] + (s16)lx;
+        const s16 tile_y = field->origin_y[back] + (s16)ly;
 
-        static s16 bg_hscroll = 0, bg_vscroll = 0;
-        bg_hscroll = (0 - new_camera_x) >> 3; // Convert to tile units (8 pixels)
-        bg_vscroll = new_camera_y >> 3;       // Convert to tile units (8
+        // Each neighbour steps back toward this node
+        if (ly > 0)
+            SGP_FlowFieldVisit(field, steps, node - SGP_FLOW_W, tile_x, tile_y - 1, SGP_DIR_DOWN);
+        if (ly < SGP_FLOW_H - 1)
+            SGP_FlowFieldVisit(field, steps, node + SGP_FLOW_W, tile_x, tile_y + 1, SGP_DIR_UP);
+        if (lx > 0)
+            SGP_FlowFieldVisit(field, steps, node - 1, tile_x - 1, tile_y, SGP_DIR_RIGHT);
+        if (lx < SGP_FLOW_W - 1)
+            SGP_FlowFieldVisit(field, steps, node + 1, tile_x + 1, tile_y, SGP_DIR_LEFT);
+        expanded++;
 
-        if (bg_vscroll > 32) // assuming
+        if (field->head == field->tail)
         {
-            bg_vscroll = 32;
+            field->front = back;
+            field->ready = true;
+            field->building = false;
+            if (field->pending)
+            {
+                field->pending = false;
+                SGP_FlowFieldStart(field, field->pending_x, field->pending_y);
+            }
         }
-
-        MAP_scrollTo(sgp.camera.map, new_camera_x, new_camera_y);
-        VDP_setHorizontalScroll(BG_B, bg_hscroll);
-        VDP_setVerticalScroll(BG_B, bg_vscroll);
     }
-    if (target->sprite)
+    return expanded;
+}
+
+/**
+ * @brief Next step from a tile toward the target of the last finished field.
+ * @return SGP_DIR_* to move, 0 at the target, off the window, unreachable or before the first build
+ */
+static inline u8 SGP_FlowFieldStep(const SGPFlowField *field, s16 tile_x, s16 tile_y)
+{
+    const u16 lx = (u16)(tile_x - field->origin_x[field->front]);
+    const u16 ly = (u16)(tile_y - field->origin_y[field->front]);
+    if (!field->ready || lx >= SGP_FLOW_W || ly >= SGP_FLOW_H)
+        return 0;
+    return (u8)(field->steps[field->front][(ly << SGP_FLOW_SHIFT_X) + lx] & ~SGP_FLOW_REACHED);
+}
+
+//----------------------------------------------------------------------------------
+// Entity Pool
+//----------------------------------------------------------------------------------
+/**
+ * @brief Empties the pool and links every slot into the free-list.
+ */
+static inline void SGP_EntityPoolInit(SGPEntityPool *pool)
+{
+    for (u16 i = 0; i < SGP_ENTITY_POOL_CAPACITY; i++)
     {
-        SPR_setPosition(target->sprite,
-                        target->sprite_world_x - new_camera_x,
-                        target->sprite_world_y - new_camera_y);
+        pool->next_free[i] = (u8)(i + 1);
+        pool->live_slot[i] = SGP_ENTITY_NONE;
     }
+    pool->next_free[SGP_ENTITY_POOL_CAPACITY - 1] = SGP_ENTITY_NONE;
+    pool->free_head = 0;
+    pool->live_count = 0;
 }
 
 /**
- * @brief Activates the camera, allowing it to follow a target.
+ * @brief Takes a slot from the free-list and places a new entity.
+ * @param pool Entity pool
+ * @param x Collision box left (fixed-point world pixels)
+ * @param y Collision box top (fixed-point world pixels)
+ * @param width Collision box width
+ * @param height Collision box height
+ * @return Entity handle, or SGP_ENTITY_NONE if the pool is full
  */
-static inline void SGP_activateCamera(void)
+static inline u8 SGP_EntitySpawn(SGPEntityPool *pool, fix32 x, fix32 y, u16 width, u16 height)
 {
-    sgp.camera.active = true;
+    const u8 e = pool->free_head;
+    if (e == SGP_ENTITY_NONE)
+        return SGP_ENTITY_NONE;
+    pool->free_head = pool->next_free[e];
+
+    pool->x[e] = x;
+    pool->y[e] = y;
+    pool->vel_x[e] = FIX32(0);
+    pool->vel_y[e] = FIX32(0);
+    pool->box[e].x = (u16)F32_toInt(x);
+    pool->box[e].y = (u16)F32_toInt(y);
+    pool->box[e].w = width;
+    pool->box[e].h = height;
+    pool->flags[e] = 0;
+    pool->contact[e] = 0;
+    pool->sprite[e] = NULL;
+    pool->sprite_dx[e] = 0;
+    pool->sprite_dy[e] = 0;
+    pool->sprite_state[e] = 0;
+    SGP_CollisionContextInit(&pool->collision[e], NULL, width, height);
+
+    pool->live_slot[e] = pool->live_count;
+    pool->live[pool->live_count++] = e;
+    return e;
 }
+
 /**
- * @brief Deactivates the camera, stopping it from following a target.
+ * @brief Returns true if the handle refers to a live entity.
  */
-static inline void SGP_deactivateCamera(void)
+static inline bool SGP_EntityIsLive(const SGPEntityPool *pool, u8 e)
 {
-    sgp.camera.active = false;
+    return e < SGP_ENTITY_POOL_CAPACITY && pool->live_slot[e] < pool->live_count && pool->live[pool->live_slot[e]] == e;
 }
+
 /**
- * @brief Checks if the camera is currently active.
- * @return True if the camera is active, false otherwise.
+ * @brief Returns an entity's slot to the free-list.
+ *
+ * The last live handle is moved into the freed position of live[], so when freeing while
+ * iterating, iterate live[] from the end. Freeing a handle that is not live is a no-op.
  */
-static inline bool SGP_isCameraActive(void)
+static inline void SGP_EntityFree(SGPEntityPool *pool, u8 e)
 {
-    return sgp.camera.active;
+    if (!SGP_EntityIsLive(pool, e))
+        return;
+    const u8 slot = pool->live_slot[e];
+    const u8 last = pool->live[--pool->live_count];
+    pool->live[slot] = last;
+    pool->live_slot[last] = slot;
+
+    pool->live_slot[e] = SGP_ENTITY_NONE;
+    pool->next_free[e] = pool->free_head;
+    pool->free_head = e;
 }
+
 /**
- * @brief Updates the camera position directly without following a target.
- * @param x New X position
- * @param y New Y position
+ * @brief Live entity iterator: call with *cursor = 0, returns false after the last entity.
  */
-static inline void SGP_UpdateCameraPosition(u32 x, u32 y)
+static inline bool SGP_EntityPoolNext(const SGPEntityPool *pool, u16 *cursor, u8 *e)
 {
-    if (sgp.camera.active)
+    if (*cursor >= pool->live_count)
+        return false;
+    *e = pool->live[(*cursor)++];
+    return true;
+}
+
+/**
+ * @brief Refreshes the integer collision boxes from the fixed-point positions.
+ */
+static inline void SGP_EntityPoolSyncBoxes(SGPEntityPool *pool)
+{
+    for (u16 i = 0; i < pool->live_count; i++)
     {
-        return; // if active, camera tracks target
+        const u8 e = pool->live[i];
+        pool->box[e].x = (u16)F32_toInt(pool->x[e]);
+        pool->box[e].y = (u16)F32_toInt(pool->y[e]);
     }
-    sgp.camera.current_x = x;
-    sgp.camera.current_y = y;
-    MAP_scrollTo(sgp.camera.map, x, y);
 }
+
 /**
- * @brief Sets the horizontal scroll limit for the camera.
- * @param limit New vertical scroll limit in tiles
+ * @brief Integrates every live entity's velocity with SGP_MoveAndCollide.
+ *
+ * Stores the COLLIDE_* contact mask per entity and syncs the boxes. A NULL level moves
+ * entities without collision.
  */
-static inline void SGP_CameraSetVerticalScrollLimit(u16 limit)
+static inline void SGP_EntityPoolMove(SGPEntityPool *pool, const SGPLevelCollisionData *level)
 {
-    sgp.camera.max_vertical_scroll = limit;
+    for (u16 i = 0; i < pool->live_count; i++)
+    {
+        const u8 e = pool->live[i];
+        if (level)
+        {
+            pool->contact[e] = SGP_MoveAndCollide(level, &pool->x[e], &pool->y[e], pool->vel_x[e], pool->vel_y[e], pool->box[e].w, pool->box[e].h);
+        }
+        else
+        {
+            pool->x[e] += pool->vel_x[e];
+            pool->y[e] += pool->vel_y[e];
+            pool->contact[e] = 0;
+        }
+        pool->box[e].x = (u16)F32_toInt(pool->x[e]);
+        pool->box[e].y = (u16)F32_toInt(pool->y[e]);
+    }
 }
 
 /**
- * @brief Gets the vertical scroll limit for the camera.
- * @return Current vertical scroll limit in tiles
+ * @brief Resolves one direction of post-move level collision for every live entity.
+ *
+ * Uses each entity's SGPCollisionContext, so unchanged positions hit the cache. Results are
+ * left in pool->collision[e].flags.
+ *
+ * @return Number of entities colliding in that direction
  */
-static inline u16 SGP_CameraGetVerticalScrollLimit(void)
+static inline u16 SGP_EntityPoolLevelCollision(SGPEntityPool *pool, const SGPLevelCollisionData *level, SGPMovementDirection direction)
 {
-    return sgp.camera.max_vertical_scroll;
+    u16 hits = 0;
+    for (u16 i = 0; i < pool->live_count; i++)
+    {
+        const u8 e = pool->live[i];
+        SGPCollisionContext *ctx = &pool->collision[e];
+        if (ctx->level != level || ctx->width != pool->box[e].w || ctx->height != pool->box[e].h)
+            SGP_CollisionContextInit(ctx, level, pool->box[e].w, pool->box[e].h);
+        ctx->x = F32_toInt(pool->x[e]);
+        ctx->y = F32_toInt(pool->y[e]);
+        if (SGP_ContextLevelCollision(ctx, direction))
+            hits++;
+    }
+    return hits;
 }
 
 /**
- * @brief Shakes the camera for a specified duration and intensity.
- * @param duration Duration of the shake in frames
- * @param intensity intensity of the shake (in pixels)
+ * @brief Attaches a sprite to an entity, drawn at the collision box plus (dx, dy).
  *
- * This is just for fun not a serious feature.
+ * The sprite stays owned by the caller (release it before SGP_EntityFree). The next
+ * SGP_EntityPoolUpdateSprites pass sets its visibility and position.
  */
-static inline void SGP_ShakeCamera(u16 duration, s16 intensity)
+static inline void SGP_EntitySetSprite(SGPEntityPool *pool, u8 e, Sprite *sprite, s16 dx, s16 dy)
 {
-    SGP_deactivateCamera(); // Disable camera tracking during shake
-    for (u16 i = 0; i < duration; i++)
+    pool->sprite[e] = sprite;
+    pool->sprite_dx[e] = dx;
+    pool->sprite_dy[e] = dy;
+    pool->sprite_state[e] = 0;
+}
+
+/**
+ * @brief Camera-relative sprite pass over every live entity with a sprite.
+ *
+ * Boxes outside the committed camera view (SGPCamera.view_x/view_y) grown by margin pixels are
+ * hidden once and then skipped, so they cost no sprite engine time. Visible sprites only get
+ * SPR_setPosition when their screen position changed. Call once per frame after
+ * SGP_CameraFollowTarget and SGP_EntityPoolMove (or SGP_EntityPoolSyncBoxes).
+ *
+ * @param pool Entity pool
+ * @param margin Extra pixels kept visible around the screen (sprites larger than their box)
+ * @return Number of visible entity sprites
+ */
+static inline u16 SGP_EntityPoolUpdateSprites(SGPEntityPool *pool, u16 margin)
+{
+    const s16 view_left = sgp.camera.view_x - (s16)margin;
+    const s16 view_top = sgp.camera.view_y - (s16)margin;
+    const s16 view_right = sgp.camera.view_x + (s16)screenWidth + (s16)margin;
+    const s16 view_bottom = sgp.camera.view_y + (s16)screenHeight + (s16)margin;
+    u16 visible = 0;
+
+    for (u16 i = 0; i < pool->live_count; i++)
     {
-        s16 shake_x = (i % 2 == 0) ? intensity : -intensity;
-        sgp.camera.current_x += shake_x;
-        SGP_UpdateCameraPosition(sgp.camera.current_x, sgp.camera.current_y);
-        SYS_doVBlankProcess();           // Wait for VBlank to apply shake
-        sgp.camera.current_x -= shake_x; // Restore position for next frame
+        const u8 e = pool->live[i];
+        Sprite *sprite = pool->sprite[e];
+        if (!sprite)
+            continue;
+
+        const SGPBox *box = &pool->box[e];
+        const s16 left = (s16)box->x;
+        const s16 top = (s16)box->y;
+        if (left + (s16)box->w <= view_left || left >= view_right ||
+            top + (s16)box->h <= view_top || top >= view_bottom)
+        {
+            if (FLAG_IS_INACTIVE(pool->sprite_state[e], SGP_SPRITE_HIDDEN))
+            {
+                SPR_setVisibility(sprite, HIDDEN);
+                pool->sprite_state[e] = SGP_SPRITE_HIDDEN;
+            }
+            continue;
+        }
+
+        const s16 screen_x = left + pool->sprite_dx[e] - sgp.camera.view_x;
+        const s16 screen_y = top + pool->sprite_dy[e] - sgp.camera.view_y;
+        if (FLAG_IS_INACTIVE(pool->sprite_state[e], SGP_SPRITE_SHOWN))
+        {
+            SPR_setVisibility(sprite, VISIBLE);
+            SPR_setPosition(sprite, screen_x, screen_y);
+            pool->sprite_state[e] = SGP_SPRITE_SHOWN;
+        }
+        else if (screen_x != pool->screen_x[e] || screen_y != pool->screen_y[e])
+        {
+            SPR_setPosition(sprite, screen_x, screen_y);
+        }
+        pool->screen_x[e] = screen_x;
+        pool->screen_y[e] = screen_y;
+        visible++;
     }
-    SGP_activateCamera(); // Re-enable camera tracking after shake
+    return visible;
 }
+
+/**
+ * @brief Inserts every live entity's box into a broadphase grid, with the handle as id.
+ * @return false if the grid ran out of entries
+ */
+static inline bool SGP_EntityPoolBroadphaseInsert(const SGPEntityPool *pool, SGPBroadphase *bp)
+{
+    bool ok = true;
+    for (u16 i = 0; i < pool->live_count; i++)
+    {
+        const u8 e = pool->live[i];
+        if (!SGP_BroadphaseInsert(bp, &pool->box[e], e))
+            ok = false;
+    }
+    return ok;
+}
+
 //----------------------------------------------------------------------------------
-// Collision Functions
+// Job Scheduler (scanline budget)
 //----------------------------------------------------------------------------------
-static inline bool SGP_CheckBoxCollision(const SGPBox *a, const SGPBox *b)
+/**
+ * @brief Empties the scheduler and sets the stop line to SGP_SCHEDULER_STOP_LINE.
+ */
+static inline void SGP_SchedulerInit(SGPScheduler *sched)
 {
-    return (a->x < b->x + b->w &&
-            a->x + a->w > b->x &&
-            a->y < b->y + b->h &&
-            a->y + a->h > b->y);
+    for (u16 i = 0; i < SGP_SCHEDULER_MAX_JOBS; i++)
+    {
+        sched->jobs[i].step = NULL;
+        sched->jobs[i].data = NULL;
+        sched->jobs[i].priority = 0;
+        sched->jobs[i].yielded = false;
+    }
+    sched->stop_line = SGP_SCHEDULER_STOP_LINE;
+    sched->steps = 0;
 }
 
-// Helpers for tile collision queries
-static inline u16 SGP_LevelTotalRows(const SGPLevelCollisionData *level)
+/**
+ * @brief Registers a job.
+ * @param sched Scheduler
+ * @param step Step function, called until it returns SGP_JOB_DONE
+ * @param data Passed to every step
+ * @param priority Lower runs first
+ * @return Job handle, SGP_JOB_NONE if every slot is taken
+ */
+static inline u8 SGP_SchedulerAdd(SGPScheduler *sched, SGPJobStep step, void *data, u8 priority)
 {
-    return (level->row_length == 0) ? 0 : (level->data_length / level->row_length);
+    for (u8 i = 0; i < SGP_SCHEDULER_MAX_JOBS; i++)
+    {
+        SGPJob *job = &sched->jobs[i];
+        if (job->step)
+            continue;
+        job->step = step;
+        job->data = data;
+        job->priority = priority;
+        job->yielded = false;
+        return i;
+    }
+    return SGP_JOB_NONE;
 }
 
-// Axis-aware solidity check: control OOB behavior per axis
-static inline bool SGP_TileIsSolidXY(const SGPLevelCollisionData *level, s16 tile_x, s16 tile_y, bool oob_x_is_solid, bool oob_y_is_solid)
+/**
+ * @brief Unregisters a job; safe from inside any step.
+ */
+static inline void SGP_SchedulerRemove(SGPScheduler *sched, u8 job)
 {
-    const u16 row_len = level->row_length;
-    const u16 total_rows = SGP_LevelTotalRows(level);
-    if (tile_x < 0 || (u16)tile_x >= row_len)
-        return oob_x_is_solid;
-    if (tile_y < 0 || (u16)tile_y >= total_rows)
-        return oob_y_is_solid;
+    if (job < SGP_SCHEDULER_MAX_JOBS)
+        sched->jobs[job].step = NULL;
+}
 
-    u32 idx = (u32)(u16)tile_y * (u32)row_len + (u32)(u16)tile_x;
-    if (idx >= level->data_length)
-        return oob_x_is_solid || oob_y_is_solid; // Safety
-    return level->collision_data[idx] == SOLID_TILE;
+/**
+ * @brief Sets the adjusted V-counter line where runs stop (e.g. lower it when sprites take longer).
+ */
+static inline void SGP_SchedulerSetStopLine(SGPScheduler *sched, u16 line)
+{
+    sched->stop_line = line;
 }
 
-static inline bool SGP_TileIsSolid(const SGPLevelCollisionData *level, s16 tile_x, s16 tile_y, bool oob_is_solid)
+// Position of a V-counter line in a main-loop frame, which starts when SYS_doVBlankProcess returns:
+// VBlank lines sort before the active display
+static inline u16 SGP_SchedulerFramePos(u16 line)
 {
-    return SGP_TileIsSolidXY(level, tile_x, tile_y, oob_is_solid, oob_is_solid);
+    return (line >= screenHeight) ? (u16)(line - screenHeight) : (u16)(line + 0x100);
 }
 
 /**
- * Checks for player collision against tiles using post-move collision.
- * Call this AFTER adjusting position for the intended direction; if true, undo that axis move.
+ * @brief Steps jobs until the V-counter reaches the stop line or every job has yielded.
+ *
+ * Call once per frame late in the main loop, after the frame's fixed work. The V-counter is
+ * read before every step, so a step should stay well under the margin below the stop line.
+ * Nothing runs if the frame is already past the stop line.
+ *
+ * @return Number of steps taken
  */
-static inline bool SGP_PlayerLevelCollision(
-    u16 player_index, s16 player_coll_x, s16 player_coll_y, u16 player_coll_width, u16 player_coll_height,
-    const SGPLevelCollisionData *level, SGPMovementDirection direction)
+static inline u16 SGP_SchedulerRun(SGPScheduler *sched)
 {
-    // Per-player collision flags for early return when collision already detected and position unchanged
-    static u16 prev_collide_flags[SGP_MAX_PLAYER_COUNT] = {0};
-    static s16 prev_x[SGP_MAX_PLAYER_COUNT] = {0};
-    static s16 prev_y[SGP_MAX_PLAYER_COUNT] = {0};
-
-    // Tile bounds of the player's rectangle (allow per-entity collision box insets)
-    const s16 col_left_px = (s16)(player_coll_x);
-    const s16 col_right_px = (s16)(player_coll_x + (s16)player_coll_width - 1);
-    const s16 col_top_px = (s16)(player_coll_y);
-    const s16 col_bottom_px = (s16)(player_coll_y + (s16)player_coll_height - 1);
-
-    const s16 tile_left = col_left_px >> PIXELS_TO_TILE_SHIFT;
-    const s16 tile_right = col_right_px >> PIXELS_TO_TILE_SHIFT;
-    const s16 tile_top = col_top_px >> PIXELS_TO_TILE_SHIFT;
-    const s16 tile_bottom = col_bottom_px >> PIXELS_TO_TILE_SHIFT;
+    const u16 stop = SGP_SchedulerFramePos(sched->stop_line);
+    u16 steps = 0;
+    for (u16 i = 0; i < SGP_SCHEDULER_MAX_JOBS; i++)
+        sched->jobs[i].yielded = false;
 
-    if (direction & SGP_DIR_LEFT)
-    {
-        // Only check if position changed or not already flagged
-        if (prev_x[player_index] == player_coll_x && prev_y[player_index] == player_coll_y && FLAG_IS_ACTIVE(prev_collide_flags[player_index], COLLIDE_LEFT))
-            return true;
-        bool isColliding = SGP_TileIsSolidXY(level, tile_left, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE) ||
-                           SGP_TileIsSolidXY(level, tile_left, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE);
-        prev_x[player_index] = player_coll_x;
-        prev_y[player_index] = player_coll_y;
-        if (isColliding)
-            SET_ACTIVE(prev_collide_flags[player_index], COLLIDE_LEFT);
-        else
-            SET_INACTIVE(prev_collide_flags[player_index], COLLIDE_LEFT);
-        return isColliding;
-    }
-    else if (direction & SGP_DIR_RIGHT)
+    while (SGP_SchedulerFramePos(VDP_getAdjustedVCounter()) < stop)
     {
-        if (prev_x[player_index] == player_coll_x && prev_y[player_index] == player_coll_y && FLAG_IS_ACTIVE(prev_collide_flags[player_index], COLLIDE_RIGHT))
-            return true;
-        bool isColliding = SGP_TileIsSolidXY(level, tile_right, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE) ||
-                           SGP_TileIsSolidXY(level, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_PASSABLE);
-        prev_x[player_index] = player_coll_x;
-        prev_y[player_index] = player_coll_y;
-        if (isColliding)
-            SET_ACTIVE(prev_collide_flags[player_index], COLLIDE_RIGHT);
-        else
-            SET_INACTIVE(prev_collide_flags[player_index], COLLIDE_RIGHT);
-        return isColliding;
-    }
+        // Most urgent job that has not yielded, first slot on ties
+        u8 best = SGP_JOB_NONE;
+        for (u8 i = 0; i < SGP_SCHEDULER_MAX_JOBS; i++)
+        {
+            const SGPJob *job = &sched->jobs[i];
+            if (job->step && !job->yielded && (best == SGP_JOB_NONE || job->priority < sched->jobs[best].priority))
+                best = i;
+        }
+        if (best == SGP_JOB_NONE)
+            break;
 
-    if (direction & SGP_DIR_UP)
-    {
-        if (prev_x[player_index] == player_coll_x && prev_y[player_index] == player_coll_y && FLAG_IS_ACTIVE(prev_collide_flags[player_index], COLLIDE_UP))
-            return true;
-        bool isColliding = SGP_TileIsSolidXY(level, tile_left, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID) ||
-                           SGP_TileIsSolidXY(level, tile_right, tile_top, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID);
-        prev_x[player_index] = player_coll_x;
-        prev_y[player_index] = player_coll_y;
-        if (isColliding)
-            SET_ACTIVE(prev_collide_flags[player_index], COLLIDE_UP);
-        else
-            SET_INACTIVE(prev_collide_flags[player_index], COLLIDE_UP);
-        return isColliding;
-    }
-    else if (direction & SGP_DIR_DOWN)
-    {
-        if (prev_x[player_index] == player_coll_x && prev_y[player_index] == player_coll_y && FLAG_IS_ACTIVE(prev_collide_flags[player_index], COLLIDE_DOWN))
-            return true;
-        bool isColliding = SGP_TileIsSolidXY(level, tile_left, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID) ||
-                           SGP_TileIsSolidXY(level, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID, SGP_OOB_HORIZONTAL_SOLID);
-        prev_x[player_index] = player_coll_x;
-        prev_y[player_index] = player_coll_y;
-        if (isColliding)
-            SET_ACTIVE(prev_collide_flags[player_index], COLLIDE_DOWN);
-        else
-            SET_INACTIVE(prev_collide_flags[player_index], COLLIDE_DOWN);
-        return isColliding;
+        SGPJob *job = &sched->jobs[best];
+        const u8 result = job->step(job->data);
+        steps++;
+        if (result == SGP_JOB_DONE)
+            job->step = NULL;
+        else if (result == SGP_JOB_YIELD)
+            job->yielded = true;
     }
-    // Fallback: general rectangle-solid overlap (treat OOB as solid)
-    return SGP_TileIsSolid(level, tile_left, tile_top, SGP_OOB_HORIZONTAL_SOLID) ||
-           SGP_TileIsSolid(level, tile_right, tile_top, SGP_OOB_HORIZONTAL_SOLID) ||
-           SGP_TileIsSolid(level, tile_left, tile_bottom, SGP_OOB_HORIZONTAL_SOLID) ||
-           SGP_TileIsSolid(level, tile_right, tile_bottom, SGP_OOB_HORIZONTAL_SOLID);
+    sched->steps = steps;
+    return steps;
+}
+
+/**
+ * @brief Ready-made job step for an SGPFlowField: SGP_FLOW_JOB_NODES nodes per step, yields when idle.
+ *
+ * Register with the field as data; keep calling SGP_FlowFieldSetTarget from the main loop.
+ */
+static inline u8 SGP_FlowFieldJobStep(void *data)
+{
+    SGPFlowField *field = (SGPFlowField *)data;
+    SGP_FlowFieldUpdate(field, SGP_FLOW_JOB_NODES);
+    return field->building ? SGP_JOB_CONTINUE : SGP_JOB_YIELD;
 }
 
-#endif // SGP_H
\ No newline at end of file
+#endif // SGP_H
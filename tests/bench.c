@@ -0,0 +1,167 @@
+/*
+ * bench.c - Host-side micro-benchmarks for SGP hot paths
+ *
+ * Times the shared bench_kernels.h kernels (measured in 68000 cycles by the ROM
+ * in m68k_bench/) and camera pans on top of the sgp_test.h mocks, and counts the
+ * mock MAP/VDP/sprite calls they issue. Host ns/op only shows algorithmic
+ * regressions; the call counts show VDP traffic regressions.
+ *
+ * Build and run with: make bench
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "sgp_test.h"
+#include "bench_kernels.h"
+
+// Mock call counters
+static unsigned long map_calls = 0, hscroll_calls = 0, vscroll_calls = 0, sprite_calls = 0, dma_calls = 0;
+
+// Mock SGDK function implementations
+u16 JOY_readJoypad(u16 joy) { (void)joy; return 0; }
+void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; map_calls++; }
+void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
+void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
+void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; hscroll_calls++; }
+void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; vscroll_calls++; }
+void SPR_setPosition(Sprite* sprite, s16 x, s16 y) { (void)sprite; (void)x; (void)y; sprite_calls++; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { (void)sprite; (void)visibility; sprite_calls++; }
+void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
+void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) {
+    (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; }
+u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) {
+    (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { (void)offset; return 0; }
+void SRAM_writeWord(u32 offset, u16 val) { (void)offset; (void)val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; dma_calls++; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; dma_calls++; }
+
+// Required global SGP state
+SGP sgp;
+
+// Keeps results observable so the kernels are not optimized away
+static volatile unsigned long bench_sink = 0;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void reset_counters(void) {
+    map_calls = hscroll_calls = vscroll_calls = sprite_calls = dma_calls = 0;
+}
+
+static void report(const char* name, double elapsed_ns, unsigned long ops, unsigned long frames) {
+    printf("%-44s %9.2f ns/op", name, elapsed_ns / (double)ops);
+    if (frames) {
+        printf("   MAP %.2f  HSCR %.2f  VSCR %.2f  SPR %.2f  DMA %.2f /frame",
+               (double)map_calls / frames, (double)hscroll_calls / frames,
+               (double)vscroll_calls / frames, (double)sprite_calls / frames, (double)dma_calls / frames);
+    }
+    printf("\n");
+}
+
+//=============================================================================
+// Shared kernels (same code and data as the m68k cycle benchmark ROM)
+//=============================================================================
+
+#define KERNEL_HOST_BATCHES 4000UL
+
+static void bench_shared_kernels(void) {
+    printf("\n--- Shared kernels (%dx%d level, %d entities, %d boxes) ---\n",
+           BENCH_LEVEL_W, BENCH_LEVEL_H, BENCH_ENTITY_COUNT, BENCH_BOX_COUNT);
+    bench_setup();
+
+    // Each kernel runs in its m68k batch size so per-call numbers compare across builds
+    for (unsigned k = 0; k < BENCH_KERNEL_COUNT; k++) {
+        const BenchKernel* kernel = &bench_kernels[k];
+        const unsigned long batches = KERNEL_HOST_BATCHES;
+        double start = now_ns();
+        for (unsigned long b = 0; b < batches; b++) {
+            bench_sink += kernel->run(kernel->batch);
+        }
+        double elapsed = now_ns() - start;
+        start = now_ns();
+        for (unsigned long b = 0; b < batches; b++) {  // Loop overhead, as the ROM subtracts it
+            bench_sink += bench_empty(kernel->batch);
+        }
+        elapsed -= now_ns() - start;
+        report(kernel->name, elapsed > 0 ? elapsed : 0, batches * kernel->batch, 0);
+    }
+}
+
+//=============================================================================
+// Camera pans
+//=============================================================================
+
+#define PAN_FRAMES 20000
+
+static void bench_camera_pan(const char* name, u8 type, SGPParallax* parallax, bool queued) {
+    static Sprite sprite;
+    Map map = {0};
+    map.w = 64;  // 8192 px
+    map.h = 8;   // 1024 px
+    SGP_init();
+    SGP_CameraInit(&map);
+    if (type != CAMERA_LOCKED) {
+        SGP_CameraSetType(type);
+        SGP_CameraSetDeadzone(24, 16);
+    }
+    if (parallax) SGP_CameraAddParallax(parallax);
+    if (queued) SGP_VdpQueueInit();
+
+    SGPCameraTarget target = { &sprite, 160, 112, 160, 400 };
+    reset_counters();
+    double start = now_ns();
+    for (int frame = 0; frame < PAN_FRAMES; frame++) {
+        // Walk right for a while, stand, then jitter: the typical platformer mix
+        int phase = frame % 400;
+        if (phase < 200) target.sprite_world_x += 2;
+        else if (phase >= 300) target.sprite_world_x += (phase & 1) ? 3 : -3;
+        if (target.sprite_world_x > 8000) target.sprite_world_x = 160;
+        SGP_CameraFollowTarget(&target);
+        if (queued) {
+            SGP_VdpQueueCommit();  // Main loop, before SYS_doVBlankProcess
+            SGP_VdpQueueFlush();   // What the VBlank callback does
+        }
+    }
+    double elapsed = now_ns() - start;
+    if (queued) SGP_VdpQueueDisable();
+    report(name, elapsed, PAN_FRAMES, PAN_FRAMES);
+}
+
+static void bench_camera(void) {
+    printf("\n--- SGP_CameraFollowTarget pans (%d frames) ---\n", PAN_FRAMES);
+    bench_camera_pan("Camera locked", CAMERA_LOCKED, NULL, false);
+    bench_camera_pan("Camera locked, VBlank queue", CAMERA_LOCKED, NULL, true);
+    bench_camera_pan("Camera deadzone", CAMERA_DEADZONE, NULL, false);
+    bench_camera_pan("Camera smooth", CAMERA_SMOOTH, NULL, false);
+
+    static SGPParallax layer;
+    SGP_ParallaxInit(&layer, BG_B, HSCROLL_LINE);
+    SGP_ParallaxAddBand(&layer, 0, 64, 0x20);
+    SGP_ParallaxAddBand(&layer, 64, 64, 0x80);
+    SGP_ParallaxAddBand(&layer, 128, 96, SGP_PARALLAX_RATIO_ONE);
+    bench_camera_pan("Camera locked + 3-band parallax", CAMERA_LOCKED, &layer, false);
+    SGP_CameraClearParallax();
+}
+
+int main() {
+    printf("=== SGP Host Micro-benchmarks ===\n");
+    printf("Host timings are for regression tracking only; budget against m68k cycles.\n");
+
+    bench_shared_kernels();
+    bench_camera();
+
+    printf("\n(sink %lu)\n", bench_sink);
+    return 0;
+}
@@ -0,0 +1,477 @@
+/*
+ * bench_kernels.h - Benchmark kernels shared by the host and m68k benchmarks
+ *
+ * The host bench (bench.c, over the sgp_test.h mocks) times these kernels in ns/op;
+ * the m68k ROM (m68k_bench/, built against SGDK) measures them in 68000 cycles per
+ * call. Both builds run exactly the same code on the same synthetic data.
+ *
+ * Include after sgp.h (or sgp_test.h); the including file must define `SGP sgp`.
+ * Every kernel runs `count` operations and returns a value that keeps the work observable.
+ */
+
+#ifndef SGP_BENCH_KERNELS_H
+#define SGP_BENCH_KERNELS_H
+
+// Synthetic level: floor, walls and scattered 3-tile pillars (16KB, fits Genesis RAM)
+#define BENCH_LEVEL_W 256
+#define BENCH_LEVEL_H 64
+#define BENCH_QUERY_COUNT 256 // Power of two, indexed with & (BENCH_QUERY_COUNT - 1)
+#define BENCH_ENTITY_COUNT 32
+#define BENCH_BOX_COUNT 48
+#define BENCH_TRIGGER_COUNT 256
+
+static u8 bench_level_tiles[BENCH_LEVEL_W * BENCH_LEVEL_H];
+static u16 bench_level_bits[BENCH_LEVEL_H * (BENCH_LEVEL_W / 16)];
+static SGPLevelCollisionData bench_level_raw;
+static SGPLevelCollisionData bench_level_prepared;
+static SGPLevelCollisionData bench_level_packed;
+
+// Level size in map blocks, for the block-based copies below
+#define BENCH_LEVEL_BLOCKS_W (BENCH_LEVEL_W >> SGP_COLLISION_BLOCK_SHIFT)
+#define BENCH_LEVEL_BLOCKS_H (BENCH_LEVEL_H >> SGP_COLLISION_BLOCK_SHIFT)
+
+// Streamed copy of the level (RLE blocks, resident window)
+#define BENCH_STREAM_RLE_SIZE 4096 // The synthetic level encodes to about 2.5KB
+static u8 bench_stream_rle[BENCH_STREAM_RLE_SIZE];
+static u32 bench_stream_offsets[BENCH_LEVEL_BLOCKS_W * BENCH_LEVEL_BLOCKS_H];
+static SGPCollisionStream bench_stream;
+static SGPLevelCollisionData bench_level_streamed;
+static s16 bench_stream_view_x = 0;
+static s16 bench_stream_step = 128;
+
+// Deduplicated copy of the level (block map + unique patterns)
+#define BENCH_BLOCK_MAP_SHIFT 5 // 32 blocks per map row
+#define BENCH_BLOCK_PATTERNS 16
+static SGPBlockIndex bench_block_map[BENCH_LEVEL_BLOCKS_H << BENCH_BLOCK_MAP_SHIFT];
+static u8 bench_block_patterns[BENCH_BLOCK_PATTERNS * SGP_COLLISION_BLOCK_TILES * SGP_COLLISION_BLOCK_TILES];
+static SGPLevelCollisionData bench_level_blocks;
+
+static s16 bench_query_x[BENCH_QUERY_COUNT];
+static s16 bench_query_y[BENCH_QUERY_COUNT];
+static s16 bench_entity_x[BENCH_ENTITY_COUNT];
+static s16 bench_entity_y[BENCH_ENTITY_COUNT];
+static SGPCollisionContext bench_contexts[BENCH_ENTITY_COUNT];
+static SGPBox bench_boxes[BENCH_BOX_COUNT];
+static SGPBroadphase bench_broadphase;
+static SGPRay bench_rays[BENCH_ENTITY_COUNT];
+static SGPRayHit bench_ray_hits[BENCH_ENTITY_COUNT];
+static SGPTrigger bench_triggers[BENCH_TRIGGER_COUNT];
+static SGPTriggerLayer bench_trigger_layer;
+static SGPFlowField bench_flow;
+
+// Deterministic pseudo-random sequence (16-bit xorshift: no MULU on the 68000)
+static u16 bench_seed = 0xACE1;
+static u16 bench_rand(void)
+{
+    bench_seed ^= bench_seed << 7;
+    bench_seed ^= bench_seed >> 9;
+    bench_seed ^= bench_seed << 8;
+    return bench_seed;
+}
+
+// Builds the level, query points, entities and boxes; call once before any kernel
+static void bench_setup(void)
+{
+    for (u16 y = 0; y < BENCH_LEVEL_H; y++)
+    {
+        for (u16 x = 0; x < BENCH_LEVEL_W; x++)
+        {
+            const bool solid = (y == BENCH_LEVEL_H - 1) || (x == 0) || (x == BENCH_LEVEL_W - 1) ||
+                               ((x & 15) == 5 && (y & 7) < 3);
+            bench_level_tiles[(y << 8) + x] = solid ? SOLID_TILE : 0;
+        }
+    }
+    SGP_PackCollisionRows(bench_level_tiles, BENCH_LEVEL_W, BENCH_LEVEL_H, bench_level_bits);
+
+    bench_level_raw.row_length = BENCH_LEVEL_W;
+    bench_level_raw.data_length = BENCH_LEVEL_W * BENCH_LEVEL_H;
+    bench_level_raw.collision_data = bench_level_tiles;
+    bench_level_prepared = bench_level_raw;
+    SGP_LevelCollisionPrepare(&bench_level_prepared, NULL);
+    bench_level_packed = bench_level_prepared;
+    bench_level_packed.solid_bits = bench_level_bits;
+    SGP_CollisionStreamEncode(bench_level_tiles, BENCH_LEVEL_W, BENCH_LEVEL_H, bench_stream_rle, bench_stream_offsets);
+    SGP_CollisionStreamInit(&bench_level_streamed, &bench_stream, bench_stream_rle, bench_stream_offsets,
+                            BENCH_LEVEL_BLOCKS_W, BENCH_LEVEL_BLOCKS_H);
+    bench_stream_view_x = 0;
+    SGP_CollisionStreamUpdate(&bench_stream, bench_stream_view_x, 0, 0);
+    SGP_LevelBlocksBuild(bench_level_tiles, BENCH_LEVEL_W, BENCH_LEVEL_H, bench_block_map, BENCH_BLOCK_MAP_SHIFT,
+                         bench_block_patterns, BENCH_BLOCK_PATTERNS);
+    SGP_LevelBlocksInit(&bench_level_blocks, bench_block_map, BENCH_BLOCK_MAP_SHIFT, bench_block_patterns,
+                        BENCH_LEVEL_BLOCKS_W, BENCH_LEVEL_BLOCKS_H);
+
+    bench_seed = 0xACE1;
+    for (u16 i = 0; i < BENCH_QUERY_COUNT; i++)
+    {
+        bench_query_x[i] = (s16)(bench_rand() & (BENCH_LEVEL_W - 1));
+        bench_query_y[i] = (s16)(bench_rand() & (BENCH_LEVEL_H - 1));
+    }
+    for (u16 i = 0; i < BENCH_ENTITY_COUNT; i++)
+    {
+        bench_entity_x[i] = (s16)(32 + (bench_rand() & 0x0F7F)); // Inside the 4096px level
+        bench_entity_y[i] = (s16)(32 + (bench_rand() & 0x01FF)); // Inside the 1024px level
+        SGP_CollisionContextInit(&bench_contexts[i], &bench_level_prepared, 16, 16);
+    }
+    for (u16 i = 0; i < BENCH_ENTITY_COUNT; i++)
+    {
+        // Turret sight lines up to 256px across and 128px up or down from each entity
+        bench_rays[i].x0 = bench_entity_x[i];
+        bench_rays[i].y0 = bench_entity_y[i];
+        bench_rays[i].x1 = bench_entity_x[i] + (s16)((bench_rand() & 0x01FF) - 0x0100);
+        bench_rays[i].y1 = bench_entity_y[i] + (s16)((bench_rand() & 0x00FF) - 0x0080);
+    }
+    for (u16 i = 0; i < BENCH_TRIGGER_COUNT; i++)
+    {
+        // Pickups, spikes and doors scattered over the whole level
+        bench_triggers[i].tile_x = bench_rand() & (BENCH_LEVEL_W - 1);
+        bench_triggers[i].tile_y = bench_rand() & (BENCH_LEVEL_H - 1);
+        bench_triggers[i].type = i & 3;
+        bench_triggers[i].id = i;
+    }
+    SGP_TriggerSort(bench_triggers, BENCH_TRIGGER_COUNT);
+    SGP_TriggerLayerInit(&bench_trigger_layer, bench_triggers, BENCH_TRIGGER_COUNT);
+    SGP_FlowFieldInit(&bench_flow, &bench_level_prepared);
+    SGP_FlowFieldSetTarget(&bench_flow, 40, 32);
+    SGP_FlowFieldUpdate(&bench_flow, 0);
+    for (u16 i = 0; i < BENCH_BOX_COUNT; i++)
+    {
+        bench_boxes[i].x = bench_rand() & 0xFF;  // 256x128 area: a crowded screen
+        bench_boxes[i].y = bench_rand() & 0x7F;
+        bench_boxes[i].w = 16;
+        bench_boxes[i].h = 16;
+    }
+}
+
+/**
+ * @brief One benchmark: `run(count)` performs `count` operations.
+ */
+typedef struct
+{
+    const char *name;
+    u32 (*run)(u16 count);
+    u16 batch; // Operations per measurement on the 68000 (keeps a batch well under one frame)
+} BenchKernel;
+
+// Loop overhead baseline, subtracted by the drivers
+static u32 bench_empty(u16 count)
+{
+    u32 sink = 0;
+    for (u16 i = 0; i < count; i++)
+        sink += bench_query_x[i & (BENCH_QUERY_COUNT - 1)];
+    return sink;
+}
+
+static u32 bench_tiles_raw(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        hits += SGP_TileIsSolidXY(&bench_level_raw, bench_query_x[q], bench_query_y[q], SGP_OOB_HORIZONTAL_SOLID, true);
+    }
+    return hits;
+}
+
+static u32 bench_tiles_prepared(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        hits += SGP_TileIsSolidXY(&bench_level_prepared, bench_query_x[q], bench_query_y[q], SGP_OOB_HORIZONTAL_SOLID, true);
+    }
+    return hits;
+}
+
+static u32 bench_tiles_packed(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        hits += SGP_TileIsSolidXY(&bench_level_packed, bench_query_x[q], bench_query_y[q], SGP_OOB_HORIZONTAL_SOLID, true);
+    }
+    return hits;
+}
+
+static u32 bench_tiles_blocks(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        hits += SGP_TileIsSolidXY(&bench_level_blocks, bench_query_x[q], bench_query_y[q], SGP_OOB_HORIZONTAL_SOLID, true);
+    }
+    return hits;
+}
+
+// Queries inside the resident window (outside it every tile reads empty)
+static u32 bench_tiles_streamed(u16 count)
+{
+    const s16 origin_x = bench_stream.origin_x << SGP_COLLISION_BLOCK_SHIFT;
+    const s16 origin_y = bench_stream.origin_y << SGP_COLLISION_BLOCK_SHIFT;
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        hits += SGP_TileIsSolidXY(&bench_level_streamed, origin_x + (bench_query_x[q] & (SGP_STREAM_CACHE_COLS - 1)),
+                                  origin_y + (bench_query_y[q] & (SGP_STREAM_CACHE_ROWS - 1)), SGP_OOB_HORIZONTAL_SOLID, true);
+    }
+    return hits;
+}
+
+// One operation = the camera moves one block sideways and the entering column is decoded
+static u32 bench_stream_scroll(u16 count)
+{
+    u32 decoded = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const s16 next = bench_stream_view_x + bench_stream_step;
+        if (next < 0 || next > (s16)((BENCH_LEVEL_W << SGP_COLLISION_TILE_SHIFT) - screenWidth))
+            bench_stream_step = -bench_stream_step;
+        bench_stream_view_x += bench_stream_step;
+        decoded += SGP_CollisionStreamUpdate(&bench_stream, bench_stream_view_x, 0, 0);
+    }
+    return decoded;
+}
+
+static u32 bench_edge_sweep(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        hits += SGP_LevelEdgeIsSolid(&bench_level_prepared, bench_entity_x[e] + (s16)(i & 7), bench_entity_y[e],
+                                     32, 32, SGP_DIR_RIGHT);
+    }
+    return hits;
+}
+
+// Ground, ceiling and both walls: four edge sweeps vs one perimeter walk
+static u32 bench_edges_four(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        const s16 x = bench_entity_x[e] + (s16)(i & 7);
+        const s16 y = bench_entity_y[e];
+        hits += SGP_LevelEdgeIsSolid(&bench_level_prepared, x, y, 16, 32, SGP_DIR_LEFT);
+        hits += SGP_LevelEdgeIsSolid(&bench_level_prepared, x, y, 16, 32, SGP_DIR_RIGHT);
+        hits += SGP_LevelEdgeIsSolid(&bench_level_prepared, x, y, 16, 32, SGP_DIR_UP);
+        hits += SGP_LevelEdgeIsSolid(&bench_level_prepared, x, y, 16, 32, SGP_DIR_DOWN);
+    }
+    return hits;
+}
+
+static u32 bench_contact_mask(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        hits += SGP_LevelContactMask(&bench_level_prepared, bench_entity_x[e] + (s16)(i & 7), bench_entity_y[e], 16, 32);
+    }
+    return hits;
+}
+
+// Moving entities: every call misses the per-player cache
+static u32 bench_player_collision(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        hits += SGP_PlayerLevelCollision(e, bench_entity_x[e] + (s16)(i & 15), bench_entity_y[e], 16, 16,
+                                         &bench_level_prepared, SGP_DIR_DOWN);
+    }
+    return hits;
+}
+
+// Batch resolution over the contexts; `step` shifts every box so moving entities miss the cache
+static u32 bench_context_batch(u16 count, s16 step)
+{
+    u32 hits = 0;
+    u16 done = 0;
+    s16 offset = 0;
+    while (done < count)
+    {
+        u16 n = count - done;
+        if (n > BENCH_ENTITY_COUNT)
+            n = BENCH_ENTITY_COUNT;
+        offset = (offset + step) & 15;
+        for (u16 e = 0; e < n; e++)
+        {
+            bench_contexts[e].x = bench_entity_x[e] + offset;
+            bench_contexts[e].y = bench_entity_y[e];
+        }
+        hits += SGP_LevelCollisionBatch(bench_contexts, n, &bench_level_prepared, SGP_DIR_DOWN);
+        done += n;
+    }
+    return hits;
+}
+
+static u32 bench_context_batch_moving(u16 count) { return bench_context_batch(count, 1); }
+static u32 bench_context_batch_idle(u16 count) { return bench_context_batch(count, 0); }
+
+static u32 bench_move_and_collide(u16 count)
+{
+    u32 hits = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        fix32 x = FIX32(bench_entity_x[e]);
+        fix32 y = FIX32(bench_entity_y[e]);
+        hits += SGP_MoveAndCollide(&bench_level_prepared, &x, &y, FIX32(3), FIX32(2), 16, 16);
+    }
+    return hits;
+}
+
+static u32 bench_raycast(u16 count)
+{
+    u32 hits = 0;
+    SGPRayHit hit;
+    for (u16 i = 0; i < count; i++)
+        hits += SGP_LevelRaycast(&bench_level_prepared, &bench_rays[i & (BENCH_ENTITY_COUNT - 1)], &hit);
+    return hits;
+}
+
+// One operation = one ray of a 32-ray batch
+static u32 bench_raycast_batch(u16 count)
+{
+    u32 hits = 0;
+    for (u16 done = 0; done < count; done += BENCH_ENTITY_COUNT)
+    {
+        const u16 n = (count - done < BENCH_ENTITY_COUNT) ? count - done : BENCH_ENTITY_COUNT;
+        hits += SGP_LevelRaycastBatch(&bench_level_prepared, bench_rays, bench_ray_hits, n);
+    }
+    return hits;
+}
+
+static u32 bench_trigger_query(u16 count)
+{
+    u32 found = 0;
+    u16 out[8];
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 e = i & (BENCH_ENTITY_COUNT - 1);
+        const SGPBox box = { (u16)bench_entity_x[e], (u16)bench_entity_y[e], 32, 32 };
+        found += SGP_TriggerLayerQuery(&bench_trigger_layer, &box, out, 8);
+    }
+    return found;
+}
+
+// One operation = one BFS node; the target hops between two tiles so a build is always running
+static u32 bench_flow_build(u16 count)
+{
+    u32 expanded = 0;
+    while (expanded < count)
+    {
+        if (!bench_flow.building)
+            SGP_FlowFieldSetTarget(&bench_flow, (bench_flow.target_x == 40) ? 41 : 40, 32);
+        expanded += SGP_FlowFieldUpdate(&bench_flow, count - expanded);
+    }
+    return expanded;
+}
+
+// One operation = one chaser reading its next step
+static u32 bench_flow_step(u16 count)
+{
+    u32 sink = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        const u16 q = i & (BENCH_QUERY_COUNT - 1);
+        sink += SGP_FlowFieldStep(&bench_flow, 24 + (bench_query_x[q] & 31), 24 + (bench_query_y[q] & 15));
+    }
+    return sink;
+}
+
+// One operation = one box pair check
+static u32 bench_box_pairs(u16 count)
+{
+    u32 hits = 0;
+    u16 a = 0, b = 1;
+    for (u16 i = 0; i < count; i++)
+    {
+        hits += SGP_CheckBoxCollision(&bench_boxes[a], &bench_boxes[b]);
+        if (++b == BENCH_BOX_COUNT)
+        {
+            if (++a == BENCH_BOX_COUNT - 1)
+                a = 0;
+            b = a + 1;
+        }
+    }
+    return hits;
+}
+
+// One operation = rebuild the grid with every box and walk all candidate pairs
+static u32 bench_broadphase_frame(u16 count)
+{
+    u32 pairs = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        SGP_BroadphaseClear(&bench_broadphase, 0, 0);
+        for (u16 n = 0; n < BENCH_BOX_COUNT; n++)
+            SGP_BroadphaseInsert(&bench_broadphase, &bench_boxes[n], n);
+        SGPBroadphasePairIter it;
+        u16 id_a, id_b;
+        SGP_BroadphasePairsBegin(&it);
+        while (SGP_BroadphaseNextPair(&bench_broadphase, &it, &id_a, &id_b))
+            pairs++;
+    }
+    return pairs;
+}
+
+// Camera tracking math without the MAP/VDP commit (deadzone + smoothing per axis)
+static u32 bench_camera_track(u16 count)
+{
+    u32 sink = 0;
+    s16 current = 0;
+    fix32 smooth = FIX32(0);
+    for (u16 i = 0; i < count; i++)
+    {
+        const s16 desired = SGP_CameraDeadzoneAxis(current, (s16)(i << 1), 24);
+        current = SGP_CameraSmoothAxis(&smooth, desired, 3);
+        sink += (u16)current;
+    }
+    return sink;
+}
+
+static u32 bench_input_poll(u16 count)
+{
+    u32 sink = 0;
+    for (u16 i = 0; i < count; i++)
+    {
+        SGP_PollInput();
+        sink += SGP_ButtonPressed(JOY_1, BUTTON_A) + SGP_ButtonDown(JOY_2, BUTTON_B);
+    }
+    return sink;
+}
+
+static const BenchKernel bench_kernels[] = {
+    { "TileIsSolidXY unprepared", bench_tiles_raw, 256 },
+    { "TileIsSolidXY prepared", bench_tiles_prepared, 256 },
+    { "TileIsSolidXY packed", bench_tiles_packed, 256 },
+    { "TileIsSolidXY dedup blocks", bench_tiles_blocks, 256 },
+    { "TileIsSolidXY streamed", bench_tiles_streamed, 256 },
+    { "CollisionStreamUpdate 128px scroll", bench_stream_scroll, 8 },
+    { "LevelEdgeIsSolid 32x32", bench_edge_sweep, 64 },
+    { "4x LevelEdgeIsSolid 16x32", bench_edges_four, 32 },
+    { "LevelContactMask 16x32", bench_contact_mask, 32 },
+    { "PlayerLevelCollision", bench_player_collision, 64 },
+    { "LevelCollisionBatch moving", bench_context_batch_moving, 64 },
+    { "LevelCollisionBatch idle", bench_context_batch_idle, 128 },
+    { "MoveAndCollide", bench_move_and_collide, 32 },
+    { "LevelRaycast <=256px", bench_raycast, 32 },
+    { "LevelRaycastBatch <=256px", bench_raycast_batch, 32 },
+    { "TriggerLayerQuery 32x32, 256 triggers", bench_trigger_query, 64 },
+    { "FlowFieldUpdate per node", bench_flow_build, 64 },
+    { "FlowFieldStep", bench_flow_step, 256 },
+    { "CheckBoxCollision pair", bench_box_pairs, 256 },
+    { "Broadphase 48 boxes", bench_broadphase_frame, 1 },
+    { "Camera deadzone+smooth", bench_camera_track, 256 },
+    { "PollInput + 2 queries", bench_input_poll, 64 },
+};
+#define BENCH_KERNEL_COUNT (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+#endif // SGP_BENCH_KERNELS_H
@@ -5,19 +5,46 @@
  * and sprite positioning for the SGP camera system using a mock SGDK environment.
  */
 
+#include <string.h>
 #include "sgp_test.h"
 
 // Mock SGDK function implementations
 u16 JOY_readJoypad(u16 joy) { (void)joy; return 0; }
-void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; }
+// MAP_scrollTo call tracking
+static int map_scroll_calls = 0;
+static u32 map_scroll_x = 0, map_scroll_y = 0;
+void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; map_scroll_calls++; map_scroll_x = x; map_scroll_y = y; }
 void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
 void SYS_doVBlankProcess(void) {}
-void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
-void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
+static void (*vblank_callback)(void) = NULL;
+void SYS_setVBlankCallback(void (*callback)(void)) { vblank_callback = callback; }
+static int hscroll_calls = 0;
+void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; hscroll_calls++; }
+// Vertical scroll and hscroll table DMA tracking
+static int vscroll_calls = 0;
+static s16 vscroll_value = 0;
+static int hscroll_dma_calls = 0, hscroll_tile_calls = 0;
+static u16 hscroll_dma_first = 0, hscroll_dma_len = 0, hscroll_dma_method = 0;
+void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; vscroll_calls++; vscroll_value = scroll; }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { (void)offset; return 0; }
+void SRAM_writeWord(u32 offset, u16 val) { (void)offset; (void)val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)values; hscroll_dma_calls++; hscroll_dma_first = line; hscroll_dma_len = len; hscroll_dma_method = tm; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)values; hscroll_tile_calls++; hscroll_dma_first = tile; hscroll_dma_len = len; hscroll_dma_method = tm; }
 void SPR_setPosition(Sprite* sprite, s16 x, s16 y) { (void)sprite; (void)x; (void)y; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { (void)sprite; (void)visibility; }
 void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
+static int draw_text_calls = 0;
+static char last_draw_text[64];
 void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) { 
-    (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; }
+    (void)plane; (void)attr; (void)x; (void)y; (void)method;
+    draw_text_calls++; snprintf(last_draw_text, sizeof(last_draw_text), "%s", str); }
 u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) { 
     (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; }
 
@@ -256,6 +283,358 @@ void test_camera_limits() {
     SGP_CameraSetVerticalScrollLimit(32);
 }
 
+void test_camera_streaming() {
+    printf("\n=== Camera Streaming Tests ===\n");
+
+    SGP_init();
+    Map test_map = {0};
+    test_map.w = 32;
+    test_map.h = 16;
+    SGP_CameraInit(&test_map);
+
+    SGPCameraTarget target = {
+        .sprite = &dummy_sprite,
+        .offset_x = 160,
+        .offset_y = 112,
+        .sprite_world_x = 160,
+        .sprite_world_y = 112
+    };
+    SGP_CameraFollowTarget(&target);
+
+    // Budget of two metatile columns per frame
+    const u16 col_bytes = SGP_CameraStreamColumnBytes();
+    SGP_CameraSetStreamBudget(col_bytes * 2);
+    print_test_result("Stream budget stored", SGP_CameraGetStreamBudget() == col_bytes * 2);
+
+    // Small move fits in the budget and commits at once
+    target.sprite_world_x = 180;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Small move commits immediately", sgp.camera.current_x == 20 && !SGP_isCameraStreaming());
+
+    // Teleport: spread over frames, at most two new columns per frame
+    target.sprite_world_x = 2000;
+    int frames = 0;
+    bool within_budget = true;
+    u32 last_x = sgp.camera.current_x;
+    map_scroll_calls = 0;
+    do {
+        SGP_CameraFollowTarget(&target);
+        if ((sgp.camera.current_x >> 4) - (last_x >> 4) > 2) within_budget = false;
+        last_x = sgp.camera.current_x;
+        frames++;
+    } while (SGP_isCameraStreaming() && frames < 200);
+    print_test_result("Teleport spread over several frames", frames > 1 && map_scroll_calls == frames);
+    print_test_result("Each frame stays within budget", within_budget);
+    print_test_result("Camera reaches target", sgp.camera.current_x == 1840 && map_scroll_x == 1840);
+
+    // Diagonal teleport moves both axes every frame until done
+    target.sprite_world_x = 160;
+    target.sprite_world_y = 1500;
+    SGP_CameraSetStreamBudget(col_bytes);
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Diagonal progresses on both axes", sgp.camera.current_x < 1840 && sgp.camera.current_y > 0);
+    for (frames = 0; SGP_isCameraStreaming() && frames < 500; frames++)
+        SGP_CameraFollowTarget(&target);
+    print_test_result("Diagonal reaches target", sgp.camera.current_x == 0 && sgp.camera.current_y == 1388 && map_scroll_y == 1388);
+
+    // Unlimited budget jumps in one frame
+    SGP_CameraSetStreamBudget(0);
+    target.sprite_world_x = 2000;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Unlimited budget jumps at once", sgp.camera.current_x == 1840 && !SGP_isCameraStreaming());
+}
+
+void test_camera_modes() {
+    printf("\n=== Camera Deadzone/Smooth Tests ===\n");
+
+    SGP_init();
+    Map test_map = {0};
+    test_map.w = 32;
+    test_map.h = 16;
+    SGP_CameraInit(&test_map);
+    print_test_result("Default camera type is locked", SGP_CameraGetType() == CAMERA_LOCKED);
+
+    SGPCameraTarget target = {
+        .sprite = &dummy_sprite,
+        .offset_x = 160,
+        .offset_y = 112,
+        .sprite_world_x = 1000,
+        .sprite_world_y = 600
+    };
+    SGP_CameraFollowTarget(&target);
+
+    // Deadzone: jitter inside the window never touches the scroll registers
+    SGP_CameraSetType(CAMERA_DEADZONE);
+    SGP_CameraSetDeadzone(16, 8);
+    map_scroll_calls = 0;
+    for (int i = 0; i < 20; i++) {
+        target.sprite_world_x = 1000 + ((i & 1) ? 12 : -12);
+        target.sprite_world_y = 600 + ((i & 1) ? 6 : -6);
+        SGP_CameraFollowTarget(&target);
+    }
+    print_test_result("Deadzone jitter commits no scroll", map_scroll_calls == 0 && sgp.camera.current_x == 840);
+
+    // Leaving the window drags the camera by the overshoot only
+    target.sprite_world_x = 1030;
+    target.sprite_world_y = 600;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Deadzone exit moves by overshoot", sgp.camera.current_x == 854 && map_scroll_calls == 1);
+    target.sprite_world_y = 580;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Deadzone exit on vertical axis", sgp.camera.current_y == 476 && sgp.camera.current_x == 854);
+
+    // Smooth: eases toward the target, monotonic and converging exactly
+    SGP_CameraSetType(CAMERA_SMOOTH);
+    SGP_CameraSetDeadzone(0, 0);
+    SGP_CameraSetSmoothing(2);
+    target.sprite_world_x = 1400;
+    target.sprite_world_y = 580;
+    bool monotonic = true;
+    u32 last_x = sgp.camera.current_x;
+    int frames = 0;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Smooth first step is a fraction", sgp.camera.current_x > 854 && sgp.camera.current_x < 1240);
+    for (frames = 1; sgp.camera.current_x != 1240 && frames < 200; frames++) {
+        if (sgp.camera.current_x < last_x) monotonic = false;
+        last_x = sgp.camera.current_x;
+        SGP_CameraFollowTarget(&target);
+    }
+    print_test_result("Smooth camera monotonic", monotonic);
+    print_test_result("Smooth camera converges", sgp.camera.current_x == 1240 && frames < 200);
+
+    // Once settled, idle frames issue no further scroll writes
+    map_scroll_calls = 0;
+    for (int i = 0; i < 10; i++)
+        SGP_CameraFollowTarget(&target);
+    print_test_result("Settled smooth camera is idle", map_scroll_calls == 0);
+
+    SGP_CameraSetType(CAMERA_LOCKED);
+}
+
+void test_camera_shake() {
+    printf("\n=== Camera Shake Tests ===\n");
+
+    SGP_init();
+    Map test_map = {0};
+    test_map.w = 32;
+    test_map.h = 16;
+    SGP_CameraInit(&test_map);
+
+    SGPCameraTarget target = {
+        .sprite = &dummy_sprite,
+        .offset_x = 160,
+        .offset_y = 112,
+        .sprite_world_x = 1000,
+        .sprite_world_y = 600
+    };
+    SGP_CameraFollowTarget(&target);
+
+    SGP_CameraStartShake(8, 8);
+    print_test_result("Shake starts without blocking", SGP_isCameraShaking() && SGP_isCameraActive());
+
+    // Offsets alternate around the camera and never grow
+    bool alternates = true, decays = true;
+    int last_mag = 9, last_sign = 0, frames = 0;
+    map_scroll_calls = 0;
+    while (SGP_isCameraShaking() && frames < 20) {
+        SGP_CameraFollowTarget(&target);
+        int delta = (int)map_scroll_x - 840;
+        int mag = delta < 0 ? -delta : delta;
+        int sign = delta < 0 ? -1 : 1;
+        if (mag > last_mag || mag == 0) decays = false;
+        if (sign == last_sign) alternates = false;
+        last_mag = mag;
+        last_sign = sign;
+        frames++;
+    }
+    print_test_result("Shake lasts its duration", frames == 8 && map_scroll_calls == 8);
+    print_test_result("Shake offset alternates sign", alternates);
+    print_test_result("Shake offset decays", decays);
+    print_test_result("Logical camera position unshaken", sgp.camera.current_x == 840);
+
+    // Next frame restores the resting scroll, then goes idle
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Shake end restores scroll", map_scroll_x == 840 && map_scroll_calls == 9);
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Idle after shake", map_scroll_calls == 9);
+
+    // Target tracking continues during a shake
+    SGP_CameraStartShake(30, 4);
+    target.sprite_world_x = 1100;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Camera tracks target while shaking", sgp.camera.current_x == 940);
+
+    // Shaken position stays inside the map at the left edge
+    target.sprite_world_x = 0;
+    SGP_CameraStartShake(4, 8);
+    bool in_bounds = true;
+    for (frames = 0; frames < 6; frames++) {
+        SGP_CameraFollowTarget(&target);
+        if ((s32)map_scroll_x < 0) in_bounds = false;
+    }
+    print_test_result("Shake clamped to map bounds", in_bounds && sgp.camera.current_x == 0);
+
+    SGP_CameraStartShake(30, 4);
+    SGP_CameraStopShake();
+    print_test_result("Stop shake ends immediately", !SGP_isCameraShaking());
+}
+
+void test_camera_parallax() {
+    printf("\n=== Camera Parallax Tests ===\n");
+
+    SGP_init();
+    Map test_map = {0};
+    test_map.w = 32;
+    test_map.h = 16;
+    SGP_CameraInit(&test_map);
+
+    SGPCameraTarget target = {
+        .sprite = &dummy_sprite,
+        .offset_x = 160,
+        .offset_y = 112,
+        .sprite_world_x = 160,
+        .sprite_world_y = 112
+    };
+
+    // Legacy path honours max_vertical_scroll instead of a literal 32
+    SGP_CameraSetVerticalScrollLimit(10);
+    target.sprite_world_y = 1000;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Legacy vscroll uses scroll limit", vscroll_value == 10);
+    SGP_CameraSetVerticalScrollLimit(32);
+    target.sprite_world_y = 112;
+    SGP_CameraFollowTarget(&target);
+
+    // Clouds, mountains and water in line mode
+    static SGPParallax layer;
+    SGP_ParallaxInit(&layer, BG_B, HSCROLL_LINE);
+    u8 clouds = SGP_ParallaxAddBand(&layer, 0, 64, 0x20);
+    u8 mountains = SGP_ParallaxAddBand(&layer, 64, 64, 0x80);
+    u8 water = SGP_ParallaxAddBand(&layer, 128, 96, SGP_PARALLAX_RATIO_ONE);
+    print_test_result("Bands added in order", clouds == 0 && mountains == 1 && water == 2);
+    print_test_result("Out of range band rejected", SGP_ParallaxAddBand(&layer, 200, 64, 0x100) == SGP_PARALLAX_NONE);
+
+    hscroll_dma_calls = 0;
+    SGP_CameraAddParallax(&layer);
+    print_test_result("Attach uploads whole table once",
+                      hscroll_dma_calls == 1 && hscroll_dma_first == 0 && hscroll_dma_len == 224 && hscroll_dma_method == DMA_QUEUE);
+
+    // 4px: clouds unchanged, mountains and water rewritten in one span
+    hscroll_dma_calls = 0;
+    target.sprite_world_x = 164;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Changed bands uploaded as one DMA",
+                      hscroll_dma_calls == 1 && hscroll_dma_first == 64 && hscroll_dma_len == 160);
+    print_test_result("Band values follow ratios",
+                      layer.hscroll[0] == 0 && layer.hscroll[64] == -2 && layer.hscroll[127] == -2 && layer.hscroll[223] == -4);
+
+    // 1px more: only the water band changes
+    target.sprite_world_x = 165;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Only changed band recomputed",
+                      hscroll_dma_calls == 2 && hscroll_dma_first == 128 && hscroll_dma_len == 96 && layer.hscroll[128] == -5);
+
+    // No camera movement: no upload
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Static camera uploads nothing", hscroll_dma_calls == 2);
+
+    // Ratio change with the camera still: applied on the next follow, not on the next move
+    SGP_ParallaxSetBandRatio(&layer, mountains, 0x40);
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Ratio change applies without movement",
+                      hscroll_dma_calls == 3 && hscroll_dma_first == 64 && hscroll_dma_len == 64 && layer.hscroll[64] == -1);
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Applied ratio change uploads once", hscroll_dma_calls == 3);
+
+    // Ratio change forces that band only
+    SGP_ParallaxSetBandRatio(&layer, clouds, 0x100);
+    print_test_result("Ratio change rewrites one band", SGP_ParallaxUpdate(&layer, 5, 0) == 1 && layer.hscroll[10] == -5);
+
+    // Vertical ratio clamps to max_vertical_scroll
+    SGP_ParallaxSetVerticalRatio(&layer, SGP_PARALLAX_RATIO_ONE);
+    target.sprite_world_y = 400;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Parallax vscroll clamped to limit", vscroll_value == 32);
+
+    // Lines between bands are uploaded with the span, so they must scroll 0 instead of stale RAM
+    static SGPParallax gaps;
+    for (u16 line = 0; line < SGP_PARALLAX_MAX_LINES; line++) gaps.hscroll[line] = 0x5A5A;
+    SGP_CameraClearParallax();
+    SGP_ParallaxInit(&gaps, BG_B, HSCROLL_LINE);
+    SGP_ParallaxAddBand(&gaps, 0, 16, 0x100);
+    SGP_ParallaxAddBand(&gaps, 100, 16, 0x100);
+    SGP_CameraAddParallax(&gaps);
+    print_test_result("Uncovered lines scroll 0",
+                      hscroll_dma_first == 0 && hscroll_dma_len == 116 && gaps.hscroll[50] == 0 && gaps.hscroll[200] == 0);
+
+    // Tile mode goes through the tile upload
+    static SGPParallax tiles;
+    SGP_CameraClearParallax();
+    SGP_ParallaxInit(&tiles, BG_B, HSCROLL_TILE);
+    print_test_result("Tile band range checked", SGP_ParallaxAddBand(&tiles, 0, 31, 0x40) == SGP_PARALLAX_NONE);
+    SGP_ParallaxAddBand(&tiles, 0, 28, 0x40);
+    hscroll_tile_calls = 0;
+    SGP_CameraAddParallax(&tiles);
+    print_test_result("Tile mode uses tile DMA", hscroll_tile_calls == 1 && hscroll_dma_len == 28);
+    SGP_CameraClearParallax();
+}
+
+void test_vdp_queue() {
+    printf("\n=== VDP Command Queue Tests ===\n");
+    
+    SGP_init();
+    Map test_map = {0};
+    test_map.w = 32;
+    test_map.h = 16;
+    SGP_CameraInit(&test_map);
+#ifdef DEBUG
+    SGP_DebugFlush(); // Show the debug window now, so commits below only carry camera writes
+#endif
+    SGP_VdpQueueInit();
+    print_test_result("Flush installed as VBlank callback", vblank_callback != NULL && SGP_isVdpQueueEnabled());
+    
+    // Three camera moves in one frame: nothing reaches the VDP until VBlank
+    map_scroll_calls = hscroll_calls = vscroll_calls = 0;
+    SGPCameraTarget target = { NULL, 160, 112, 400, 224 };
+    for (int i = 0; i < 3; i++) {
+        target.sprite_world_x += 20;
+        SGP_CameraFollowTarget(&target);
+    }
+    print_test_result("Writes deferred during the frame", map_scroll_calls == 0 && hscroll_calls == 0 && vscroll_calls == 0);
+    vblank_callback();
+    print_test_result("VBlank writes registers only", map_scroll_calls == 0 && hscroll_calls == 1 && vscroll_calls == 1);
+    print_test_result("Commit scrolls the map once", SGP_VdpQueueCommit() == 1 && map_scroll_calls == 1);
+    print_test_result("Last scroll value wins", map_scroll_x == 300 && map_scroll_y == 112);
+    print_test_result("Replaced writes counted", sgp.vdp.dropped == 6);
+    
+    // Horizontal move only: the unchanged vertical scroll is not rewritten
+    target.sprite_world_x += 16;
+    SGP_CameraFollowTarget(&target);
+    const u16 writes = SGP_VdpQueueCommit() + SGP_VdpQueueFlush();
+    print_test_result("Unchanged register skipped", writes == 2 && vscroll_calls == 1 && hscroll_calls == 2);
+    print_test_result("Empty queue flushes nothing", SGP_VdpQueueCommit() == 0 && SGP_VdpQueueFlush() == 0);
+    
+    // Text at the same position coalesces to the last string
+    draw_text_calls = 0;
+    SGP_VdpDrawText(WINDOW, "HP 3", 0, 2, 1);
+    SGP_VdpDrawText(WINDOW, "HP 2", 0, 2, 1);
+    SGP_VdpDrawText(WINDOW, "LV 1", 0, 2, 2);
+    vblank_callback();
+    print_test_result("VBlank leaves text queued", draw_text_calls == 0);
+    SGP_VdpQueueCommit();
+    print_test_result("Text coalesced per position", draw_text_calls == 2 && strcmp(last_draw_text, "LV 1") == 0);
+    
+    // Disabling flushes and restores immediate writes
+    target.sprite_world_x += 16;
+    SGP_CameraFollowTarget(&target);
+    SGP_VdpQueueDisable();
+    const int after_disable = map_scroll_calls;
+    target.sprite_world_x += 16;
+    SGP_CameraFollowTarget(&target);
+    print_test_result("Disable flushes and writes immediately", vblank_callback == NULL && !SGP_isVdpQueueEnabled() &&
+                      map_scroll_calls == after_disable + 1 && after_disable == 3);
+}
+
 int main() {
     printf("=== SGP Comprehensive Camera System Test Suite ===\n");
     
@@ -275,6 +654,11 @@ int main() {
     test_camera_state_management();
     test_direct_camera_updates();
     test_camera_limits();
+    test_camera_streaming();
+    test_camera_modes();
+    test_camera_shake();
+    test_camera_parallax();
+    test_vdp_queue();
     
     // Summary
     printf("\n=== Test Summary ===\n");
@@ -12,14 +12,27 @@ u16 JOY_readJoypad(u16 joy) { (void)joy; return 0; }
 void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; }
 void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
 void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
 void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
 void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
 void SPR_setPosition(Sprite* sprite, s16 x, s16 y) { (void)sprite; (void)x; (void)y; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { (void)sprite; (void)visibility; }
 void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
 void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) { 
     (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; }
 u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) { 
     (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { (void)offset; return 0; }
+void SRAM_writeWord(u32 offset, u16 val) { (void)offset; (void)val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; }
 
 // Required global SGP state
 SGP sgp;
@@ -191,11 +204,981 @@ void test_axis_specific_sampling() {
     bool result = SGP_PlayerLevelCollision(player_index, 16, 96, player_width, player_height, &test_level, SGP_DIR_RIGHT);
     print_test_result("Ground contact - horizontal movement", false, result);
     
-    // Test that vertical movement checks full width
-    result = SGP_PlayerLevelCollision(player_index, 16, 96, player_width, player_height, &test_level, SGP_DIR_DOWN);
+    // Test that vertical movement checks full width (moved down 1px into the floor)
+    result = SGP_PlayerLevelCollision(player_index, 16, 97, player_width, player_height, &test_level, SGP_DIR_DOWN);
     print_test_result("Ground contact - vertical movement", true, result);
 }
 
+// Returns true if every tile query (including OOB) matches between two levels
+static bool tile_queries_match(const SGPLevelCollisionData *a, const SGPLevelCollisionData *b, s16 cols, s16 rows) {
+    for (s16 y = -1; y <= rows; y++) {
+        for (s16 x = -1; x <= cols; x++) {
+            if (SGP_TileIsSolidXY(a, x, y, true, false) != SGP_TileIsSolidXY(b, x, y, true, false))
+                return false;
+        }
+    }
+    return true;
+}
+
+void test_prepared_levels() {
+    printf("\n=== Prepared Level Tests ===\n");
+
+    // Power-of-two row length: indexed with a shift
+    SGPLevelCollisionData pow2_level = test_level;
+    bool prepared = SGP_LevelCollisionPrepare(&pow2_level, NULL);
+    print_test_result("Prepare pow2 level", true, prepared);
+    print_test_result("Pow2 level uses shift indexing", true,
+                      FLAG_IS_ACTIVE(pow2_level.prepare_flags, SGP_LEVEL_POW2_ROWS) && pow2_level.row_shift == 3);
+    print_test_result("Pow2 level rows cached", true, SGP_LevelTotalRows(&pow2_level) == 8);
+    print_test_result("Pow2 level matches unprepared", true, tile_queries_match(&pow2_level, &test_level, 8, 8));
+
+    // Non-power-of-two row length: 6x4 level with and without a row table
+    static const u8 odd_data[] = {
+        1, 0, 0, 0, 0, 1,
+        0, 1, 0, 0, 1, 0,
+        0, 0, 1, 1, 0, 0,
+        1, 1, 0, 0, 1, 1
+    };
+    SGPLevelCollisionData odd_level = { .row_length = 6, .data_length = 24, .collision_data = odd_data };
+    SGPLevelCollisionData odd_table = odd_level;
+    SGPLevelCollisionData odd_plain = odd_level;
+    u16 row_offsets[4];
+    SGP_LevelCollisionPrepare(&odd_table, row_offsets);
+    SGP_LevelCollisionPrepare(&odd_plain, NULL);
+    print_test_result("Row table filled", true,
+                      FLAG_IS_ACTIVE(odd_table.prepare_flags, SGP_LEVEL_ROW_TABLE) && row_offsets[3] == 18);
+    print_test_result("Row table level matches unprepared", true, tile_queries_match(&odd_table, &odd_level, 6, 4));
+    print_test_result("Rows-only level matches unprepared", true, tile_queries_match(&odd_plain, &odd_level, 6, 4));
+
+    // Prepared level gives the same collision results
+    bool result = SGP_PlayerLevelCollision(0, 0, 16, 16, 16, &pow2_level, SGP_DIR_LEFT);
+    print_test_result("Prepared level - hit left wall", true, result);
+
+    // Empty level cannot be prepared
+    SGPLevelCollisionData empty_level = { .row_length = 0, .data_length = 0, .collision_data = NULL };
+    print_test_result("Prepare empty level fails", false, SGP_LevelCollisionPrepare(&empty_level, NULL));
+}
+
+// Reference span check: one SGP_TileIsSolidXY call per tile
+static bool span_by_tiles(const SGPLevelCollisionData *level, s16 x0, s16 x1, s16 y, bool oob_x, bool oob_y) {
+    for (s16 x = x0; x <= x1; x++) {
+        if (SGP_TileIsSolidXY(level, x, y, oob_x, oob_y))
+            return true;
+    }
+    return false;
+}
+
+void test_packed_levels() {
+    printf("\n=== Packed Collision Row Tests ===\n");
+
+    // Pack the 8x8 test level: one word per row
+    static u16 packed_rows[8];
+    SGP_PackCollisionRows(test_level_data, 8, 8, packed_rows);
+    print_test_result("Packed row 2 bit layout", true, packed_rows[2] == 0xBD00);
+
+    SGPLevelCollisionData packed_level = { .row_length = 8, .data_length = 64, .collision_data = NULL, .solid_bits = packed_rows };
+    print_test_result("Packed level matches byte level", true, tile_queries_match(&packed_level, &test_level, 8, 8));
+    SGP_LevelCollisionPrepare(&packed_level, NULL);
+    print_test_result("Prepared packed level matches byte level", true, tile_queries_match(&packed_level, &test_level, 8, 8));
+
+    bool result = SGP_PlayerLevelCollision(0, 0, 16, 16, 16, &packed_level, SGP_DIR_LEFT);
+    print_test_result("Packed level - hit left wall", true, result);
+    result = SGP_PlayerLevelCollision(0, 48, 48, 16, 16, &packed_level, SGP_DIR_RIGHT);
+    print_test_result("Packed level - inner room move right", false, result);
+
+    // 40-tile rows span three words; compare every span against per-tile queries
+    enum { WIDE_COLS = 40, WIDE_ROWS = 3 };
+    static u8 wide_data[WIDE_COLS * WIDE_ROWS];
+    static u16 wide_rows[3 * WIDE_ROWS];
+    for (int i = 0; i < WIDE_COLS * WIDE_ROWS; i++)
+        wide_data[i] = ((i * 7) % 11 == 0) ? 1 : 0;
+    SGP_PackCollisionRows(wide_data, WIDE_COLS, WIDE_ROWS, wide_rows);
+    SGPLevelCollisionData wide_bytes = { .row_length = WIDE_COLS, .data_length = WIDE_COLS * WIDE_ROWS, .collision_data = wide_data };
+    SGPLevelCollisionData wide_packed = { .row_length = WIDE_COLS, .data_length = WIDE_COLS * WIDE_ROWS, .solid_bits = wide_rows };
+    SGP_LevelCollisionPrepare(&wide_packed, NULL);
+
+    bool spans_match = true;
+    for (s16 y = -1; y <= WIDE_ROWS && spans_match; y++) {
+        for (s16 x0 = -2; x0 < WIDE_COLS + 2 && spans_match; x0++) {
+            for (s16 x1 = x0; x1 < WIDE_COLS + 2; x1++) {
+                bool expected = span_by_tiles(&wide_bytes, x0, x1, y, false, true);
+                if (SGP_TileRowSpanIsSolid(&wide_packed, x0, x1, y, false, true) != expected ||
+                    SGP_TileRowSpanIsSolid(&wide_bytes, x0, x1, y, false, true) != expected) {
+                    spans_match = false;
+                    break;
+                }
+            }
+        }
+    }
+    print_test_result("Row spans match per-tile queries", true, spans_match);
+    print_test_result("Span OOB left with solid OOB", true, SGP_TileRowSpanIsSolid(&wide_packed, -1, 0, 1, true, false));
+}
+
+void test_full_edge_sweep() {
+    printf("\n=== Full-Edge Sweep Tests ===\n");
+
+    // Open 8x8 room with single-tile pillars at (4,3) and (2,6)
+    static const u8 pillar_data[] = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 1, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 1, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0
+    };
+    SGPLevelCollisionData pillar_level = { .row_length = 8, .data_length = 64, .collision_data = pillar_data };
+    static u16 pillar_rows[8];
+    SGP_PackCollisionRows(pillar_data, 8, 8, pillar_rows);
+    SGPLevelCollisionData pillar_packed = { .row_length = 8, .data_length = 64, .solid_bits = pillar_rows };
+    SGP_LevelCollisionPrepare(&pillar_packed, NULL);
+
+    // 16x48 box spanning rows 2..4: corners miss the pillar, the middle row hits it
+    bool result = SGP_LevelEdgeIsSolid(&pillar_level, 64, 32, 16, 48, SGP_DIR_RIGHT);
+    print_test_result("Tall box hits pillar between corners", true, result);
+    result = SGP_LevelEdgeIsSolid(&pillar_packed, 64, 32, 16, 48, SGP_DIR_LEFT);
+    print_test_result("Tall box hits pillar (packed)", true, result);
+
+    // 48x16 box spanning columns 1..3 lands on the pillar under its middle column
+    result = SGP_LevelEdgeIsSolid(&pillar_level, 16, 96, 48, 16, SGP_DIR_DOWN);
+    print_test_result("Wide box lands on pillar between corners", true, result);
+    result = SGP_LevelEdgeIsSolid(&pillar_packed, 16, 96, 48, 16, SGP_DIR_UP);
+    print_test_result("Wide box hits pillar moving up (packed)", true, result);
+
+    // Player collision uses the full edge too
+    result = SGP_PlayerLevelCollision(1, 64, 32, 16, 48, &pillar_level, SGP_DIR_RIGHT);
+    print_test_result("Player collision with tall box", true, result);
+    result = SGP_PlayerLevelCollision(1, 96, 32, 16, 48, &pillar_level, SGP_DIR_RIGHT);
+    print_test_result("Tall box clear of pillar", false, result);
+
+    // No direction: whole-box overlap
+    result = SGP_LevelEdgeIsSolid(&pillar_level, 48, 32, 48, 48, 0);
+    print_test_result("Box overlap contains pillar", true, result);
+    result = SGP_LevelEdgeIsSolid(&pillar_level, 80, 64, 32, 32, 0);
+    print_test_result("Box overlap empty", false, result);
+}
+
+void test_move_and_collide() {
+    printf("\n=== Move And Collide Tests ===\n");
+
+    // Free movement in the top corridor
+    fix32 x = FIX32(16), y = FIX32(16);
+    u16 flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(3), FIX32(0), 16, 16);
+    print_test_result("Free move right", true, flags == 0 && x == FIX32(19) && y == FIX32(16));
+
+    // Fast move right stops flush against the right wall (tile 7 starts at 112)
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(100), FIX32(0), 16, 16);
+    print_test_result("Fast move right snaps to wall", true, flags == COLLIDE_RIGHT && x == FIX32(96));
+
+    // Move left into the left wall
+    x = FIX32(20);
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(-10), FIX32(0), 16, 16);
+    print_test_result("Move left snaps to wall", true, flags == COLLIDE_LEFT && x == FIX32(16));
+
+    // Fall down the left corridor onto the floor (tile row 7 starts at 112)
+    x = FIX32(16); y = FIX32(16);
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(0), FIX32(200), 16, 16);
+    print_test_result("Fall snaps to floor", true, flags == COLLIDE_DOWN && y == FIX32(96));
+
+    // Jump into the ceiling
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(0), FIX32(-200), 16, 16);
+    print_test_result("Jump snaps to ceiling", true, flags == COLLIDE_UP && y == FIX32(16));
+
+    // Diagonal into the bottom-right corner blocks both axes
+    x = FIX32(90); y = FIX32(90);
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(20), FIX32(20), 16, 16);
+    print_test_result("Diagonal into corner", true,
+                      flags == (COLLIDE_RIGHT | COLLIDE_DOWN) && x == FIX32(96) && y == FIX32(96));
+
+    // Slide: blocked on X, Y still moves
+    x = FIX32(96); y = FIX32(40);
+    flags = SGP_MoveAndCollide(&test_level, &x, &y, FIX32(4), FIX32(4), 16, 16);
+    print_test_result("Slide along wall", true, flags == COLLIDE_RIGHT && x == FIX32(96) && y == FIX32(44));
+}
+
+void test_collision_contexts() {
+    printf("\n=== Collision Context Tests ===\n");
+
+    // Indices past SGP_MAX_PLAYER_COUNT are resolved without the per-player cache
+    bool result = SGP_PlayerLevelCollision(7, 0, 16, 16, 16, &test_level, SGP_DIR_LEFT);
+    print_test_result("Enemy index past player count", true, result);
+    result = SGP_PlayerLevelCollision(7, 16, 16, 16, 16, &test_level, SGP_DIR_LEFT);
+    print_test_result("Enemy index past player count - open", false, result);
+
+    // Single context caches per direction
+    SGPCollisionContext ctx;
+    SGP_CollisionContextInit(&ctx, &test_level, 16, 16);
+    ctx.x = 16; ctx.y = 16;
+    result = SGP_ContextLevelCollision(&ctx, SGP_DIR_RIGHT);
+    print_test_result("Context open to the right", false, result);
+    print_test_result("Context caches right result", true,
+                      FLAG_IS_ACTIVE(ctx.known, COLLIDE_RIGHT) && FLAG_IS_INACTIVE(ctx.flags, COLLIDE_RIGHT));
+    ctx.x = 0;
+    result = SGP_ContextLevelCollision(&ctx, SGP_DIR_LEFT);
+    print_test_result("Context recalculates after move", true, result);
+    print_test_result("Context drops stale directions", true, FLAG_IS_INACTIVE(ctx.known, COLLIDE_RIGHT));
+    result = SGP_ContextLevelCollision(&ctx, SGP_DIR_LEFT);
+    print_test_result("Context cached hit", true, result);
+
+    // Batch of enemies along the bottom corridor, every 4th one against the left wall
+    enum { ENEMY_COUNT = 32 };
+    SGPCollisionContext enemies[ENEMY_COUNT];
+    u16 expected_hits = 0;
+    bool batch_matches = true;
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        SGP_CollisionContextInit(&enemies[i], NULL, 16, 16);
+        enemies[i].x = (i % 4 == 0) ? 8 : 16 + (i % 5) * 16;
+        enemies[i].y = 96;
+    }
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        if (SGP_LevelEdgeIsSolid(&test_level, enemies[i].x, enemies[i].y, 16, 16, SGP_DIR_LEFT))
+            expected_hits++;
+    }
+    u16 hits = SGP_LevelCollisionBatch(enemies, ENEMY_COUNT, &test_level, SGP_DIR_LEFT);
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        bool expected = SGP_LevelEdgeIsSolid(&test_level, enemies[i].x, enemies[i].y, 16, 16, SGP_DIR_LEFT);
+        if (FLAG_IS_ACTIVE(enemies[i].flags, COLLIDE_LEFT) != expected || enemies[i].level != &test_level)
+            batch_matches = false;
+    }
+    print_test_result("Batch hit count", true, hits == expected_hits && hits == ENEMY_COUNT / 4);
+    print_test_result("Batch per-context results", true, batch_matches);
+
+    // Rebinding to another level drops the cache
+    static const u8 open_data[64] = {0};
+    SGPLevelCollisionData open_level = { .row_length = 8, .data_length = 64, .collision_data = open_data };
+    hits = SGP_LevelCollisionBatch(enemies, ENEMY_COUNT, &open_level, SGP_DIR_LEFT);
+    print_test_result("Batch rebinds level", true, hits == 0);
+}
+
+void test_broadphase() {
+    printf("\n=== Broadphase Tests ===\n");
+
+    enum { BOX_COUNT = 64 };
+    static SGPBox boxes[BOX_COUNT];
+    static bool brute[BOX_COUNT][BOX_COUNT];
+    static bool found[BOX_COUNT][BOX_COUNT];
+    static SGPBroadphase bp;
+    u32 seed = 12345;
+
+    // Boxes scattered around a camera at (1000, 500), some straddling or outside the screen
+    for (int i = 0; i < BOX_COUNT; i++) {
+        seed = seed * 1103515245u + 12345u;
+        boxes[i].x = 960 + (u16)((seed >> 8) % 400);
+        seed = seed * 1103515245u + 12345u;
+        boxes[i].y = 470 + (u16)((seed >> 8) % 290);
+        boxes[i].w = 8 + (u16)(i % 5) * 8;
+        boxes[i].h = 8 + (u16)(i % 3) * 12;
+    }
+
+    SGP_BroadphaseClear(&bp, 1000, 500);
+    bool inserted = true;
+    for (int i = 0; i < BOX_COUNT; i++)
+        inserted = SGP_BroadphaseInsert(&bp, &boxes[i], (u16)i) && inserted;
+    print_test_result("Insert 64 boxes", true, inserted);
+
+    int brute_pairs = 0;
+    for (int i = 0; i < BOX_COUNT; i++) {
+        for (int j = 0; j < BOX_COUNT; j++) {
+            brute[i][j] = (i != j) && SGP_CheckBoxCollision(&boxes[i], &boxes[j]);
+            found[i][j] = false;
+            if (i < j && brute[i][j]) brute_pairs++;
+        }
+    }
+
+    // Every overlapping pair reported exactly once
+    SGPBroadphasePairIter it;
+    SGP_BroadphasePairsBegin(&it);
+    u16 a, b;
+    int pairs = 0;
+    bool no_duplicates = true;
+    while (SGP_BroadphaseNextPair(&bp, &it, &a, &b)) {
+        u16 lo = a < b ? a : b, hi = a < b ? b : a;
+        if (found[lo][hi]) no_duplicates = false;
+        found[lo][hi] = true;
+        pairs++;
+    }
+    bool pairs_match = (pairs == brute_pairs);
+    for (int i = 0; i < BOX_COUNT; i++)
+        for (int j = i + 1; j < BOX_COUNT; j++)
+            if (found[i][j] != brute[i][j]) pairs_match = false;
+    print_test_result("Pairs match brute force", true, pairs_match && brute_pairs > 0);
+    print_test_result("Pairs reported once", true, no_duplicates);
+
+    // A zeroed iterator starts like SGP_BroadphasePairsBegin: entry 0 is not paired with itself
+    static SGPBroadphase small;
+    SGPBox first = { 0, 0, 16, 16 }, second = { 8, 8, 16, 16 };
+    SGP_BroadphaseClear(&small, 0, 0);
+    SGP_BroadphaseInsert(&small, &first, 7);
+    SGP_BroadphaseInsert(&small, &second, 9);
+    SGPBroadphasePairIter zeroed = {0};
+    int zeroed_pairs = 0;
+    bool self_pair = false;
+    while (SGP_BroadphaseNextPair(&small, &zeroed, &a, &b)) {
+        if (a == b) self_pair = true;
+        zeroed_pairs++;
+    }
+    print_test_result("Zeroed iterator finds the one pair", true, zeroed_pairs == 1 && !self_pair);
+
+    // Query returns each overlapping box once
+    u16 ids[BOX_COUNT];
+    bool query_match = true;
+    for (int i = 0; i < BOX_COUNT && query_match; i++) {
+        u16 n = SGP_BroadphaseQuery(&bp, &boxes[i], ids, BOX_COUNT);
+        int expected = 0;
+        for (int j = 0; j < BOX_COUNT; j++) if (brute[i][j]) expected++;
+        if (n != expected) query_match = false;
+        for (u16 k = 0; k < n; k++) if (!brute[i][ids[k]]) query_match = false;
+    }
+    print_test_result("Queries match brute force", true, query_match);
+
+    // Entry pool exhaustion is reported and leaves the grid consistent
+    SGP_BroadphaseClear(&bp, 0, 0);
+    SGPBox big = { 0, 0, 320, 224 };
+    int accepted = 0;
+    for (int i = 0; i < 10; i++)
+        if (SGP_BroadphaseInsert(&bp, &big, (u16)i)) accepted++;
+    print_test_result("Full grid rejects inserts", true, accepted == SGP_BROADPHASE_MAX_ENTRIES / SGP_BROADPHASE_CELLS);
+}
+
+// Typed level: 0 empty, 1 solid, 2 one-way, 3 slope rising right, 4 spikes (solid hazard), 5 lava
+static const u8 slope_up_heights[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+static const SGPTileType typed_tiles[] = {
+    { 0, NULL },
+    { SGP_TILE_SOLID, NULL },
+    { SGP_TILE_ONE_WAY, NULL },
+    { SGP_TILE_SLOPE, slope_up_heights },
+    { SGP_TILE_SOLID | SGP_TILE_HAZARD, NULL },
+    { SGP_TILE_HAZARD, NULL },
+};
+static const u8 typed_level_data[] = {
+    1, 0, 0, 0, 0, 0, 0, 1,  // Row 0
+    1, 0, 0, 0, 0, 0, 0, 1,  // Row 1
+    1, 0, 0, 2, 2, 0, 0, 1,  // Row 2: one-way platform
+    1, 0, 0, 0, 0, 0, 0, 1,  // Row 3
+    1, 0, 0, 0, 3, 1, 5, 1,  // Row 4: slope, block, lava
+    1, 1, 1, 1, 1, 1, 4, 1   // Row 5: floor with spikes under the lava
+};
+
+void test_typed_tiles() {
+    printf("\n=== Typed Tile Tests ===\n");
+    SGPLevelCollisionData level = {
+        .row_length = 8,
+        .data_length = sizeof(typed_level_data),
+        .collision_data = typed_level_data,
+        .tile_types = typed_tiles
+    };
+    SGP_LevelCollisionPrepare(&level, NULL);
+
+    // Only SGP_TILE_SOLID blocks tile and edge queries
+    print_test_result("One-way tile not solid", false, SGP_TileIsSolidXY(&level, 3, 2, true, true));
+    print_test_result("Slope tile not solid", false, SGP_TileIsSolidXY(&level, 4, 4, true, true));
+    print_test_result("Solid type is solid", true, SGP_TileIsSolidXY(&level, 5, 4, true, true));
+    print_test_result("Spikes type is solid", true, SGP_TileIsSolidXY(&level, 6, 5, true, true));
+    print_test_result("Column span skips slope", false, SGP_TileColumnSpanIsSolid(&level, 4, 1, 4, true, false));
+
+    // One-way: land from above, pass through from below and from the side
+    fix32 x = FIX32(48), y = FIX32(0);
+    u16 flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(40), 16, 16);
+    print_test_result("Fall lands on one-way top", true, flags == COLLIDE_DOWN && y == FIX32(16));
+    x = FIX32(48); y = FIX32(48);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(-40), 16, 16);
+    print_test_result("Jump passes up through one-way", true, flags == 0 && y == FIX32(8));
+    x = FIX32(16); y = FIX32(32);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(40), FIX32(0), 16, 16);
+    print_test_result("Walk passes through one-way", true, flags == 0 && x == FIX32(56));
+
+    // Slope: surface under the center column (x 72 -> column 8 -> height 9 -> y 71)
+    print_test_result("Floor height from slope table", true, SGP_LevelFloorY(&level, 64, 56, 16, 16) == 71);
+    print_test_result("Floor height of flat ground", true, SGP_LevelFloorY(&level, 32, 64, 16, 16) == 80);
+    print_test_result("No floor in open air", true, SGP_LevelFloorY(&level, 32, 8, 16, 16) == SGP_NO_FLOOR);
+    x = FIX32(64); y = FIX32(40);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(30), 16, 16);
+    print_test_result("Fall lands on slope surface", true, flags == COLLIDE_DOWN && y == FIX32(55));
+
+    // Walking uphill with gravity follows the surface instead of hitting a wall
+    x = FIX32(48); y = FIX32(64);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(8), FIX32(1), 16, 16);
+    print_test_result("Uphill step lifts onto slope", true, flags == COLLIDE_DOWN && x == FIX32(56) && y == FIX32(63));
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(8), FIX32(1), 16, 16);
+    print_test_result("Second uphill step follows slope", true, flags == COLLIDE_DOWN && x == FIX32(64) && y == FIX32(55));
+
+    // Post-move DOWN checks resolve the same tables
+    print_test_result("Above slope surface clear", false, SGP_PlayerLevelCollision(0, 64, 55, 16, 16, &level, SGP_DIR_DOWN));
+    print_test_result("On slope surface collides", true, SGP_PlayerLevelCollision(0, 64, 56, 16, 16, &level, SGP_DIR_DOWN));
+    print_test_result("One-way top within depth", true, SGP_LevelEdgeIsSolid(&level, 48, 17, 16, 16, SGP_DIR_DOWN));
+    print_test_result("Deep inside one-way passes", false, SGP_LevelEdgeIsSolid(&level, 48, 26, 16, 16, SGP_DIR_DOWN));
+    print_test_result("Up edge ignores one-way", false, SGP_LevelEdgeIsSolid(&level, 48, 40, 16, 16, SGP_DIR_UP));
+
+    // Hazards: lava overlapped and spikes underfoot both report COLLIDE_HAZARD
+    print_test_result("Box tile flags see lava", true,
+                      FLAG_IS_ACTIVE(SGP_LevelBoxTileFlags(&level, 96, 64, 16, 16), SGP_TILE_HAZARD));
+    x = FIX32(96); y = FIX32(64);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(4), 16, 16);
+    print_test_result("Landing on spikes reports hazard", true, flags == (COLLIDE_DOWN | COLLIDE_HAZARD) && y == FIX32(64));
+    x = FIX32(32); y = FIX32(64);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(2), 16, 16);
+    print_test_result("Safe floor reports no hazard", true, flags == COLLIDE_DOWN);
+}
+
+// Mask from four single-direction edge checks, the reference for SGP_LevelContactMask
+static u16 edge_reference_mask(const SGPLevelCollisionData* level, s16 x, s16 y, u16 w, u16 h) {
+    u16 mask = 0;
+    if (SGP_LevelEdgeIsSolid(level, x, y, w, h, SGP_DIR_LEFT)) mask |= COLLIDE_LEFT;
+    if (SGP_LevelEdgeIsSolid(level, x, y, w, h, SGP_DIR_RIGHT)) mask |= COLLIDE_RIGHT;
+    if (SGP_LevelEdgeIsSolid(level, x, y, w, h, SGP_DIR_UP)) mask |= COLLIDE_UP;
+    if (SGP_LevelEdgeIsSolid(level, x, y, w, h, SGP_DIR_DOWN)) mask |= COLLIDE_DOWN;
+    return mask;
+}
+
+// Sweeps box positions (including partly OOB ones) and sizes over a level
+static bool contact_masks_match(const SGPLevelCollisionData* level, s16 width_px, s16 height_px) {
+    static const u16 sizes[][2] = { { 16, 16 }, { 8, 24 }, { 32, 48 }, { 40, 8 } };
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (s16 y = -20; y < height_px + 4; y += 3) {
+            for (s16 x = -20; x < width_px + 4; x += 5) {
+                if (SGP_LevelContactMask(level, x, y, sizes[s][0], sizes[s][1]) !=
+                    edge_reference_mask(level, x, y, sizes[s][0], sizes[s][1])) {
+                    printf("  mismatch at %d,%d size %ux%u\n", x, y, sizes[s][0], sizes[s][1]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void test_contact_masks() {
+    printf("\n=== Contact Mask Tests ===\n");
+
+    // Every sampled box agrees with the four single-direction queries
+    print_test_result("Byte level masks match edges", true, contact_masks_match(&test_level, 128, 128));
+    static u16 packed_rows[8];
+    SGP_PackCollisionRows(test_level_data, 8, 8, packed_rows);
+    SGPLevelCollisionData packed_level = { .row_length = 8, .data_length = 64, .collision_data = test_level_data, .solid_bits = packed_rows };
+    print_test_result("Packed level masks match edges", true, contact_masks_match(&packed_level, 128, 128));
+    SGPLevelCollisionData typed_level = {
+        .row_length = 8,
+        .data_length = sizeof(typed_level_data),
+        .collision_data = typed_level_data,
+        .tile_types = typed_tiles
+    };
+    print_test_result("Typed level masks match edges", true, contact_masks_match(&typed_level, 128, 96));
+
+    // Edges include the corner tiles, so a box pushed into the top-left corner reports every side
+    u16 mask = SGP_LevelContactMask(&test_level, 15, 15, 16, 16);
+    print_test_result("Corner box mask", true, mask == COLLIDE_SIDES);
+    mask = SGP_LevelContactMask(&test_level, 16, 16, 16, 16);
+    print_test_result("Free box mask empty", true, mask == 0);
+
+    // Context cache holds the whole mask keyed by position
+    SGPCollisionContext ctx;
+    SGP_CollisionContextInit(&ctx, &test_level, 16, 16);
+    ctx.x = 15; ctx.y = 16;
+    mask = SGP_ContextContactMask(&ctx);
+    print_test_result("Context mask resolves all sides", true,
+                      mask == (COLLIDE_LEFT | COLLIDE_UP | COLLIDE_DOWN) && ctx.known == COLLIDE_SIDES);
+    print_test_result("Direction query served from mask", true,
+                      SGP_ContextLevelCollision(&ctx, SGP_DIR_LEFT) && !SGP_ContextLevelCollision(&ctx, SGP_DIR_RIGHT));
+    ctx.flags = COLLIDE_RIGHT; // Poison the cache: an unchanged position must not re-query
+    print_test_result("Unchanged position returns cached mask", true, SGP_ContextContactMask(&ctx) == COLLIDE_RIGHT);
+    ctx.x = 16;
+    print_test_result("Moved context recomputes mask", true, SGP_ContextContactMask(&ctx) == 0);
+
+    // Per-player variant shares SGP_PlayerLevelCollision's cache (one-row box pushed into the right wall)
+    const u16 wall_mask = COLLIDE_RIGHT | COLLIDE_UP | COLLIDE_DOWN;
+    mask = SGP_PlayerLevelContacts(1, 97, 96, 16, 16, &test_level);
+    print_test_result("Player contacts at right wall", true, mask == wall_mask);
+    print_test_result("Player direction query agrees", true,
+                      SGP_PlayerLevelCollision(1, 97, 96, 16, 16, &test_level, SGP_DIR_RIGHT) &&
+                      !SGP_PlayerLevelCollision(1, 97, 96, 16, 16, &test_level, SGP_DIR_LEFT));
+    print_test_result("Uncached index contacts", true,
+                      SGP_PlayerLevelContacts(SGP_MAX_PLAYER_COUNT, 97, 96, 16, 16, &test_level) == wall_mask);
+
+    // Typed floors show up in the DOWN bit
+    mask = SGP_LevelContactMask(&typed_level, 64, 56, 16, 16);
+    print_test_result("Typed mask lands on slope", true, mask == COLLIDE_DOWN);
+}
+
+// Streamed level over 64K tiles: 2048x40 tiles (256x5 blocks), floor, and a wall every 64 columns
+#define BIG_LEVEL_W 2048
+#define BIG_LEVEL_H 40
+static u8 big_level_data[BIG_LEVEL_W * BIG_LEVEL_H];
+static u8 big_level_rle[BIG_LEVEL_W * BIG_LEVEL_H * 2];
+static u32 big_level_offsets[(BIG_LEVEL_W / 8) * (BIG_LEVEL_H / 8)];
+
+static bool big_level_tile(s16 x, s16 y) {
+    return y == BIG_LEVEL_H - 1 || ((x & 63) == 32 && y >= BIG_LEVEL_H - 8);
+}
+
+static void fill_big_level(void) {
+    for (s16 y = 0; y < BIG_LEVEL_H; y++)
+        for (s16 x = 0; x < BIG_LEVEL_W; x++)
+            big_level_data[(u32)y * BIG_LEVEL_W + x] = big_level_tile(x, y) ? SOLID_TILE : 0;
+}
+
+// Every tile of the resident window matches the source, every other tile reads empty
+static bool stream_window_matches(const SGPLevelCollisionData* level, const SGPCollisionStream* stream) {
+    for (s16 y = 0; y < BIG_LEVEL_H; y++) {
+        for (s16 x = 0; x < BIG_LEVEL_W; x++) {
+            const s16 bx = x >> 3, by = y >> 3;
+            const bool resident = bx >= stream->origin_x && bx < stream->origin_x + SGP_STREAM_WINDOW_W &&
+                                  by >= stream->origin_y && by < stream->origin_y + SGP_STREAM_WINDOW_H;
+            if (SGP_TileIsSolidXY(level, x, y, true, true) != (resident && big_level_tile(x, y))) {
+                printf("  mismatch at tile %d,%d\n", x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Every direction of every sampled box agrees between two levels
+static bool edges_match(const SGPLevelCollisionData* a, const SGPLevelCollisionData* b, s16 width_px, s16 height_px) {
+    static const SGPMovementDirection dirs[] = { SGP_DIR_LEFT, SGP_DIR_RIGHT, SGP_DIR_UP, SGP_DIR_DOWN, 0 };
+    for (s16 y = -20; y < height_px + 4; y += 3) {
+        for (s16 x = -20; x < width_px + 4; x += 5) {
+            for (unsigned d = 0; d < sizeof(dirs) / sizeof(dirs[0]); d++) {
+                if (SGP_LevelEdgeIsSolid(a, x, y, 16, 24, dirs[d]) != SGP_LevelEdgeIsSolid(b, x, y, 16, 24, dirs[d])) {
+                    printf("  mismatch at %d,%d dir %d\n", x, y, dirs[d]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void test_streamed_levels() {
+    printf("\n=== Streamed Level Tests ===\n");
+
+    // One-block level: streamed queries match the byte level exactly
+    static u8 small_rle[128];
+    static u32 small_offsets[1];
+    static SGPCollisionStream small_stream;
+    const u32 small_size = SGP_CollisionStreamEncode(test_level_data, 8, 8, small_rle, small_offsets);
+    SGPLevelCollisionData small = {0};
+    print_test_result("Stream init", true, SGP_CollisionStreamInit(&small, &small_stream, small_rle, small_offsets, 1, 1));
+    print_test_result("Nothing resident before update", false, SGP_TileIsSolidXY(&small, 0, 0, false, false));
+    print_test_result("Update decodes the only block", true,
+                      SGP_CollisionStreamUpdate(&small_stream, 0, 0, 0) == 1 && !small_stream.pending);
+    print_test_result("RLE smaller than raw", true, small_size < sizeof(test_level_data));
+    print_test_result("Streamed edges match byte level", true, edges_match(&small, &test_level, 128, 128));
+    print_test_result("Streamed masks match edges", true, contact_masks_match(&small, 128, 128));
+
+    // Typed levels stream too: pad the 8x6 typed level to one block
+    static u8 typed_block[64];
+    static u8 typed_rle[128];
+    static u32 typed_offsets[1];
+    static SGPCollisionStream typed_stream;
+    for (unsigned i = 0; i < sizeof(typed_level_data); i++) typed_block[i] = typed_level_data[i];
+    SGP_CollisionStreamEncode(typed_block, 8, 8, typed_rle, typed_offsets);
+    SGPLevelCollisionData typed = { .tile_types = typed_tiles };
+    SGP_CollisionStreamInit(&typed, &typed_stream, typed_rle, typed_offsets, 1, 1);
+    SGP_CollisionStreamUpdate(&typed_stream, 0, 0, 0);
+    SGPLevelCollisionData typed_raw = { .row_length = 8, .data_length = 64, .collision_data = typed_block, .tile_types = typed_tiles };
+    bool floors_match = true;
+    for (s16 x = 0; x < 112; x += 3) {
+        for (s16 y = 0; y < 80; y += 5) {
+            if (SGP_LevelFloorY(&typed, x, y, 16, 16) != SGP_LevelFloorY(&typed_raw, x, y, 16, 16) ||
+                SGP_LevelBoxTileFlags(&typed, x, y, 16, 16) != SGP_LevelBoxTileFlags(&typed_raw, x, y, 16, 16))
+                floors_match = false;
+        }
+    }
+    print_test_result("Typed floors and flags match", true, floors_match);
+    print_test_result("Typed streamed edges match", true, edges_match(&typed, &typed_raw, 128, 80));
+
+    // 81920-tile level: beyond a u16 data_length
+    fill_big_level();
+    const u32 big_size = SGP_CollisionStreamEncode(big_level_data, BIG_LEVEL_W, BIG_LEVEL_H, big_level_rle, big_level_offsets);
+    static SGPCollisionStream stream;
+    SGPLevelCollisionData big = {0};
+    print_test_result("Big level init", true,
+                      SGP_CollisionStreamInit(&big, &stream, big_level_rle, big_level_offsets, BIG_LEVEL_W / 8, BIG_LEVEL_H / 8));
+    print_test_result("Big level layout", true, big.row_length == BIG_LEVEL_W && SGP_LevelTotalRows(&big) == BIG_LEVEL_H);
+    print_test_result("Big level compresses 10x", true, big_size * 10 < sizeof(big_level_data));
+
+    const s16 view_y = BIG_LEVEL_H * 16 - 224;
+    u16 decoded = SGP_CollisionStreamUpdate(&stream, 0, view_y, 0);
+    print_test_result("First update fills the window", true,
+                      decoded == SGP_STREAM_WINDOW_W * SGP_STREAM_WINDOW_H && stream.origin_x == 0 && stream.origin_y == 1);
+    print_test_result("Window tiles match source", true, stream_window_matches(&big, &stream));
+    print_test_result("Far tile not resident", false, SGP_TileIsSolidXY(&big, 2016, BIG_LEVEL_H - 1, true, true));
+
+    // Steady scroll: only the column of blocks entering the window is decoded
+    SGP_CollisionStreamUpdate(&stream, 512, view_y, 0);
+    decoded = SGP_CollisionStreamUpdate(&stream, 640, view_y, 0);
+    print_test_result("Scroll by one block decodes one column", true, decoded == SGP_STREAM_WINDOW_H && stream.origin_x == 2);
+    print_test_result("Unchanged view decodes nothing", true, SGP_CollisionStreamUpdate(&stream, 650, view_y, 0) == 0);
+
+    // A tight budget resolves the blocks under the view first
+    const s16 far_x = 31000;
+    decoded = SGP_CollisionStreamUpdate(&stream, far_x, view_y, 6);
+    print_test_result("Budget caps decoding", true, decoded == 6 && stream.pending);
+    print_test_result("On-screen blocks decoded first", true,
+                      SGP_TileIsSolidXY(&big, (far_x >> 4) + 2, BIG_LEVEL_H - 1, true, true));
+    SGP_CollisionStreamUpdate(&stream, far_x, view_y, 0);
+    print_test_result("Next update completes the window", true, !stream.pending && stream_window_matches(&big, &stream));
+
+    // Movement past tile 65535 lands on the streamed floor
+    fix32 x = FIX32(31100), y = FIX32(view_y);
+    u16 flags = SGP_MoveAndCollide(&big, &x, &y, FIX32(0), FIX32(200), 16, 16);
+    print_test_result("Fall far right lands on floor", true, flags == COLLIDE_DOWN && y == FIX32((BIG_LEVEL_H - 2) * 16));
+    x = FIX32(31000);
+    flags = SGP_MoveAndCollide(&big, &x, &y, FIX32(300), FIX32(0), 16, 16);
+    print_test_result("Walk stops at streamed wall", true, flags == COLLIDE_RIGHT && x == FIX32(1952 * 16 - 16));
+
+    SGPLevelCollisionData too_wide = {0};
+    print_test_result("Oversized block grid rejected", false,
+                      SGP_CollisionStreamInit(&too_wide, &stream, big_level_rle, big_level_offsets, SGP_COLLISION_MAX_BLOCKS + 1, 1));
+}
+
+void test_block_levels() {
+    printf("\n=== Deduplicated Block Level Tests ===\n");
+
+    // 4x2 blocks built from three distinct patterns: the room, empty and solid
+    static u8 tiles[32 * 16];
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            const int block = ((y >> 3) << 2) + (x >> 3);
+            const u8 room = test_level_data[((y & 7) << 3) + (x & 7)];
+            tiles[y * 32 + x] = (block == 1 || block == 4 || block == 6) ? 0 : (block == 7) ? SOLID_TILE : room;
+        }
+    }
+    static SGPBlockIndex map[2 << 2];
+    static u8 patterns[8 * 64];
+    const u16 count = SGP_LevelBlocksBuild(tiles, 32, 16, map, 2, patterns, 8);
+    print_test_result("Repeated blocks share patterns", true, count == 3 && map[0] == map[2] && map[2] == map[3]);
+    print_test_result("Capacity overflow reported", true, SGP_LevelBlocksBuild(tiles, 32, 16, map, 2, patterns, 2) == 0);
+    SGP_LevelBlocksBuild(tiles, 32, 16, map, 2, patterns, 8);
+
+    // Room, empty, room: the repeat needs no free slot, so two patterns fit exactly
+    static u8 repeat_tiles[24 * 8];
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 24; x++)
+            repeat_tiles[y * 24 + x] = (x >> 3) == 1 ? 0 : test_level_data[(y << 3) + (x & 7)];
+    static SGPBlockIndex repeat_map[4];
+    static u8 repeat_patterns[2 * 64];
+    print_test_result("Full capacity reuses patterns", true,
+                      SGP_LevelBlocksBuild(repeat_tiles, 24, 8, repeat_map, 2, repeat_patterns, 2) == 2 &&
+                      repeat_map[0] == 0 && repeat_map[1] == 1 && repeat_map[2] == 0);
+
+    // 257 distinct blocks: one more than a u8 block map can index
+    static u8 distinct_tiles[257 * 8 * 8];
+    for (int i = 0; i < 257 * 8; i++) {
+        distinct_tiles[i] = (u8)((i >> 3) & 0xFF);
+        distinct_tiles[257 * 8 + i] = (u8)((i >> 3) >> 8);
+    }
+    static SGPBlockIndex distinct_map[512];
+    static u8 distinct_patterns[300 * 64];
+    const u16 distinct = SGP_LevelBlocksBuild(distinct_tiles, 257 * 8, 8, distinct_map, 9, distinct_patterns, 300);
+#ifdef SGP_BLOCK_INDEX_U8
+    print_test_result("257 patterns rejected by u8 map", true, distinct == 0);
+#else
+    print_test_result("257 patterns fit u16 map", true, distinct == 257 && distinct_map[256] == 256);
+#endif
+
+    SGPLevelCollisionData blocks = {0};
+    print_test_result("Block level init", true, SGP_LevelBlocksInit(&blocks, map, 2, patterns, 4, 2));
+    print_test_result("Stride narrower than the level rejected", false,
+                      SGP_LevelBlocksInit(&(SGPLevelCollisionData){0}, map, 1, patterns, 4, 2));
+    SGPLevelCollisionData raw = { .row_length = 32, .data_length = sizeof(tiles), .collision_data = tiles };
+
+    bool tiles_match = true;
+    for (s16 y = -1; y <= 16; y++)
+        for (s16 x = -1; x <= 32; x++)
+            if (SGP_TileIsSolidXY(&blocks, x, y, true, false) != SGP_TileIsSolidXY(&raw, x, y, true, false))
+                tiles_match = false;
+    print_test_result("Block tiles match byte level", true, tiles_match);
+    print_test_result("Block edges match byte level", true, edges_match(&blocks, &raw, 512, 256));
+    print_test_result("Block masks match edges", true, contact_masks_match(&blocks, 512, 256));
+
+    fix32 x = FIX32(300), y = FIX32(140);
+    u16 flags = SGP_MoveAndCollide(&blocks, &x, &y, FIX32(200), FIX32(0), 16, 16);
+    print_test_result("Move stops at solid block", true, flags == COLLIDE_RIGHT && x == FIX32(384 - 16));
+
+    // Typed patterns resolve through the same table as byte levels
+    SGPLevelCollisionData typed = blocks;
+    typed.tile_types = typed_tiles;
+    SGPLevelCollisionData typed_raw = raw;
+    typed_raw.tile_types = typed_tiles;
+    print_test_result("Typed block floor matches", true,
+                      SGP_LevelFloorY(&typed, 48, 64, 16, 16) == SGP_LevelFloorY(&typed_raw, 48, 64, 16, 16) &&
+                      SGP_LevelFloorY(&typed, 48, 64, 16, 16) == 80);
+
+    // 81920-tile level in a handful of patterns
+    fill_big_level();
+    static SGPBlockIndex big_map[(BIG_LEVEL_H / 8) << 8];
+    static u8 big_patterns[16 * 64];
+    const u16 big_count = SGP_LevelBlocksBuild(big_level_data, BIG_LEVEL_W, BIG_LEVEL_H, big_map, 8, big_patterns, 16);
+    SGPLevelCollisionData big = {0};
+    SGP_LevelBlocksInit(&big, big_map, 8, big_patterns, BIG_LEVEL_W / 8, BIG_LEVEL_H / 8);
+    print_test_result("Long level dedups to 3 patterns", true, big_count == 3);
+    bool big_match = true;
+    for (s16 ty = 0; ty < BIG_LEVEL_H; ty++)
+        for (s16 tx = 0; tx < BIG_LEVEL_W; tx++)
+            if (SGP_TileIsSolidXY(&big, tx, ty, true, true) != big_level_tile(tx, ty))
+                big_match = false;
+    print_test_result("Long level tiles match source", true, big_match);
+}
+
+// First solid tile along a densely sampled segment; false if the samples jump tiles diagonally
+// (the ray clips a corner, where the DDA deliberately crosses the column first)
+static bool sampled_first_solid(const SGPLevelCollisionData* level, const SGPRay* ray, bool* hit, s16* tile_x, s16* tile_y) {
+    const long samples = 4096;
+    s16 last_x = ray->x0 >> 4, last_y = ray->y0 >> 4;
+    *hit = false;
+    for (long i = 0; i <= samples; i++) {
+        // Exact position in 1/samples pixels, floored to a tile like the continuous ray
+        const long px = ray->x0 * samples + (long)(ray->x1 - ray->x0) * i;
+        const long py = ray->y0 * samples + (long)(ray->y1 - ray->y0) * i;
+        const s16 tx = (s16)((px >= 0 ? px : px - (16 * samples - 1)) / (16 * samples));
+        const s16 ty = (s16)((py >= 0 ? py : py - (16 * samples - 1)) / (16 * samples));
+        if (tx != last_x && ty != last_y) return false;
+        last_x = tx; last_y = ty;
+        if (SGP_TileIsSolidXY(level, tx, ty, true, true)) {
+            *hit = true; *tile_x = tx; *tile_y = ty;
+            return true;
+        }
+    }
+    return true;
+}
+
+static bool rays_match_sampling(const SGPLevelCollisionData* level) {
+    u16 seed = 0x1234;
+    for (int n = 0; n < 2000; n++) {
+        seed ^= seed << 7; seed ^= seed >> 9; seed ^= seed << 8;
+        const SGPRay ray = { (s16)(16 + (seed & 63)), (s16)(16 + ((seed >> 6) & 63)),
+                             (s16)(((seed >> 3) & 127) - 8), (s16)(((seed >> 9) & 127) - 8) };
+        bool expected_hit;
+        s16 expected_x = 0, expected_y = 0;
+        if (!sampled_first_solid(level, &ray, &expected_hit, &expected_x, &expected_y)) continue;
+        SGPRayHit hit;
+        const bool got = SGP_LevelRaycast(level, &ray, &hit);
+        if (got != expected_hit || (got && (hit.tile_x != expected_x || hit.tile_y != expected_y))) {
+            printf("  mismatch for ray %d,%d -> %d,%d\n", ray.x0, ray.y0, ray.x1, ray.y1);
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_raycasts() {
+    printf("\n=== Raycast Tests ===\n");
+    SGPRayHit hit;
+
+    SGPRay ray = { 24, 24, 200, 24 };
+    bool got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Ray right hits wall", true, got && hit.tile_x == 7 && hit.tile_y == 1 && hit.side == COLLIDE_RIGHT);
+    print_test_result("Right hit point and distance", true, hit.x == 112 && hit.y == 24 && hit.distance == 88);
+
+    ray = (SGPRay){ 100, 24, 0, 24 };
+    got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Ray left enters last wall pixel", true,
+                      got && hit.tile_x == 0 && hit.side == COLLIDE_LEFT && hit.x == 15 && hit.distance == 85);
+
+    ray = (SGPRay){ 24, 24, 24, 200 };
+    got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Ray down hits floor", true, got && hit.tile_x == 1 && hit.tile_y == 7 &&
+                      hit.side == COLLIDE_DOWN && hit.y == 112);
+
+    ray = (SGPRay){ 20, 20, 100, 20 };
+    got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Clear ray reaches its end", false, got);
+    print_test_result("Clear ray reports end point", true, hit.x == 100 && hit.y == 20 && hit.tile_x == 6 && hit.distance == 80);
+
+    ray = (SGPRay){ 5, 5, 50, 50 };
+    got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Origin in wall hits at distance 0", true, got && hit.side == 0 && hit.distance == 0);
+
+    ray = (SGPRay){ 24, 24, 100, 90 };
+    got = SGP_LevelRaycast(&test_level, &ray, &hit);
+    print_test_result("Diagonal hit point inside hit tile", true, got && (hit.x >> 4) == hit.tile_x && (hit.y >> 4) == hit.tile_y);
+    print_test_result("Inner wall blocks line of sight", false, SGP_LevelLineOfSight(&test_level, 24, 24, 100, 90));
+    print_test_result("Corridor line of sight", true, SGP_LevelLineOfSight(&test_level, 20, 100, 100, 104));
+
+    // Every layout agrees with dense sampling (byte rows walk the index, others go through TileIsSolidXY)
+    print_test_result("Byte level rays match sampling", true, rays_match_sampling(&test_level));
+    static u16 packed_rows[8];
+    SGP_PackCollisionRows(test_level_data, 8, 8, packed_rows);
+    SGPLevelCollisionData packed_level = { .row_length = 8, .data_length = 64, .collision_data = test_level_data, .solid_bits = packed_rows };
+    print_test_result("Packed level rays match sampling", true, rays_match_sampling(&packed_level));
+    SGPLevelCollisionData prepared = test_level;
+    SGP_LevelCollisionPrepare(&prepared, NULL);
+    print_test_result("Prepared level rays match sampling", true, rays_match_sampling(&prepared));
+
+    // Batch shares the setup and matches single casts
+    const SGPRay rays[3] = { { 24, 24, 200, 24 }, { 20, 20, 100, 20 }, { 24, 24, 24, 200 } };
+    SGPRayHit hits[3];
+    const u16 hit_count = SGP_LevelRaycastBatch(&test_level, rays, hits, 3);
+    bool same = true;
+    for (int i = 0; i < 3; i++) {
+        SGP_LevelRaycast(&test_level, &rays[i], &hit);
+        if (hit.hit != hits[i].hit || hit.x != hits[i].x || hit.y != hits[i].y || hit.tile_x != hits[i].tile_x)
+            same = false;
+    }
+    print_test_result("Batch counts hits", true, hit_count == 2);
+    print_test_result("Batch matches single casts", true, same);
+}
+
+// Unsorted on purpose: a door spanning two tiles, a spike row and pickups scattered over 64x16 tiles
+static SGPTrigger test_triggers[] = {
+    { 3, 10, 1, 100 }, { 2, 10, 1, 100 },  // Door, tiles (10, 2) and (10, 3)
+    { 5, 4, 2, 0 }, { 5, 5, 2, 0 }, { 5, 6, 2, 0 },  // Spikes
+    { 0, 0, 3, 7 }, { 15, 63, 3, 8 }, { 2, 11, 3, 9 },  // Pickups
+    { 9, 30, 4, 1 },  // Checkpoint
+};
+#define TEST_TRIGGER_COUNT (sizeof(test_triggers) / sizeof(test_triggers[0]))
+
+// Brute-force reference: entries whose tile lies inside the box tile span
+static u16 scan_triggers(const SGPTriggerLayer* layer, const SGPBox* box) {
+    u16 n = 0;
+    for (u16 i = 0; i < layer->count; i++) {
+        const SGPTrigger* t = &layer->triggers[i];
+        if (t->tile_x >= (box->x >> 4) && t->tile_x <= ((box->x + box->w - 1) >> 4) &&
+            t->tile_y >= (box->y >> 4) && t->tile_y <= ((box->y + box->h - 1) >> 4))
+            n++;
+    }
+    return n;
+}
+
+void test_trigger_layer() {
+    printf("\n=== Trigger Layer Tests ===\n");
+    SGPTriggerLayer layer;
+    print_test_result("Unsorted entries rejected", false, SGP_TriggerLayerInit(&layer, test_triggers, TEST_TRIGGER_COUNT));
+    print_test_result("Rejected layer is empty", true, layer.count == 0);
+    SGP_TriggerSort(test_triggers, TEST_TRIGGER_COUNT);
+    print_test_result("Sorted entries accepted", true, SGP_TriggerLayerInit(&layer, test_triggers, TEST_TRIGGER_COUNT));
+
+    u16 i = SGP_TriggerLayerFind(&layer, 6, 5);
+    print_test_result("Find spike tile", true, i != SGP_TRIGGER_NONE && test_triggers[i].type == 2);
+    print_test_result("Find empty tile", true, SGP_TriggerLayerFind(&layer, 7, 5) == SGP_TRIGGER_NONE);
+    i = SGP_TriggerLayerFind(&layer, 63, 15);
+    print_test_result("Find last tile", true, i == TEST_TRIGGER_COUNT - 1 && test_triggers[i].id == 8);
+
+    // 32x32 box on both door tiles and the pickup next to the top one
+    u16 out[8];
+    SGPBox box = { 160, 32, 32, 32 };
+    u16 n = SGP_TriggerLayerQuery(&layer, &box, out, 8);
+    print_test_result("Box over door and pickup", true, n == 3 && test_triggers[out[0]].id == 100 &&
+                      test_triggers[out[1]].id == 9 && test_triggers[out[2]].id == 100);
+    print_test_result("Capacity limits results", true, SGP_TriggerLayerQuery(&layer, &box, out, 2) == 2);
+
+    box = (SGPBox){ 52, 80, 8, 8 };  // Inside tile (3, 5), left of the spikes
+    print_test_result("Box between triggers finds none", true, SGP_TriggerLayerQuery(&layer, &box, out, 8) == 0);
+    box = (SGPBox){ 79, 80, 2, 2 };  // Straddles tiles (4, 5) and (5, 5)
+    print_test_result("Box edge pixels pick both spikes", true, SGP_TriggerLayerQuery(&layer, &box, out, 8) == 2);
+
+    bool all_match = true;
+    for (u16 y = 0; y < 256; y += 7) {
+        for (u16 x = 0; x < 1024; x += 13) {
+            box = (SGPBox){ x, y, 24, 40 };
+            if (SGP_TriggerLayerQuery(&layer, &box, out, 8) != scan_triggers(&layer, &box))
+                all_match = false;
+        }
+    }
+    print_test_result("Queries match a full scan", true, all_match);
+
+    SGPTriggerLayer empty;
+    SGP_TriggerLayerInit(&empty, NULL, 0);
+    print_test_result("Empty layer finds nothing", true, SGP_TriggerLayerQuery(&empty, &box, out, 8) == 0 &&
+                      SGP_TriggerLayerFind(&empty, 0, 0) == SGP_TRIGGER_NONE);
+}
+
+// Reference BFS distances over test_level (-1 = unreachable)
+static void reference_distances(s16 target_x, s16 target_y, s16* dist) {
+    s16 queue[64];
+    u16 head = 0, tail = 0;
+    for (int i = 0; i < 64; i++) dist[i] = -1;
+    dist[target_y * 8 + target_x] = 0;
+    queue[tail++] = target_y * 8 + target_x;
+    while (head < tail) {
+        const s16 n = queue[head++];
+        const s16 next[4] = { n - 8, n + 8, (n & 7) ? n - 1 : -1, ((n & 7) != 7) ? n + 1 : -1 };
+        for (int k = 0; k < 4; k++) {
+            if (next[k] < 0 || next[k] >= 64 || test_level_data[next[k]] || dist[next[k]] >= 0) continue;
+            dist[next[k]] = dist[n] + 1;
+            queue[tail++] = next[k];
+        }
+    }
+}
+
+// Following the field from every reachable tile walks a shortest path to the target
+static bool flow_paths_are_shortest(const SGPFlowField* field, s16 target_x, s16 target_y) {
+    s16 dist[64];
+    reference_distances(target_x, target_y, dist);
+    for (s16 i = 0; i < 64; i++) {
+        s16 x = i & 7, y = i >> 3;
+        const u8 step = SGP_FlowFieldStep(field, x, y);
+        if (dist[i] <= 0) {
+            if (step != 0) return false;  // Target, wall or unreachable tile
+            continue;
+        }
+        for (s16 d = dist[i]; d > 0; d--) {
+            const u8 s = SGP_FlowFieldStep(field, x, y);
+            if (s == SGP_DIR_UP) y--;
+            else if (s == SGP_DIR_DOWN) y++;
+            else if (s == SGP_DIR_LEFT) x--;
+            else if (s == SGP_DIR_RIGHT) x++;
+            else return false;
+            if (dist[y * 8 + x] != d - 1) return false;
+        }
+    }
+    return true;
+}
+
+void test_flow_field() {
+    printf("\n=== Flow Field Tests ===\n");
+    static SGPFlowField field;
+    SGP_FlowFieldInit(&field, &test_level);
+    print_test_result("No step before the first build", true, SGP_FlowFieldStep(&field, 6, 6) == 0);
+    print_test_result("Target outside level rejected", false, SGP_FlowFieldSetTarget(&field, 8, 1));
+
+    // Time-sliced: 20 passable tiles, two per frame
+    SGP_FlowFieldSetTarget(&field, 1, 1);
+    u16 frames = 0;
+    while (field.building && frames < 100) {
+        if (SGP_FlowFieldUpdate(&field, 2) > 2) break;
+        frames++;
+    }
+    print_test_result("Build spreads over frames", true, frames == 10 && field.ready);
+    print_test_result("Steps follow shortest paths", true, flow_paths_are_shortest(&field, 1, 1));
+    print_test_result("Corridor corner steps up", true, SGP_FlowFieldStep(&field, 1, 6) == SGP_DIR_UP);
+    print_test_result("Closed room unreachable", true, SGP_FlowFieldStep(&field, 3, 3) == 0);
+    print_test_result("Same tile does not rebuild", true, SGP_FlowFieldSetTarget(&field, 1, 1) && !field.building);
+
+    // Finished field stays readable while the next one builds
+    SGP_FlowFieldSetTarget(&field, 6, 6);
+    SGP_FlowFieldUpdate(&field, 3);
+    print_test_result("Old field readable during rebuild", true, field.building && SGP_FlowFieldStep(&field, 1, 6) == SGP_DIR_UP);
+
+    // A target change mid-build is queued and rebuilt right after publishing
+    SGP_FlowFieldSetTarget(&field, 6, 1);
+    SGP_FlowFieldUpdate(&field, 0);
+    print_test_result("Queued target builds after publish", true, field.ready && !field.building && field.target_x == 6 && field.target_y == 1);
+    print_test_result("Queued field is shortest", true, flow_paths_are_shortest(&field, 6, 1));
+
+    // Window smaller than the level: centered on the target, clamped to the level edge
+    static u8 open_data[64 * 8];
+    for (int i = 0; i < 64 * 8; i++) open_data[i] = (i < 64 || i >= 64 * 7) ? SOLID_TILE : 0;
+    SGPLevelCollisionData open_level = { .row_length = 64, .data_length = 64 * 8, .collision_data = open_data };
+    SGP_FlowFieldInit(&field, &open_level);
+    SGP_FlowFieldSetTarget(&field, 50, 4);
+    SGP_FlowFieldUpdate(&field, 0);
+    print_test_result("Window clamped to level", true, field.origin_x[field.front] == 64 - SGP_FLOW_W);
+    print_test_result("Window tile steps toward target", true, SGP_FlowFieldStep(&field, 40, 4) == SGP_DIR_RIGHT);
+    print_test_result("Tile outside window has no step", true, SGP_FlowFieldStep(&field, 10, 4) == 0);
+
+    // Scheduled build: the job keeps stepping until the field publishes, then yields
+    static SGPScheduler sched;
+    SGP_SchedulerInit(&sched);
+    SGP_FlowFieldSetTarget(&field, 20, 3);
+    SGP_SchedulerAdd(&sched, SGP_FlowFieldJobStep, &field, 0);
+    const u16 steps = SGP_SchedulerRun(&sched);
+    print_test_result("Scheduled job builds the field", true, field.ready && !field.building && field.target_x == 20);
+    print_test_result("Idle field job yields at once", true, steps > 1 && SGP_SchedulerRun(&sched) == 1);
+}
+
 int main() {
     printf("=== SGP Comprehensive Collision Test Suite ===\n");
     
@@ -218,6 +1201,19 @@ int main() {
     test_multiplayer_support();
     test_collision_caching();
     test_axis_specific_sampling();
+    test_prepared_levels();
+    test_packed_levels();
+    test_full_edge_sweep();
+    test_move_and_collide();
+    test_collision_contexts();
+    test_broadphase();
+    test_typed_tiles();
+    test_contact_masks();
+    test_streamed_levels();
+    test_block_levels();
+    test_raycasts();
+    test_trigger_layer();
+    test_flow_field();
     
     // Summary
     printf("\n=== Test Summary ===\n");
@@ -0,0 +1,283 @@
+/*
+ * entity_test.c - Entity pool test for SGP
+ * 
+ * This test validates the structure-of-arrays entity pool: spawn/free through the
+ * free-list, live iteration, movement with level collision, broadphase insertion and
+ * camera-relative sprite culling, using a mock SGDK environment.
+ */
+
+#include "sgp_test.h"
+
+// Mock SGDK function implementations
+u16 JOY_readJoypad(u16 joy) { (void)joy; return 0; }
+void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; }
+void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
+void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
+void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
+void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
+// Sprite call tracking
+static int set_position_calls = 0;
+static int set_visibility_calls = 0;
+static s16 last_sprite_x = 0, last_sprite_y = 0;
+static u16 last_visibility = 0;
+void SPR_setPosition(Sprite* sprite, s16 x, s16 y) {
+    (void)sprite; last_sprite_x = x; last_sprite_y = y; set_position_calls++; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) {
+    (void)sprite; last_visibility = visibility; set_visibility_calls++; }
+void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
+void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) { 
+    (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; }
+u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) { 
+    (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { (void)offset; return 0; }
+void SRAM_writeWord(u32 offset, u16 val) { (void)offset; (void)val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; }
+
+// Required global SGP state
+SGP sgp;
+
+// 8x8 room with solid border
+const u8 room_data[] = {
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 1, 1, 1
+};
+
+SGPLevelCollisionData room_level = {
+    .row_length = 8,
+    .data_length = 64,
+    .collision_data = room_data
+};
+
+// Test result tracking
+int tests_run = 0;
+int tests_passed = 0;
+
+static SGPEntityPool pool;
+
+void print_test_result(const char* test_name, bool passed) {
+    tests_run++;
+    if (passed) tests_passed++;
+    
+    printf("Test: %-45s - %s\n", test_name, passed ? "PASS" : "FAIL");
+    
+    if (!passed) {
+        printf("  *** TEST FAILED ***\n");
+    }
+}
+
+void test_spawn_and_free() {
+    printf("\n=== Spawn/Free Tests ===\n");
+
+    SGP_EntityPoolInit(&pool);
+    print_test_result("Pool starts empty", pool.live_count == 0);
+
+    // Fill the pool
+    bool all_spawned = true;
+    for (int i = 0; i < SGP_ENTITY_POOL_CAPACITY; i++) {
+        u8 e = SGP_EntitySpawn(&pool, FIX32(16 + i), FIX32(16), 8, 8);
+        if (e == SGP_ENTITY_NONE) all_spawned = false;
+    }
+    print_test_result("Spawn up to capacity", all_spawned && pool.live_count == SGP_ENTITY_POOL_CAPACITY);
+    print_test_result("Spawn fails when full", SGP_EntitySpawn(&pool, FIX32(0), FIX32(0), 8, 8) == SGP_ENTITY_NONE);
+
+    // Free a few, then reuse their slots
+    SGP_EntityFree(&pool, 3);
+    SGP_EntityFree(&pool, 10);
+    print_test_result("Freed entities are not live", !SGP_EntityIsLive(&pool, 3) && !SGP_EntityIsLive(&pool, 10));
+    print_test_result("Other entities stay live", SGP_EntityIsLive(&pool, 0) && SGP_EntityIsLive(&pool, 31));
+    print_test_result("Live count after free", pool.live_count == SGP_ENTITY_POOL_CAPACITY - 2);
+
+    // Double free and out-of-range handles leave the pool untouched
+    SGP_EntityFree(&pool, 3);
+    SGP_EntityFree(&pool, SGP_ENTITY_NONE);
+    print_test_result("Double free ignored", pool.live_count == SGP_ENTITY_POOL_CAPACITY - 2 && !SGP_EntityIsLive(&pool, 3));
+
+    u8 reused = SGP_EntitySpawn(&pool, FIX32(40), FIX32(40), 8, 8);
+    print_test_result("Spawn reuses last freed slot", reused == 10 && SGP_EntityIsLive(&pool, 10));
+    print_test_result("Respawn resets fields", pool.flags[10] == 0 && pool.box[10].x == 40);
+    u8 second = SGP_EntitySpawn(&pool, FIX32(40), FIX32(40), 8, 8);
+    print_test_result("Free-list not corrupted by double free", second == 3 &&
+                      SGP_EntitySpawn(&pool, FIX32(0), FIX32(0), 8, 8) == SGP_ENTITY_NONE);
+}
+
+void test_live_iteration() {
+    printf("\n=== Live Iteration Tests ===\n");
+
+    SGP_EntityPoolInit(&pool);
+    for (int i = 0; i < 8; i++)
+        SGP_EntitySpawn(&pool, FIX32(i * 10), FIX32(0), 8, 8);
+    SGP_EntityFree(&pool, 2);
+    SGP_EntityFree(&pool, 5);
+
+    u16 cursor = 0;
+    u8 e;
+    int visited = 0;
+    bool only_live = true;
+    while (SGP_EntityPoolNext(&pool, &cursor, &e)) {
+        visited++;
+        if (e == 2 || e == 5) only_live = false;
+    }
+    print_test_result("Iterator visits live entities only", visited == 6 && only_live);
+
+    // Freeing while iterating backwards visits everything once
+    visited = 0;
+    for (int i = pool.live_count - 1; i >= 0; i--) {
+        visited++;
+        if (pool.live[i] % 2 == 0) SGP_EntityFree(&pool, pool.live[i]);
+    }
+    print_test_result("Backward iteration with free", visited == 6 && pool.live_count == 3);
+}
+
+void test_pool_movement() {
+    printf("\n=== Pool Movement Tests ===\n");
+
+    SGP_EntityPoolInit(&pool);
+    u8 faller = SGP_EntitySpawn(&pool, FIX32(32), FIX32(32), 16, 16);
+    u8 runner = SGP_EntitySpawn(&pool, FIX32(32), FIX32(64), 16, 16);
+    u8 floater = SGP_EntitySpawn(&pool, FIX32(48), FIX32(48), 16, 16);
+    pool.vel_y[faller] = FIX32(100);
+    pool.vel_x[runner] = FIX32(100);
+
+    SGP_EntityPoolMove(&pool, &room_level);
+    print_test_result("Faller lands on floor", pool.contact[faller] == COLLIDE_DOWN && pool.box[faller].y == 96);
+    print_test_result("Runner stops at wall", pool.contact[runner] == COLLIDE_RIGHT && pool.box[runner].x == 96);
+    print_test_result("Floater untouched", pool.contact[floater] == 0 && pool.box[floater].x == 48);
+
+    u16 hits = SGP_EntityPoolLevelCollision(&pool, &room_level, SGP_DIR_DOWN);
+    print_test_result("No entity overlaps the floor after the move", hits == 0);
+    pool.y[floater] = FIX32(100);
+    hits = SGP_EntityPoolLevelCollision(&pool, &room_level, SGP_DIR_DOWN);
+    print_test_result("Context detects sunk entity", hits == 1 && FLAG_IS_ACTIVE(pool.collision[floater].flags, COLLIDE_DOWN));
+}
+
+void test_pool_broadphase() {
+    printf("\n=== Pool Broadphase Tests ===\n");
+
+    static SGPBroadphase bp;
+    SGP_EntityPoolInit(&pool);
+    u8 a = SGP_EntitySpawn(&pool, FIX32(10), FIX32(10), 16, 16);
+    u8 b = SGP_EntitySpawn(&pool, FIX32(20), FIX32(20), 16, 16);
+    SGP_EntitySpawn(&pool, FIX32(200), FIX32(150), 16, 16);
+
+    SGP_BroadphaseClear(&bp, 0, 0);
+    bool inserted = SGP_EntityPoolBroadphaseInsert(&pool, &bp);
+    SGPBroadphasePairIter it;
+    SGP_BroadphasePairsBegin(&it);
+    u16 id_a = 0, id_b = 0;
+    int pairs = 0;
+    bool pair_ok = false;
+    while (SGP_BroadphaseNextPair(&bp, &it, &id_a, &id_b)) {
+        pairs++;
+        pair_ok = (id_a == a && id_b == b) || (id_a == b && id_b == a);
+    }
+    print_test_result("Pool boxes inserted", inserted);
+    print_test_result("Only the overlapping pair is reported", pairs == 1 && pair_ok);
+}
+
+void test_sprite_culling() {
+    printf("\n=== Sprite Culling Tests ===\n");
+
+    static Sprite sprites[3];
+    Map map = {0};
+    map.w = 8;  // 1024 px
+    map.h = 4;  // 512 px
+    SGP_CameraInit(&map);
+    SGP_deactivateCamera();  // Position the camera directly
+    SGP_UpdateCameraPosition(100, 50);
+    print_test_result("Camera records committed view", sgp.camera.view_x == 100 && sgp.camera.view_y == 50);
+
+    SGP_EntityPoolInit(&pool);
+    u8 onscreen = SGP_EntitySpawn(&pool, FIX32(200), FIX32(100), 16, 16);
+    u8 offscreen = SGP_EntitySpawn(&pool, FIX32(600), FIX32(100), 16, 16);
+    u8 edge = SGP_EntitySpawn(&pool, FIX32(90), FIX32(100), 8, 8); // 2px left of the view
+    SGP_EntitySpawn(&pool, FIX32(150), FIX32(100), 16, 16);        // No sprite attached
+    SGP_EntitySetSprite(&pool, onscreen, &sprites[0], -4, -8);
+    SGP_EntitySetSprite(&pool, offscreen, &sprites[1], 0, 0);
+    SGP_EntitySetSprite(&pool, edge, &sprites[2], 0, 0);
+
+    set_position_calls = set_visibility_calls = 0;
+    u16 visible = SGP_EntityPoolUpdateSprites(&pool, 0);
+    print_test_result("First pass shows on-screen sprites only", visible == 1 &&
+                      pool.sprite_state[onscreen] == SGP_SPRITE_SHOWN &&
+                      pool.sprite_state[offscreen] == SGP_SPRITE_HIDDEN &&
+                      pool.sprite_state[edge] == SGP_SPRITE_HIDDEN);
+    print_test_result("Sprite placed camera-relative with offset", set_position_calls == 1 &&
+                      last_sprite_x == 96 && last_sprite_y == 42);
+    print_test_result("Each sprite gets one visibility call", set_visibility_calls == 3);
+
+    set_position_calls = set_visibility_calls = 0;
+    SGP_EntityPoolUpdateSprites(&pool, 0);
+    print_test_result("Unchanged frame issues no sprite calls", set_position_calls == 0 && set_visibility_calls == 0);
+
+    visible = SGP_EntityPoolUpdateSprites(&pool, 4);
+    print_test_result("Margin keeps edge sprite visible", visible == 2 &&
+                      pool.sprite_state[edge] == SGP_SPRITE_SHOWN && last_visibility == VISIBLE &&
+                      last_sprite_x == -10);
+
+    set_position_calls = set_visibility_calls = 0;
+    pool.x[onscreen] = FIX32(203);
+    SGP_EntityPoolSyncBoxes(&pool);
+    SGP_EntityPoolUpdateSprites(&pool, 4);
+    print_test_result("Moved sprite repositioned once", set_position_calls == 1 &&
+                      set_visibility_calls == 0 && last_sprite_x == 99);
+
+    set_position_calls = 0;
+    SGP_UpdateCameraPosition(500, 50);
+    visible = SGP_EntityPoolUpdateSprites(&pool, 4);
+    print_test_result("Camera move swaps visible sprites", visible == 1 &&
+                      pool.sprite_state[offscreen] == SGP_SPRITE_SHOWN &&
+                      pool.sprite_state[onscreen] == SGP_SPRITE_HIDDEN &&
+                      last_sprite_x == 100 && last_sprite_y == 50);
+
+    SGP_EntitySetSprite(&pool, onscreen, &sprites[0], 0, 0);
+    set_visibility_calls = 0;
+    SGP_EntityPoolUpdateSprites(&pool, 4);
+    print_test_result("Reattached sprite is hidden again", set_visibility_calls == 1 &&
+                      last_visibility == HIDDEN);
+}
+
+int main() {
+    printf("=== SGP Entity Pool Test Suite ===\n");
+    
+    // Initialize SGP
+    SGP_init();
+    
+    printf("\nEntity pool capacity: %d\n", SGP_ENTITY_POOL_CAPACITY);
+    
+    // Run all test suites
+    test_spawn_and_free();
+    test_live_iteration();
+    test_pool_movement();
+    test_pool_broadphase();
+    test_sprite_culling();
+    
+    // Summary
+    printf("\n=== Test Summary ===\n");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_run - tests_passed);
+    printf("Success rate: %.1f%%\n", (float)tests_passed / tests_run * 100.0f);
+    
+    if (tests_passed == tests_run) {
+        printf("\n✓ All entity tests passed!\n");
+        return 0;
+    } else {
+        printf("\n✗ Some entity tests failed!\n");
+        return 1;
+    }
+}
@@ -22,9 +22,11 @@ u16 JOY_readJoypad(u16 joy) {
 void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; }
 void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
 void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
 void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
 void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
 void SPR_setPosition(Sprite* sprite, s16 x, s16 y) { (void)sprite; (void)x; (void)y; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { (void)sprite; (void)visibility; }
 void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
 void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) { 
     (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; 
@@ -32,6 +34,19 @@ void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 meth
 u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) { 
     (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; 
 }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+// Mock SRAM (byte-addressed, word access)
+static u16 mock_sram[512];
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { return mock_sram[(offset >> 1) & 511]; }
+void SRAM_writeWord(u32 offset, u16 val) { mock_sram[(offset >> 1) & 511] = val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; }
 
 // Test utilities
 static void set_mock_joypad_state(u16 joy1_state, u16 joy2_state) {
@@ -40,10 +55,12 @@ static void set_mock_joypad_state(u16 joy1_state, u16 joy2_state) {
 }
 
 static void reset_sgp_input_state() {
-    sgp.input.joy1_state = 0;
-    sgp.input.joy2_state = 0;
-    sgp.input.joy1_previous = 0;
-    sgp.input.joy2_previous = 0;
+    for (int i = 0; i < SGP_INPUT_PAD_SLOTS; i++) {
+        sgp.input.state[i] = 0;
+        sgp.input.previous[i] = 0;
+        sgp.input.pressed[i] = 0;
+        sgp.input.released[i] = 0;
+    }
 }
 
 static int test_count = 0;
@@ -71,31 +88,31 @@ void test_poll_input_basic() {
     set_mock_joypad_state(0, 0);
     SGP_PollInput();
     TEST("Poll input - initial state zero", 
-         sgp.input.joy1_state == 0 && sgp.input.joy2_state == 0 &&
-         sgp.input.joy1_previous == 0 && sgp.input.joy2_previous == 0);
+         sgp.input.state[JOY_1] == 0 && sgp.input.state[JOY_2] == 0 &&
+         sgp.input.previous[JOY_1] == 0 && sgp.input.previous[JOY_2] == 0);
     
     // Test 2: State change detection
     set_mock_joypad_state(BUTTON_A, BUTTON_B);
     SGP_PollInput();
     TEST("Poll input - state change detection", 
-         sgp.input.joy1_state == BUTTON_A && sgp.input.joy2_state == BUTTON_B &&
-         sgp.input.joy1_previous == 0 && sgp.input.joy2_previous == 0);
+         sgp.input.state[JOY_1] == BUTTON_A && sgp.input.state[JOY_2] == BUTTON_B &&
+         sgp.input.previous[JOY_1] == 0 && sgp.input.previous[JOY_2] == 0);
     
     // Test 3: Previous state tracking
     set_mock_joypad_state(BUTTON_A | BUTTON_UP, BUTTON_B | BUTTON_DOWN);
     SGP_PollInput();
     TEST("Poll input - previous state tracking", 
-         sgp.input.joy1_state == (BUTTON_A | BUTTON_UP) && 
-         sgp.input.joy2_state == (BUTTON_B | BUTTON_DOWN) &&
-         sgp.input.joy1_previous == BUTTON_A && sgp.input.joy2_previous == BUTTON_B);
+         sgp.input.state[JOY_1] == (BUTTON_A | BUTTON_UP) && 
+         sgp.input.state[JOY_2] == (BUTTON_B | BUTTON_DOWN) &&
+         sgp.input.previous[JOY_1] == BUTTON_A && sgp.input.previous[JOY_2] == BUTTON_B);
     
     // Test 4: Multiple button combinations
     set_mock_joypad_state(BUTTON_A | BUTTON_B | BUTTON_UP | BUTTON_LEFT, 
                          BUTTON_A | BUTTON_RIGHT | BUTTON_DOWN);
     SGP_PollInput();
     TEST("Poll input - multiple button combinations", 
-         sgp.input.joy1_state == (BUTTON_A | BUTTON_B | BUTTON_UP | BUTTON_LEFT) &&
-         sgp.input.joy2_state == (BUTTON_A | BUTTON_RIGHT | BUTTON_DOWN));
+         sgp.input.state[JOY_1] == (BUTTON_A | BUTTON_B | BUTTON_UP | BUTTON_LEFT) &&
+         sgp.input.state[JOY_2] == (BUTTON_A | BUTTON_RIGHT | BUTTON_DOWN));
 }
 
 //=============================================================================
@@ -408,7 +425,7 @@ void test_performance_and_state() {
         // Check previous state matches what we set last time (except first iteration)
         if (i > 0) {
             u16 expected_prev = test_states[i-1];
-            if (sgp.input.joy1_previous != expected_prev) {
+            if (sgp.input.previous[JOY_1] != expected_prev) {
                 tracking_correct = false;
                 break;
             }
@@ -417,6 +434,236 @@ void test_performance_and_state() {
     TEST("Performance - previous state tracking accuracy", tracking_correct);
 }
 
+//=============================================================================
+// Test Suite 8: Edge Masks and Pad Slots
+//=============================================================================
+
+void test_edge_masks() {
+    printf("\n=== Test Suite 8: Edge Masks and Pad Slots ===\n");
+    
+    // Test 1: Edge masks computed once per poll
+    reset_sgp_input_state();
+    set_mock_joypad_state(BUTTON_A | BUTTON_B, 0);
+    SGP_PollInput();
+    set_mock_joypad_state(BUTTON_B | BUTTON_C, 0);
+    SGP_PollInput();
+    TEST("Edge masks - pressed mask", sgp.input.pressed[JOY_1] == BUTTON_C && SGP_ButtonsPressedMask(JOY_1) == BUTTON_C);
+    TEST("Edge masks - released mask", sgp.input.released[JOY_1] == BUTTON_A);
+    TEST("Edge masks - down mask", SGP_ButtonsDownMask(JOY_1) == (BUTTON_B | BUTTON_C));
+    
+    // Test 2: 6-button pad buttons use the same query path
+    reset_sgp_input_state();
+    set_mock_joypad_state(BUTTON_X | BUTTON_Y | BUTTON_Z | BUTTON_MODE, 0);
+    SGP_PollInput();
+    TEST("Edge masks - 6-button pressed", 
+         SGP_ButtonPressed(JOY_1, BUTTON_X) && SGP_ButtonPressed(JOY_1, BUTTON_Z) && SGP_ButtonDown(JOY_1, BUTTON_MODE));
+    set_mock_joypad_state(BUTTON_Y, 0);
+    SGP_PollInput();
+    TEST("Edge masks - 6-button released", 
+         SGP_ButtonReleased(JOY_1, BUTTON_X) && !SGP_ButtonReleased(JOY_1, BUTTON_Y));
+    
+    // Test 3: Unpolled slots read as idle even when JOY_2 is busy
+    reset_sgp_input_state();
+    set_mock_joypad_state(0, BUTTON_A);
+    SGP_PollInput();
+    TEST("Pad slots - unpolled slot idle", 
+         !SGP_ButtonDown(SGP_INPUT_PAD_COUNT, BUTTON_A) && !SGP_ButtonPressed(SGP_INPUT_PAD_SLOTS - 1, BUTTON_A));
+    
+    // Test 4: Slots are indexed by joy id
+    sgp.input.state[5] = BUTTON_START;
+    TEST("Pad slots - indexed by joy id", SGP_ButtonDown(5, BUTTON_START) && !SGP_ButtonDown(JOY_2, BUTTON_START));
+    
+    // Test 5: SGP_init clears every slot
+    SGP_init();
+    TEST("Pad slots - init clears all", sgp.input.state[5] == 0 && sgp.input.pressed[JOY_2] == 0);
+
+    // Test 6: Legacy joy1/joy2 fields track the JOY_1/JOY_2 slots
+    set_mock_joypad_state(BUTTON_A, BUTTON_B);
+    SGP_PollInput();
+    set_mock_joypad_state(BUTTON_C, BUTTON_B);
+    SGP_PollInput();
+    TEST("Legacy fields - joy1/joy2 state", sgp.input.joy1_state == BUTTON_C && sgp.input.joy2_state == BUTTON_B);
+    TEST("Legacy fields - joy1/joy2 previous", sgp.input.joy1_previous == BUTTON_A && sgp.input.joy2_previous == BUTTON_B);
+}
+
+//=============================================================================
+// Test Suite 9: Input History and Sequences
+//=============================================================================
+
+#define DPAD (BUTTON_UP | BUTTON_DOWN | BUTTON_LEFT | BUTTON_RIGHT)
+
+static void feed_frames(const u16 *states, int count) {
+    for (int i = 0; i < count; i++) {
+        set_mock_joypad_state(states[i], 0);
+        SGP_PollInput();
+    }
+}
+
+void test_input_history() {
+    printf("\n=== Test Suite 9: Input History and Sequences ===\n");
+    
+    const SGPInputStep qcf[] = {
+        { DPAD, BUTTON_DOWN, false },
+        { DPAD, BUTTON_DOWN | BUTTON_RIGHT, false },
+        { DPAD, BUTTON_RIGHT, false },
+        { BUTTON_A, BUTTON_A, true },
+    };
+    
+    // Test 1: History records states and edges, newest first
+    SGP_init();
+    const u16 frames[] = { BUTTON_A, BUTTON_B, BUTTON_B | BUTTON_C };
+    feed_frames(frames, 3);
+    TEST("History - frame stamp advances", SGP_InputFrame() == 3);
+    TEST("History - newest state first", 
+         SGP_InputHistoryState(JOY_1, 0) == (BUTTON_B | BUTTON_C) && SGP_InputHistoryState(JOY_1, 2) == BUTTON_A);
+    TEST("History - pressed edges recorded", 
+         SGP_InputHistoryPressed(JOY_1, 0) == BUTTON_C && SGP_InputHistoryPressed(JOY_1, 1) == BUTTON_B);
+    TEST("History - older than history reads idle", SGP_InputHistoryState(JOY_1, 3) == 0);
+    
+    // Test 2: Quarter-circle forward + A, with an idle frame in between
+    SGP_init();
+    const u16 motion[] = { 0, BUTTON_DOWN, BUTTON_DOWN | BUTTON_RIGHT, 0, BUTTON_RIGHT, BUTTON_RIGHT | BUTTON_A };
+    feed_frames(motion, 6);
+    TEST("Sequence - quarter-circle matches", SGP_InputMatchSequence(JOY_1, qcf, 4, 8));
+    TEST("Sequence - window too short fails", !SGP_InputMatchSequence(JOY_1, qcf, 4, 3));
+    TEST("Sequence - other pad does not match", !SGP_InputMatchSequence(JOY_2, qcf, 4, 8));
+    
+    // Test 3: Final step must be this frame
+    set_mock_joypad_state(BUTTON_RIGHT | BUTTON_A, 0);
+    SGP_PollInput();
+    TEST("Sequence - stale final step fails", !SGP_InputMatchSequence(JOY_1, qcf, 4, 8));
+    
+    // Test 4: Button alone without the motion
+    SGP_init();
+    const u16 jab[] = { 0, BUTTON_RIGHT, BUTTON_RIGHT | BUTTON_A };
+    feed_frames(jab, 3);
+    TEST("Sequence - missing steps fail", !SGP_InputMatchSequence(JOY_1, qcf, 4, 8));
+    
+    // Test 5: Charge back then forward
+    SGP_init();
+    for (int i = 0; i < 20; i++) {
+        set_mock_joypad_state(BUTTON_LEFT, 0);
+        SGP_PollInput();
+    }
+    set_mock_joypad_state(BUTTON_RIGHT, 0);
+    SGP_PollInput();
+    TEST("Charge - held frames counted", SGP_InputHeldFrames(JOY_1, DPAD, BUTTON_LEFT, 1) == 20);
+    TEST("Charge - broken by current frame", SGP_InputHeldFrames(JOY_1, DPAD, BUTTON_LEFT, 0) == 0);
+    
+    // Test 6: Ring wraps and caps at the history size
+    for (int i = 0; i < SGP_INPUT_HISTORY_SIZE * 2; i++) {
+        set_mock_joypad_state(BUTTON_DOWN, 0);
+        SGP_PollInput();
+    }
+    TEST("History - wraps at ring size", 
+         SGP_InputHeldFrames(JOY_1, DPAD, BUTTON_DOWN, 0) == SGP_INPUT_HISTORY_SIZE &&
+         SGP_InputHistoryState(JOY_1, SGP_INPUT_HISTORY_SIZE - 1) == BUTTON_DOWN);
+}
+
+//=============================================================================
+// Test Suite 10: Record and Replay
+//=============================================================================
+
+// Scripted session: held runs, a 2-player frame and taps
+static u16 script_joy1(int frame) { return (frame < 20) ? BUTTON_RIGHT : (frame < 30) ? (BUTTON_RIGHT | BUTTON_A) : (frame % 7 == 0) ? BUTTON_B : 0; }
+static u16 script_joy2(int frame) { return (frame == 25) ? BUTTON_START : 0; }
+
+void test_record_replay() {
+    printf("\n=== Test Suite 10: Record and Replay ===\n");
+    
+    enum { FRAMES = 60 };
+    static u16 buffer[256];
+    static u16 live_state[FRAMES], live_pressed[FRAMES], live_joy2[FRAMES];
+    SGPInputStream stream;
+    
+    // Test 1: Record a scripted session
+    SGP_init();
+    SGP_InputStreamInit(&stream, buffer, 256);
+    TEST("Replay - start record", SGP_InputStartRecord(&stream) && SGP_InputGetMode() == SGP_INPUT_RECORD);
+    for (int i = 0; i < FRAMES; i++) {
+        set_mock_joypad_state(script_joy1(i), script_joy2(i));
+        SGP_PollInput();
+        live_state[i] = sgp.input.state[JOY_1];
+        live_pressed[i] = sgp.input.pressed[JOY_1];
+        live_joy2[i] = sgp.input.state[JOY_2];
+    }
+    SGP_InputStop();
+    TEST("Replay - runs compress held input", stream.length < 1 + FRAMES && !stream.overflow);
+    TEST("Replay - header holds pad count", buffer[0] == SGP_INPUT_PAD_COUNT);
+    
+    // Test 2: Replay ignores the joypads and reproduces every frame
+    SGP_init();
+    TEST("Replay - start replay", SGP_InputStartReplay(&stream) && SGP_InputGetMode() == SGP_INPUT_REPLAY);
+    set_mock_joypad_state(BUTTON_UP | BUTTON_C, BUTTON_A);  // Must be ignored
+    bool identical = true;
+    for (int i = 0; i < FRAMES; i++) {
+        SGP_PollInput();
+        if (sgp.input.state[JOY_1] != live_state[i] || sgp.input.pressed[JOY_1] != live_pressed[i] ||
+            sgp.input.state[JOY_2] != live_joy2[i]) identical = false;
+    }
+    TEST("Replay - frame-for-frame identical", identical && !SGP_isInputReplayDone());
+    SGP_PollInput();
+    TEST("Replay - idle after end of stream", SGP_isInputReplayDone() && sgp.input.state[JOY_1] == 0);
+    SGP_InputStop();
+    
+    // Test 3: SRAM round trip
+    u32 bytes = SGP_InputStreamSaveSRAM(&stream, 0);
+    static u16 sram_buffer[256];
+    SGPInputStream loaded;
+    SGP_InputStreamInit(&loaded, sram_buffer, 256);
+    bool loaded_ok = SGP_InputStreamLoadSRAM(&loaded, 0);
+    bool same = loaded_ok && loaded.length == stream.length && bytes == 2u + stream.length * 2u;
+    for (u16 i = 0; same && i < stream.length; i++) same = sram_buffer[i] == buffer[i];
+    TEST("Replay - SRAM round trip", same);
+    SGPInputStream tiny;
+    u16 tiny_buffer[4];
+    SGP_InputStreamInit(&tiny, tiny_buffer, 4);
+    TEST("Replay - SRAM load rejects oversize", !SGP_InputStreamLoadSRAM(&tiny, 0));
+    
+    // Test 4: Host file round trip replays the same frames
+    const char* path = "input_replay_test.bin";
+    static u16 file_buffer[256];
+    SGPInputStream from_file;
+    SGP_InputStreamInit(&from_file, file_buffer, 256);
+    bool file_ok = SGP_TestSaveInputStream(path, &stream) && SGP_TestLoadInputStream(path, &from_file);
+    remove(path);
+    SGP_init();
+    file_ok = file_ok && SGP_InputStartReplay(&from_file);
+    for (int i = 0; file_ok && i < FRAMES; i++) {
+        SGP_PollInput();
+        file_ok = sgp.input.state[JOY_1] == live_state[i];
+    }
+    SGP_InputStop();
+    TEST("Replay - host file round trip", file_ok);
+    
+    // Test 5: Overflow drops frames without corrupting the buffer
+    SGP_InputStreamInit(&tiny, tiny_buffer, 4);
+    SGP_InputStartRecord(&tiny);
+    for (int i = 0; i < 4; i++) {
+        set_mock_joypad_state((u16)(1 << i), 0);
+        SGP_PollInput();
+    }
+    SGP_InputStop();
+    TEST("Replay - overflow flagged", tiny.overflow && tiny.length == 1 + (1 + SGP_INPUT_PAD_COUNT));
+
+    // Test 6: A frame matching the last record after an overflow must not extend its run
+    SGP_InputStreamInit(&tiny, tiny_buffer, 4);
+    SGP_InputStartRecord(&tiny);
+    set_mock_joypad_state(BUTTON_A, 0);
+    SGP_PollInput();
+    set_mock_joypad_state(BUTTON_B, 0);
+    SGP_PollInput(); // Dropped
+    set_mock_joypad_state(BUTTON_A, 0);
+    SGP_PollInput();
+    SGP_InputStop();
+    TEST("Replay - no run extension after overflow", tiny.overflow && tiny_buffer[1] == 1);
+    
+    // Test 7: Streams recorded with another pad count are rejected
+    buffer[0] = SGP_INPUT_PAD_COUNT + 1;
+    TEST("Replay - pad count mismatch rejected", !SGP_InputStartReplay(&stream) && SGP_InputGetMode() == SGP_INPUT_LIVE);
+    buffer[0] = SGP_INPUT_PAD_COUNT;
+}
+
 //=============================================================================
 // Main Test Runner
 //=============================================================================
@@ -436,6 +683,9 @@ int main() {
     test_edge_cases();
     test_complex_scenarios();
     test_performance_and_state();
+    test_edge_masks();
+    test_input_history();
+    test_record_replay();
     
     // Print summary
     printf("\n=== Test Summary ===\n");
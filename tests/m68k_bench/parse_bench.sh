@@ -0,0 +1,59 @@
+#!/bin/sh
+#
+# parse_bench.sh - Cycles per call table from an m68k benchmark ROM log
+#
+# Reads the emulator's KDebug output and prints one line per kernel:
+#   <scanline cycles/call> <KMod timer cycles/call> <name>
+# The scanline figure comes from the ROM's "SGP_BENCH <cycles> <name>" lines
+# ("rejected" for "SGP_BENCH_REJECTED"). The timer figure pairs each
+# "SGP_BENCH_TIMER <batch> <name>" and "SGP_BENCH_TIMER_BASE <batch> <name>" line
+# with the first number on the line right after it, where emulators with the KMod
+# timer log the elapsed cycles, and reports (timer - base) / batch. It is "-" when
+# the emulator does not log a count.
+#
+# Usage: parse_bench.sh LOG   (exits 1 if the log lacks SGP_BENCH_DONE)
+
+LOG="$1"
+if [ -z "$LOG" ] || [ ! -f "$LOG" ]; then
+    echo "usage: $0 LOG" >&2
+    exit 1
+fi
+
+awk '
+# Text after the tag, so emulator prefixes before the alert are ignored
+function after(tag,    i) {
+    i = index($0, tag " ")
+    return substr($0, i + length(tag) + 1)
+}
+function first_word(s) { sub(/ .*/, "", s); return s }
+function rest(s) { sub(/^[^ ]* /, "", s); return s }
+
+# Line after a timer tag: its first number is the KMod count (if it is not our own alert)
+pending != "" {
+    if (index($0, "SGP_BENCH") == 0 && match($0, /[0-9]+/)) {
+        count = substr($0, RSTART, RLENGTH)
+        if (pending == "kernel") timer[name] = count
+        else base[name] = count
+    }
+    pending = ""
+}
+index($0, "SGP_BENCH_TIMER_BASE ") { s = after("SGP_BENCH_TIMER_BASE"); name = rest(s); pending = "base"; next }
+index($0, "SGP_BENCH_TIMER ") { s = after("SGP_BENCH_TIMER"); name = rest(s); batch[name] = first_word(s); pending = "kernel"; next }
+index($0, "SGP_BENCH_REJECTED ") { s = after("SGP_BENCH_REJECTED"); name = rest(s); order[n++] = name; scan[name] = "rejected"; next }
+index($0, "SGP_BENCH_DONE") { done = 1; next }
+index($0, "SGP_BENCH ") { s = after("SGP_BENCH"); name = rest(s); order[n++] = name; scan[name] = first_word(s); next }
+
+END {
+    printf "%10s %10s  %s\n", "scanline", "timer", "kernel (cycles/call)"
+    for (i = 0; i < n; i++) {
+        k = order[i]
+        exact = "-"
+        if ((k in timer) && (k in base) && batch[k] > 0)
+            exact = int((timer[k] - base[k]) / batch[k] + 0.5)
+        printf "%10s %10s  %s\n", scan[k], exact, k
+    }
+    if (!done) {
+        print "SGP_BENCH_DONE missing: the run did not finish" > "/dev/stderr"
+        exit 1
+    }
+}' "$LOG"
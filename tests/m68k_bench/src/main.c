@@ -0,0 +1,193 @@
+/*
+ * main.c - m68k cycle benchmark ROM for SGP hot paths
+ *
+ * Runs the bench_kernels.h kernels on real 68000 code generated by m68k-elf-gcc
+ * against SGDK, and reports cycles per call: the number to budget against
+ * (~127k cycles per NTSC frame). The V-counter only resolves whole scanlines
+ * (~489 cycles), so every sample repeats a kernel's batch until it spans about
+ * BENCH_TARGET_LINES lines, keeping the quantization under 1% of the sample.
+ * A sample that does not read the calibrated scanline count wrapped past a frame
+ * and is rejected. Results go to the KDebug channel as "SGP_BENCH <cycles> <name>"
+ * lines ("SGP_BENCH_REJECTED" for kernels that cannot be timed), to the screen,
+ * and to sgp_bench_cycles[] for emulators that dump RAM. "SGP_BENCH_DONE" marks
+ * the end of a run.
+ *
+ * Every kernel also runs one batch, then one empty batch, under the KMod timer.
+ * Emulators that implement it log an exact cycle count after each
+ * "SGP_BENCH_TIMER" / "SGP_BENCH_TIMER_BASE" line; parse_bench.sh pairs them
+ * into exact cycles per call, reported next to the scanline figure.
+ *
+ * Build with: make bench_m68k GDK=/path/to/sgdk   (from tests/)
+ */
+
+#include <genesis.h>
+#include "../../../sgp.h"
+#include "../../bench_kernels.h"
+
+// Required global SGP state
+SGP sgp;
+
+#define BENCH_SAMPLES 8            // Timed samples per kernel, summed
+#define BENCH_TARGET_LINES 192     // Scanlines per sample, under a frame; the +-1 line step is 0.5%
+#define BENCH_CLOCKS_PER_LINE 3420 // Master clocks per scanline (68000 runs at master / 7)
+#define BENCH_INVALID 0xFFFFFFFF   // Sample rejected: it did not fit in one frame
+
+// Cycles per call for every kernel, loop overhead removed (BENCH_INVALID if rejected)
+volatile u32 sgp_bench_cycles[BENCH_KERNEL_COUNT];
+volatile u32 sgp_bench_sink;
+
+// Scanlines elapsed across `reps` batches (interrupts off); only exact below one frame
+static u16 bench_lines(u32 (*run)(u16 count), u16 batch, u16 reps)
+{
+    const u16 frame_lines = IS_PAL_SYSTEM ? 313 : 262;
+    const u16 start = VDP_getAdjustedVCounter();
+    for (u16 r = 0; r < reps; r++)
+        sgp_bench_sink += run(batch);
+    const u16 end = VDP_getAdjustedVCounter();
+    return (end >= start) ? (end - start) : (end + frame_lines - start);
+}
+
+// True if `lines` matches the `expected` scanlines of a sample, within quantization and jitter.
+// A sample that wrapped past a frame reads short modulo frame_lines and fails this check.
+static bool bench_lines_match(u16 lines, u32 expected)
+{
+    const u32 slack = (expected >> 3) + 2;
+    return lines + slack >= expected && lines <= expected + slack;
+}
+
+/**
+ * Doubles the batches per sample until a sample lasts BENCH_TARGET_LINES / 4 scanlines, then
+ * scales to about BENCH_TARGET_LINES. Each doubling must read about twice the scanlines, which
+ * rejects batches too long to time within one frame.
+ *
+ * @return Batches per sample, 0 if the kernel cannot be timed
+ */
+static u16 bench_calibrate(u32 (*run)(u16 count), u16 batch, u16 *sample_lines)
+{
+    const u16 frame_lines = IS_PAL_SYSTEM ? 313 : 262;
+    u16 reps = 1;
+    SYS_disableInts();
+    u16 lines = bench_lines(run, batch, 1);
+    bool valid = true;
+    do
+    {
+        const u16 doubled = bench_lines(run, batch, reps << 1);
+        if ((u32)lines * 2 >= (u32)frame_lines - 1 || !bench_lines_match(doubled, (u32)lines * 2))
+            valid = false;
+        reps <<= 1;
+        lines = doubled;
+    } while (valid && lines < BENCH_TARGET_LINES / 4 && reps < 0x2000);
+    SYS_enableInts();
+    if (!valid || lines == 0)
+        return 0;
+
+    u32 scaled = ((u32)reps * BENCH_TARGET_LINES) / lines;
+    if (scaled > 0xFFFF)
+        scaled = 0xFFFF;
+    if (scaled == 0)
+        scaled = 1;
+    *sample_lines = (u16)(((u32)lines * scaled) / reps);
+    if (*sample_lines >= frame_lines - 1)
+        return 0;
+    return (u16)scaled;
+}
+
+// 68000 cycles for BENCH_SAMPLES samples of `reps` batches, BENCH_INVALID if any sample strays
+// from the calibrated `sample_lines` (wrapped past a frame)
+static u32 bench_cycles(u32 (*run)(u16 count), u16 batch, u16 reps, u16 sample_lines)
+{
+    u32 lines = 0;
+    bool valid = true;
+    SYS_disableInts();
+    for (u16 s = 0; s < BENCH_SAMPLES; s++)
+    {
+        const u16 sample = bench_lines(run, batch, reps);
+        if (!bench_lines_match(sample, sample_lines))
+            valid = false;
+        lines += sample;
+    }
+    SYS_enableInts();
+    return valid ? (lines * BENCH_CLOCKS_PER_LINE) / 7 : BENCH_INVALID;
+}
+
+// Sends "<tag> <value> <name>" to the KDebug channel
+static void bench_alert(const char *tag, u32 value, const char *name)
+{
+    char line[64];
+    char number[12];
+    uintToStr(value, number, 1);
+    strcpy(line, tag);
+    strcat(line, " ");
+    strcat(line, number);
+    strcat(line, " ");
+    strcat(line, name);
+    KDebug_Alert(line);
+}
+
+int main(bool hard_reset)
+{
+    (void)hard_reset;
+    char number[12];
+
+    SGP_init();
+    bench_setup();
+    VDP_drawText("SGP m68k benchmark (cycles/call)", 1, 1);
+
+    for (u16 k = 0; k < BENCH_KERNEL_COUNT; k++)
+    {
+        const BenchKernel *kernel = &bench_kernels[k];
+        u16 sample_lines = 0;
+        u16 reps = bench_calibrate(kernel->run, kernel->batch, &sample_lines);
+        u32 total = reps ? bench_cycles(kernel->run, kernel->batch, reps, sample_lines) : BENCH_INVALID;
+        if (reps && total == BENCH_INVALID)
+        {
+            // One stray sample (e.g. a long first batch): re-calibrate once before rejecting
+            reps = bench_calibrate(kernel->run, kernel->batch, &sample_lines);
+            total = reps ? bench_cycles(kernel->run, kernel->batch, reps, sample_lines) : BENCH_INVALID;
+        }
+        u32 cycles = BENCH_INVALID;
+        if (total != BENCH_INVALID)
+        {
+            // The baseline needs its own sample length: it runs the same reps, only faster
+            u16 base_lines = 0;
+            const u16 base_reps = bench_calibrate(bench_empty, kernel->batch, &base_lines);
+            const u32 expected = base_reps ? ((u32)base_lines * reps) / base_reps : 0;
+            const u32 overhead = bench_cycles(bench_empty, kernel->batch, reps, (u16)expected);
+            const u32 calls = (u32)kernel->batch * reps * BENCH_SAMPLES;
+            if (overhead != BENCH_INVALID)
+                cycles = (total > overhead) ? (total - overhead) / calls : 0;
+        }
+        sgp_bench_cycles[k] = cycles;
+
+        // Exact cycle counts for one batch and one empty batch from the KMod timer: emulators
+        // that implement it log the count right after each "SGP_BENCH_TIMER" line
+        bench_alert("SGP_BENCH_TIMER", kernel->batch, kernel->name);
+        KDebug_StartTimer();
+        sgp_bench_sink += kernel->run(kernel->batch);
+        KDebug_StopTimer();
+        bench_alert("SGP_BENCH_TIMER_BASE", kernel->batch, kernel->name);
+        KDebug_StartTimer();
+        sgp_bench_sink += bench_empty(kernel->batch);
+        KDebug_StopTimer();
+
+        if (cycles == BENCH_INVALID)
+        {
+            bench_alert("SGP_BENCH_REJECTED", kernel->batch, kernel->name);
+            strcpy(number, "-");
+        }
+        else
+        {
+            bench_alert("SGP_BENCH", cycles, kernel->name);
+            uintToStr(cycles, number, 6);
+        }
+        VDP_drawText(number, 1, 3 + k);
+        VDP_drawText(kernel->name, 8, 3 + k);
+        SYS_doVBlankProcess();
+    }
+
+    KDebug_Alert("SGP_BENCH_DONE");
+    VDP_drawText("Done", 1, 4 + BENCH_KERNEL_COUNT);
+    while (TRUE)
+        SYS_doVBlankProcess();
+    return 0;
+}
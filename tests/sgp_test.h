@@ -33,6 +33,12 @@ typedef int fix32;
 #define BUTTON_DOWN 0x0002
 #define BUTTON_LEFT 0x0004
 #define BUTTON_RIGHT 0x0008
+#define BUTTON_C 0x0020
+#define BUTTON_START 0x0080
+#define BUTTON_Z 0x0100
+#define BUTTON_Y 0x0200
+#define BUTTON_X 0x0400
+#define BUTTON_MODE 0x0800
 
 // Screen and VDP definitions
 #define screenWidth 320
@@ -41,6 +47,13 @@ typedef int fix32;
 #define WINDOW 0
 #define PAL1 1
 #define DMA 1
+#define DMA_QUEUE 2
+#define BG_A 2
+#define HSCROLL_PLANE 0
+#define HSCROLL_TILE 2
+#define HSCROLL_LINE 3
+#define VSCROLL_PLANE 0
+typedef u16 VDPPlane;
 
 // Fixed-point macros
 #define F32_toInt(x) ((int)(x))
@@ -57,17 +70,32 @@ typedef struct {
     void* data; 
 } Sprite;
 
+// Sprite visibility modes
+#define VISIBLE 1
+#define HIDDEN 2
+
 // Mock SGDK function declarations
 extern u16 JOY_readJoypad(u16 joy);
 extern void MAP_scrollTo(Map* map, u32 x, u32 y);
 extern void VDP_drawText(const char* str, u16 x, u16 y);
 extern void SYS_doVBlankProcess(void);
+extern void SYS_setVBlankCallback(void (*callback)(void));
 extern void VDP_setHorizontalScroll(u16 bg, s16 scroll);
 extern void VDP_setVerticalScroll(u16 bg, s16 scroll);
 extern void SPR_setPosition(Sprite* sprite, s16 x, s16 y);
+extern void SPR_setVisibility(Sprite* sprite, u16 visibility);
 extern void VDP_setWindowVPos(bool enable, u16 pos);
 extern void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method);
 extern u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH);
+extern u16 VDP_getAdjustedVCounter(void);
+extern void SRAM_enable(void);
+extern void SRAM_enableRO(void);
+extern void SRAM_disable(void);
+extern u16 SRAM_readWord(u32 offset);
+extern void SRAM_writeWord(u32 offset, u16 val);
+extern void VDP_setScrollingMode(u16 hscroll, u16 vscroll);
+extern void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm);
+extern void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm);
 
 // Prevent genesis.h inclusion by defining its guard
 #define GENESIS_H
@@ -75,4 +103,35 @@ extern u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH);
 // Now include SGP header (which will skip genesis.h due to guard)
 #include "../sgp.h"
 
+// Host-side input stream files: big-endian words in the SRAM layout ([length][data...]),
+// so streams recorded on hardware or in an emulator replay identically in the mocks.
+static inline bool SGP_TestSaveInputStream(const char* path, const SGPInputStream* stream) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = true;
+    for (int i = -1; i < (int)stream->length && ok; i++) {
+        u16 word = (i < 0) ? stream->length : stream->data[i];
+        ok = fputc(word >> 8, f) != EOF && fputc(word & 0xFF, f) != EOF;
+    }
+    fclose(f);
+    return ok;
+}
+
+static inline bool SGP_TestLoadInputStream(const char* path, SGPInputStream* stream) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    int hi = fgetc(f), lo = fgetc(f);
+    u16 length = (hi == EOF || lo == EOF) ? 0 : (u16)((hi << 8) | lo);
+    bool ok = length >= 1 && length <= stream->capacity;
+    for (u16 i = 0; i < length && ok; i++) {
+        hi = fgetc(f);
+        lo = fgetc(f);
+        ok = hi != EOF && lo != EOF;
+        stream->data[i] = (u16)((hi << 8) | lo);
+    }
+    fclose(f);
+    if (ok) stream->length = length;
+    return ok;
+}
+
 #endif // SGP_TEST_H
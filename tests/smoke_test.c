@@ -7,6 +7,7 @@
  */
 
 #include "sgp_test.h"
+#include <string.h>
 
 // Mock SGDK function implementations
 u16 JOY_readJoypad(u16 joy) { 
@@ -23,6 +24,7 @@ void VDP_drawText(const char* str, u16 x, u16 y) {
 }
 
 void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
 
 void VDP_setHorizontalScroll(u16 bg, s16 scroll) { 
     (void)bg; (void)scroll; 
@@ -36,12 +38,27 @@ void SPR_setPosition(Sprite* sprite, s16 x, s16 y) {
     (void)sprite; (void)x; (void)y; 
 }
 
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { 
+    (void)sprite; (void)visibility; 
+}
+
+static int window_vpos_calls = 0;
+static u16 window_vpos = 0;
 void VDP_setWindowVPos(bool enable, u16 pos) { 
-    (void)enable; (void)pos; 
+    (void)enable; 
+    window_vpos_calls++; 
+    window_vpos = pos; 
 }
 
+// Debug window text tracking
+static int draw_text_calls = 0;
+static u16 last_draw_x = 0;
+static char last_draw_text[64];
 void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) { 
-    (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; 
+    (void)plane; (void)attr; (void)y; (void)method; 
+    draw_text_calls++; 
+    last_draw_x = x;
+    snprintf(last_draw_text, sizeof(last_draw_text), "%s", str); 
 }
 
 u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) { 
@@ -49,6 +66,41 @@ u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) {
     return 0; 
 }
 
+// Scripted V-counter for the profiler test
+static u16 mock_vcounter = 0;
+static int vcounter_reads = 0;
+u16 VDP_getAdjustedVCounter(void) { 
+    vcounter_reads++; 
+    return mock_vcounter; 
+}
+
+void SRAM_enable(void) {}
+
+void SRAM_enableRO(void) {}
+
+void SRAM_disable(void) {}
+
+u16 SRAM_readWord(u32 offset) { 
+    (void)offset; 
+    return 0; 
+}
+
+void SRAM_writeWord(u32 offset, u16 val) { 
+    (void)offset; (void)val; 
+}
+
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { 
+    (void)hscroll; (void)vscroll; 
+}
+
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) { 
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; 
+}
+
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) { 
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; 
+}
+
 // Required global SGP state
 SGP sgp;
 
@@ -60,10 +112,10 @@ bool test_sgp_init() {
     SGP_init();
     
     // Verify default state
-    if (sgp.input.joy1_state != 0 || 
-        sgp.input.joy2_state != 0 ||
-        sgp.input.joy1_previous != 0 ||
-        sgp.input.joy2_previous != 0) {
+    if (sgp.input.state[JOY_1] != 0 || 
+        sgp.input.state[JOY_2] != 0 ||
+        sgp.input.previous[JOY_1] != 0 ||
+        sgp.input.previous[JOY_2] != 0) {
         printf("FAIL - Input state not properly initialized\n");
         return false;
     }
@@ -87,7 +139,7 @@ bool test_input_polling() {
     SGP_PollInput();
     
     // Since JOY_readJoypad returns 0, states should remain 0
-    if (sgp.input.joy1_state != 0 || sgp.input.joy2_state != 0) {
+    if (sgp.input.state[JOY_1] != 0 || sgp.input.state[JOY_2] != 0) {
         printf("FAIL - Input polling returned unexpected values\n");
         return false;
     }
@@ -184,6 +236,96 @@ bool test_metatile_conversion() {
     return true;
 }
 
+// Scheduler jobs: every step costs 10 scanlines and logs its letter
+static char job_log[64];
+static int job_log_length = 0;
+static int ai_steps_left = 0;
+static int path_steps_this_frame = 0;
+
+static void job_spend_lines(char letter) {
+    mock_vcounter += 10;
+    if (mock_vcounter >= 262) mock_vcounter -= 262;  // NTSC frame wrap
+    if (job_log_length < (int)sizeof(job_log) - 1) job_log[job_log_length++] = letter;
+    job_log[job_log_length] = '\0';
+}
+
+static u8 ai_job(void* data) {
+    (void)data;
+    job_spend_lines('a');
+    return (--ai_steps_left > 0) ? SGP_JOB_CONTINUE : SGP_JOB_DONE;
+}
+
+static u8 path_job(void* data) {
+    (void)data;
+    job_spend_lines('p');
+    return (++path_steps_this_frame == 2) ? SGP_JOB_YIELD : SGP_JOB_CONTINUE;
+}
+
+static u8 once_job(void* data) {
+    (*(int*)data)++;
+    return SGP_JOB_DONE;
+}
+
+bool test_scheduler() {
+    printf("Testing job scheduler... ");
+    
+    static SGPScheduler sched;
+    SGP_SchedulerInit(&sched);
+    SGP_SchedulerSetStopLine(&sched, 200);
+    ai_steps_left = 30;
+    const u8 ai = SGP_SchedulerAdd(&sched, ai_job, NULL, 5);
+    const u8 path = SGP_SchedulerAdd(&sched, path_job, NULL, 1);
+    if (ai == SGP_JOB_NONE || path == SGP_JOB_NONE || ai == path) {
+        printf("FAIL - Jobs not registered\n");
+        return false;
+    }
+    
+    // Frame 1 starts in VBlank at line 230: 24 steps fit before line 200 across the wrap
+    mock_vcounter = 230;
+    job_log_length = 0;
+    path_steps_this_frame = 0;
+    if (SGP_SchedulerRun(&sched) != 24 || strncmp(job_log, "ppaaaa", 6) != 0 || mock_vcounter < 200) {
+        printf("FAIL - First frame ran '%s'\n", job_log);
+        return false;
+    }
+    
+    // Frame 2: the rest of the AI job carries over, then it finishes and frees its slot
+    mock_vcounter = 230;
+    job_log_length = 0;
+    path_steps_this_frame = 0;
+    const u16 steps = SGP_SchedulerRun(&sched);
+    if (steps != 10 || strcmp(job_log, "ppaaaaaaaa") != 0 || sched.jobs[ai].step != NULL) {
+        printf("FAIL - Carry-over ran %d steps '%s'\n", steps, job_log);
+        return false;
+    }
+    
+    // Past the stop line nothing runs
+    mock_vcounter = 205;
+    path_steps_this_frame = 0;
+    if (SGP_SchedulerRun(&sched) != 0) {
+        printf("FAIL - Ran past the stop line\n");
+        return false;
+    }
+    
+    // Remove, refill every slot, finished jobs free theirs
+    SGP_SchedulerRemove(&sched, path);
+    int once_count = 0;
+    for (int i = 0; i < SGP_SCHEDULER_MAX_JOBS; i++) SGP_SchedulerAdd(&sched, once_job, &once_count, 0);
+    if (SGP_SchedulerAdd(&sched, once_job, &once_count, 0) != SGP_JOB_NONE) {
+        printf("FAIL - Full scheduler accepted a job\n");
+        return false;
+    }
+    mock_vcounter = 0;
+    SGP_SchedulerRun(&sched);
+    if (once_count != SGP_SCHEDULER_MAX_JOBS || SGP_SchedulerAdd(&sched, once_job, &once_count, 0) != 0) {
+        printf("FAIL - Finished jobs not freed\n");
+        return false;
+    }
+    
+    printf("PASS\n");
+    return true;
+}
+
 #ifdef DEBUG
 bool test_debug_functions() {
     printf("Testing debug functions... ");
@@ -206,6 +348,168 @@ bool test_debug_functions() {
     printf("PASS\n");
     return true;
 }
+
+bool test_debug_text_buffer() {
+    printf("Testing debug text buffering... ");
+    
+    if (!SGP_isDebugEnabled()) SGP_ToggleDebug();
+    SGP_DebugFlush();
+    
+    // Same text every frame: drawn once
+    draw_text_calls = 0;
+    window_vpos_calls = 0;
+    for (int frame = 0; frame < 5; frame++) {
+        SGP_DebugPrint("HP 100", 2, 1);
+        SGP_DebugFlush();
+    }
+    if (draw_text_calls != 1 || window_vpos_calls != 0) {
+        printf("FAIL - Unchanged text redrawn (%d draws, %d vpos)\n", draw_text_calls, window_vpos_calls);
+        return false;
+    }
+    if (strcmp(last_draw_text, "HP 100") != 0 || last_draw_x != 2) {
+        printf("FAIL - Text not drawn at its column: '%s' at %d\n", last_draw_text, last_draw_x);
+        return false;
+    }
+    
+    // Shorter text blanks its own stale tail; only the changed columns are drawn
+    SGP_DebugPrint("HP 9", 2, 1);
+    if (SGP_DebugFlush() != 1 || strcmp(last_draw_text, "9  ") != 0 || last_draw_x != 5) {
+        printf("FAIL - Shorter text not padded: '%s' at %d\n", last_draw_text, last_draw_x);
+        return false;
+    }
+    
+    // Two prints on one row coexist and are not redrawn while unchanged
+    draw_text_calls = 0;
+    for (int frame = 0; frame < 5; frame++) {
+        SGP_DebugPrint("HP:", 0, 2);
+        SGP_DebugPrint("99", 20, 2);
+        SGP_DebugFlush();
+    }
+    if (draw_text_calls != 2 || strncmp(sgp_debug_lines[2].text, "HP:", 3) != 0 ||
+        strncmp(&sgp_debug_lines[2].text[20], "99", 2) != 0) {
+        printf("FAIL - Prints on one row overwrite each other (%d draws)\n", draw_text_calls);
+        return false;
+    }
+    SGP_DebugPrint("98", 20, 2);
+    SGP_DebugFlush();
+    if (draw_text_calls != 3 || strcmp(last_draw_text, "8") != 0 || last_draw_x != 21 ||
+        strncmp(sgp_debug_lines[2].text, "HP:", 3) != 0) {
+        printf("FAIL - Changed field not drawn alone: '%s' at %d\n", last_draw_text, last_draw_x);
+        return false;
+    }
+    
+    // Shorter reprint blanks its own columns past one taken by another print
+    SGP_DebugPrint("ABCDEF", 0, 4);
+    SGP_DebugPrint("XY", 2, 4);
+    SGP_DebugPrint("ABC", 0, 4);
+    SGP_DebugFlush();
+    if (strncmp(sgp_debug_lines[4].text, "ABCY  ", 6) != 0 || sgp_debug_lines[4].owner[4] != 0 ||
+        sgp_debug_lines[4].owner[5] != 0) {
+        printf("FAIL - Stale tail left after another print: '%.6s'\n", sgp_debug_lines[4].text);
+        return false;
+    }
+    
+    // Polling input never touches the VDP; the queue commit flushes debug text instead
+    SGP_DebugPrint("LV 2", 0, 3);
+    draw_text_calls = 0;
+    SGP_PollInput();
+    if (draw_text_calls != 0) {
+        printf("FAIL - SGP_PollInput drew debug text\n");
+        return false;
+    }
+    SGP_VdpQueueInit();
+    SGP_VdpQueueCommit();
+    SGP_VdpQueueDisable();
+    if (draw_text_calls != 1 || strcmp(last_draw_text, "LV 2") != 0) {
+        printf("FAIL - SGP_VdpQueueCommit did not flush debug text\n");
+        return false;
+    }
+    
+    // Window position only changes when showDebug flips; hidden rows wait
+    SGP_ToggleDebug();
+    SGP_DebugPrint("HP 8", 2, 1);
+    draw_text_calls = 0;
+    SGP_DebugFlush();
+    SGP_DebugFlush();
+    if (window_vpos_calls != 1 || window_vpos != 0 || draw_text_calls != 0) {
+        printf("FAIL - Hidden window not handled\n");
+        return false;
+    }
+    SGP_ToggleDebug();
+    SGP_DebugFlush();
+    if (window_vpos_calls != 2 || window_vpos != MAX_DEBUG_LINES + 1 || draw_text_calls != 1) {
+        printf("FAIL - Window not restored with pending row\n");
+        return false;
+    }
+    
+    printf("PASS\n");
+    return true;
+}
+
+bool test_profiler() {
+    printf("Testing scanline profiler... ");
+    
+    SGP_ProfileReset();
+    SGP_PROFILE_NAME(0, "cam");
+    SGP_PROFILE_NAME(1, "coll");
+    
+    // Frame 1: camera 10 lines, collision twice for 3 + 5 lines
+    mock_vcounter = 20;  SGP_PROFILE_BEGIN(0);
+    mock_vcounter = 30;  SGP_PROFILE_END(0);
+    mock_vcounter = 40;  SGP_PROFILE_BEGIN(1);
+    mock_vcounter = 43;  SGP_PROFILE_END(1);
+    mock_vcounter = 50;  SGP_PROFILE_BEGIN(1);
+    mock_vcounter = 55;  SGP_PROFILE_END(1);
+    SGP_PROFILE_FRAME();
+    
+    // Frame 2: camera 30 lines, wrapping past the end of the frame
+    mock_vcounter = SGP_PROFILE_FRAME_LINES - 10;  SGP_PROFILE_BEGIN(0);
+    mock_vcounter = 20;  SGP_PROFILE_END(0);
+    SGP_PROFILE_FRAME();
+    
+    if (sgp_profile[0].last != 30 || sgp_profile[0].min != 10 || sgp_profile[0].max != 30 ||
+        SGP_ProfileAverage(0) != 20) {
+        printf("FAIL - Camera zone stats wrong (last %d min %d max %d)\n",
+               sgp_profile[0].last, sgp_profile[0].min, sgp_profile[0].max);
+        return false;
+    }
+    if (sgp_profile[1].max != 8 || sgp_profile[1].last != 0 || sgp_profile[1].min != 0) {
+        printf("FAIL - Repeated zone not accumulated\n");
+        return false;
+    }
+    
+    // Overlay: one row per named zone
+    if (!SGP_isDebugEnabled()) SGP_ToggleDebug();
+    SGP_DebugFlush();
+    draw_text_calls = 0;
+    SGP_PROFILE_DRAW(0);
+    SGP_DebugFlush();
+    if (draw_text_calls != 2 || strncmp(last_draw_text, "coll   0   4   8 ", 17) != 0) {
+        printf("FAIL - Overlay text wrong: '%s'\n", last_draw_text);
+        return false;
+    }
+    
+    printf("PASS\n");
+    return true;
+}
+#else
+bool test_profiler_compiled_out() {
+    printf("Testing profiler compiles away... ");
+    
+    vcounter_reads = 0;
+    SGP_PROFILE_NAME(0, "cam");
+    SGP_PROFILE_BEGIN(0);
+    SGP_PROFILE_END(0);
+    SGP_PROFILE_FRAME();
+    SGP_PROFILE_DRAW(0);
+    if (vcounter_reads != 0 || draw_text_calls != 0) {
+        printf("FAIL - Release profiler touched the VDP\n");
+        return false;
+    }
+    
+    printf("PASS\n");
+    return true;
+}
 #endif
 
 int main() {
@@ -233,9 +537,21 @@ int main() {
     if (test_metatile_conversion()) tests_passed++;
     tests_run++;
     
+    if (test_scheduler()) tests_passed++;
+    tests_run++;
+    
 #ifdef DEBUG
     if (test_debug_functions()) tests_passed++;
     tests_run++;
+    
+    if (test_debug_text_buffer()) tests_passed++;
+    tests_run++;
+    
+    if (test_profiler()) tests_passed++;
+    tests_run++;
+#else
+    if (test_profiler_compiled_out()) tests_passed++;
+    tests_run++;
 #endif
     
     // Print summary
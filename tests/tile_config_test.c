@@ -0,0 +1,193 @@
+/*
+ * tile_config_test.c - Compile-time tile size and fixed level layout test
+ *
+ * Builds SGP with 8px collision tiles and a fixed 16x8 tile level layout, and
+ * validates that tile queries, edge checks and MoveAndCollide use the compiled
+ * dimensions.
+ */
+
+#define SGP_COLLISION_TILE_SHIFT 3 // 8x8 pixel collision tiles
+#define SGP_LEVEL_ROW_SHIFT 4      // 16 tiles per row
+#define SGP_LEVEL_ROWS 8
+#include "sgp_test.h"
+
+// Mock SGDK function implementations
+u16 JOY_readJoypad(u16 joy) { (void)joy; return 0; }
+void MAP_scrollTo(Map* map, u32 x, u32 y) { (void)map; (void)x; (void)y; }
+void VDP_drawText(const char* str, u16 x, u16 y) { (void)str; (void)x; (void)y; }
+void SYS_doVBlankProcess(void) {}
+void SYS_setVBlankCallback(void (*callback)(void)) { (void)callback; }
+void VDP_setHorizontalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
+void VDP_setVerticalScroll(u16 bg, s16 scroll) { (void)bg; (void)scroll; }
+void SPR_setPosition(Sprite* sprite, s16 x, s16 y) { (void)sprite; (void)x; (void)y; }
+void SPR_setVisibility(Sprite* sprite, u16 visibility) { (void)sprite; (void)visibility; }
+void VDP_setWindowVPos(bool enable, u16 pos) { (void)enable; (void)pos; }
+void VDP_drawTextEx(u16 plane, const char* str, u16 attr, u16 x, u16 y, u16 method) {
+    (void)plane; (void)str; (void)attr; (void)x; (void)y; (void)method; }
+u16 TILE_ATTR(u16 pal, bool priority, bool flipV, bool flipH) {
+    (void)pal; (void)priority; (void)flipV; (void)flipH; return 0; }
+u16 VDP_getAdjustedVCounter(void) { return 0; }
+void SRAM_enable(void) {}
+void SRAM_enableRO(void) {}
+void SRAM_disable(void) {}
+u16 SRAM_readWord(u32 offset) { (void)offset; return 0; }
+void SRAM_writeWord(u32 offset, u16 val) { (void)offset; (void)val; }
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll) { (void)hscroll; (void)vscroll; }
+void VDP_setHorizontalScrollLine(VDPPlane plane, u16 line, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)line; (void)values; (void)len; (void)tm; }
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, u16 tm) {
+    (void)plane; (void)tile; (void)values; (void)len; (void)tm; }
+
+// Required global SGP state
+SGP sgp;
+
+// 16x8 level of 8px tiles: side walls, a floor and a 3-tile pillar at column 8
+const u8 fixed_level_data[] = {
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  // Row 0
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  // Row 1
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  // Row 2
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  // Row 3
+    1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1,  // Row 4: pillar top
+    1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1,  // Row 5
+    1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1,  // Row 6
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1   // Row 7: floor
+};
+
+// Test result tracking
+int tests_run = 0;
+int tests_passed = 0;
+
+void print_test_result(const char* test_name, bool expected, bool actual) {
+    tests_run++;
+    bool passed = (expected == actual);
+    if (passed) tests_passed++;
+
+    printf("Test: %-40s Expected: %-5s Got: %-5s - %s\n",
+           test_name,
+           expected ? "TRUE" : "FALSE",
+           actual ? "TRUE" : "FALSE",
+           passed ? "PASS" : "FAIL");
+
+    if (!passed) {
+        printf("  *** TEST FAILED ***\n");
+    }
+}
+
+static SGPLevelCollisionData make_fixed_level(void) {
+    SGPLevelCollisionData level = {0};
+    level.row_length = 16;
+    level.data_length = sizeof(fixed_level_data);
+    level.collision_data = fixed_level_data;
+    return level;
+}
+
+void test_compiled_constants() {
+    printf("\n=== Compiled Constants ===\n");
+    print_test_result("Tile shift is 3", true, PIXELS_TO_TILE_SHIFT == 3);
+    print_test_result("Tile size is 8", true, SGP_COLLISION_TILE_SIZE == 8);
+    print_test_result("Tile mask is 7", true, COLLISION_TILE_SIZE_MASK == 7);
+    print_test_result("Map blocks stay 128px", true, SGP_MetatilesToPixels(2) == 256);
+
+    SGPLevelCollisionData level = make_fixed_level();
+    print_test_result("Row length is constant", true, SGP_LevelRowLength(&level) == 16);
+    print_test_result("Row count is constant", true, SGP_LevelTotalRows(&level) == 8);
+    print_test_result("Tile index uses fixed shift", true, SGP_LevelTileIndex(&level, 3, 2) == 35);
+}
+
+void test_fixed_prepare() {
+    printf("\n=== Fixed Layout Prepare ===\n");
+    SGPLevelCollisionData level = make_fixed_level();
+    print_test_result("Matching level prepares", true, SGP_LevelCollisionPrepare(&level, NULL));
+
+    SGPLevelCollisionData narrow = make_fixed_level();
+    narrow.row_length = 8;
+    print_test_result("Wrong row length rejected", false, SGP_LevelCollisionPrepare(&narrow, NULL));
+
+    SGPLevelCollisionData short_level = make_fixed_level();
+    short_level.data_length = 16 * 4;
+    print_test_result("Wrong row count rejected", false, SGP_LevelCollisionPrepare(&short_level, NULL));
+}
+
+void test_fixed_tile_queries() {
+    printf("\n=== Fixed Layout Tile Queries ===\n");
+    SGPLevelCollisionData raw = make_fixed_level();
+    SGPLevelCollisionData prepared = make_fixed_level();
+    SGP_LevelCollisionPrepare(&prepared, NULL);
+
+    static u16 bits[8];
+    SGPLevelCollisionData packed = prepared;
+    SGP_PackCollisionRows(fixed_level_data, 16, 8, bits);
+    packed.solid_bits = bits;
+
+    print_test_result("Pillar tile solid", true, SGP_TileIsSolidXY(&raw, 8, 5, true, true));
+    print_test_result("Tile left of pillar empty", false, SGP_TileIsSolidXY(&raw, 7, 5, true, true));
+    print_test_result("OOB right uses fixed width", true, SGP_TileIsSolidXY(&raw, 16, 2, true, false));
+    print_test_result("OOB below uses fixed rows", false, SGP_TileIsSolidXY(&raw, 4, 8, true, false));
+
+    bool all_match = true;
+    for (s16 y = -1; y <= 8; y++) {
+        for (s16 x = -1; x <= 16; x++) {
+            const bool expected = SGP_TileIsSolidXY(&raw, x, y, true, false);
+            if (SGP_TileIsSolidXY(&prepared, x, y, true, false) != expected ||
+                SGP_TileIsSolidXY(&packed, x, y, true, false) != expected) {
+                all_match = false;
+            }
+        }
+    }
+    print_test_result("Raw, prepared and packed agree", true, all_match);
+    print_test_result("Packed column span hits pillar", true,
+                      SGP_TileColumnSpanIsSolid(&packed, 8, 0, 4, true, false));
+    print_test_result("Row span misses pillar", false,
+                      SGP_TileRowSpanIsSolid(&raw, 1, 7, 5, true, false));
+}
+
+void test_fine_grained_collision() {
+    printf("\n=== 8px Tile Collision ===\n");
+    SGPLevelCollisionData level = make_fixed_level();
+    SGP_LevelCollisionPrepare(&level, NULL);
+
+    // With 16px tiles both boxes would sit in the same column; with 8px only one touches the pillar
+    print_test_result("Box flush left of pillar clear", false,
+                      SGP_LevelEdgeIsSolid(&level, 56, 40, 8, 8, SGP_DIR_RIGHT));
+    print_test_result("Box one pixel further hits pillar", true,
+                      SGP_LevelEdgeIsSolid(&level, 57, 40, 8, 8, SGP_DIR_RIGHT));
+    print_test_result("Box over pillar top lands", true,
+                      SGP_LevelEdgeIsSolid(&level, 64, 25, 8, 8, SGP_DIR_DOWN));
+
+    fix32 x = FIX32(40), y = FIX32(40);
+    u16 flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(20), FIX32(0), 8, 8);
+    print_test_result("Move right snaps to 8px pillar", true, flags == COLLIDE_RIGHT && x == FIX32(56));
+
+    x = FIX32(16); y = FIX32(8);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(100), 8, 8);
+    print_test_result("Fall snaps to 8px floor", true, flags == COLLIDE_DOWN && y == FIX32(48));
+
+    x = FIX32(64); y = FIX32(8);
+    flags = SGP_MoveAndCollide(&level, &x, &y, FIX32(0), FIX32(100), 8, 8);
+    print_test_result("Fall lands on pillar top", true, flags == COLLIDE_DOWN && y == FIX32(24));
+}
+
+int main() {
+    printf("=== SGP Tile Configuration Test Suite ===\n");
+    printf("8px collision tiles, fixed 16x8 tile level layout\n");
+
+    test_compiled_constants();
+    test_fixed_prepare();
+    test_fixed_tile_queries();
+    test_fine_grained_collision();
+
+    // Summary
+    printf("\n=== Test Summary ===\n");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_run - tests_passed);
+    printf("Success rate: %.1f%%\n", (float)tests_passed / tests_run * 100.0f);
+
+    if (tests_passed == tests_run) {
+        printf("\n✓ All tile configuration tests passed!\n");
+        return 0;
+    } else {
+        printf("\n✗ Some tile configuration tests failed!\n");
+        return 1;
+    }
+}
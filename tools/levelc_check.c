@@ -0,0 +1,192 @@
+/*
+ * levelc_check.c - Round-trip check for sgp_levelc output
+ *
+ * Links the C tables sgp_levelc compiled from examples/demo_level.tmx and checks that every
+ * format answers queries like the runtime builders would: prepared and packed raw levels,
+ * deduplicated blocks, the RLE stream and the trigger index. The --bin tables compiled from
+ * examples/demo_level.csv must hold the same data, big-endian.
+ *
+ * Build and run with: make test   (from tools/)
+ */
+
+#include <string.h>
+#include "../tests/sgp_test.h"
+#include "out/demo.h"
+
+// Test result tracking
+int tests_run = 0;
+int tests_passed = 0;
+
+void print_test_result(const char* test_name, bool expected, bool actual) {
+    tests_run++;
+    bool passed = (expected == actual);
+    if (passed) tests_passed++;
+
+    printf("Test: %-40s Expected: %-5s Got: %-5s - %s\n",
+           test_name,
+           expected ? "TRUE" : "FALSE",
+           actual ? "TRUE" : "FALSE",
+           passed ? "PASS" : "FAIL");
+
+    if (!passed) {
+        printf("  *** TEST FAILED ***\n");
+    }
+}
+
+// Reference answer: the raw table with no prepared layout
+static u8 reference_tile(u16 x, u16 y) {
+    return (x < demo_WIDTH && y < demo_HEIGHT) ? demo_tiles[y * demo_WIDTH + x] : 0;
+}
+
+void test_raw_level() {
+    printf("\n=== Prepared Raw Level ===\n");
+    SGPLevelCollisionData runtime = { .row_length = demo_WIDTH, .data_length = sizeof(demo_tiles), .collision_data = demo_tiles };
+    static u16 row_offsets[demo_HEIGHT];
+    SGP_LevelCollisionPrepare(&runtime, row_offsets);
+    print_test_result("Emitted layout matches Prepare", true,
+                      demo_level.total_rows == runtime.total_rows && demo_level.prepare_flags == runtime.prepare_flags &&
+                      demo_level.row_shift == runtime.row_shift);
+
+    bool rows_match = true;
+    for (u16 row = 0; row < demo_HEIGHT; row++) {
+        if (demo_level.row_offsets[row] != row_offsets[row]) rows_match = false;
+    }
+    print_test_result("Row offset table matches", true, rows_match);
+
+    static u16 bits[demo_HEIGHT * ((demo_WIDTH + 15) >> 4)];
+    SGP_PackCollisionRows(demo_tiles, demo_WIDTH, demo_HEIGHT, bits);
+    print_test_result("Packed rows match runtime packing", true, memcmp(bits, demo_level.solid_bits, sizeof(bits)) == 0);
+
+    SGPLevelCollisionData raw = { .row_length = demo_WIDTH, .data_length = sizeof(demo_tiles), .collision_data = demo_tiles };
+    bool all_match = true;
+    for (s16 y = -1; y <= demo_HEIGHT; y++) {
+        for (s16 x = -1; x <= demo_WIDTH; x++) {
+            if (SGP_TileIsSolidXY(&demo_level, x, y, true, false) != SGP_TileIsSolidXY(&raw, x, y, true, false)) {
+                all_match = false;
+            }
+        }
+    }
+    print_test_result("Prepared + packed queries agree", true, all_match);
+    print_test_result("Flipped Tiled GID kept solid", true, SGP_TileIsSolidXY(&demo_level, 0, 0, false, false));
+}
+
+void test_blocks_level() {
+    printf("\n=== Deduplicated Blocks ===\n");
+    SGPLevelCollisionData runtime = {0};
+    print_test_result("Block tables attach at runtime", true,
+                      SGP_LevelBlocksInit(&runtime, demo_block_map, demo_BLOCK_MAP_SHIFT, demo_block_patterns,
+                                          demo_BLOCKS_W, demo_BLOCKS_H));
+    print_test_result("Emitted layout matches BlocksInit", true,
+                      demo_blocks_level.row_length == runtime.row_length && demo_blocks_level.total_rows == runtime.total_rows &&
+                      demo_blocks_level.prepare_flags == runtime.prepare_flags);
+    print_test_result("Duplicate blocks share patterns", true, demo_BLOCK_PATTERNS < demo_BLOCKS_W * demo_BLOCKS_H);
+
+    bool all_match = true;
+    for (u16 y = 0; y < demo_blocks_level.total_rows; y++) {
+        for (u16 x = 0; x < demo_blocks_level.row_length; x++) {
+            if (SGP_LevelBlocksTile(&demo_blocks_level, x, y) != reference_tile(x, y)) all_match = false;
+        }
+    }
+    print_test_result("Block tiles match raw (zero padded)", true, all_match);
+}
+
+void test_stream_level() {
+    printf("\n=== RLE Stream ===\n");
+    static SGPCollisionStream stream;
+    SGPLevelCollisionData level = {0};
+    print_test_result("Stream attaches", true, demo_attach_stream(&level, &stream));
+
+    bool all_match = true;
+    for (u16 by = 0; by < demo_BLOCKS_H; by++) {
+        for (u16 bx = 0; bx < demo_BLOCKS_W; bx++) {
+            SGP_CollisionStreamDecodeBlock(&stream, bx, by);
+            for (u16 y = 0; y < SGP_COLLISION_BLOCK_TILES; y++) {
+                for (u16 x = 0; x < SGP_COLLISION_BLOCK_TILES; x++) {
+                    const u16 tx = (bx << SGP_COLLISION_BLOCK_SHIFT) + x;
+                    const u16 ty = (by << SGP_COLLISION_BLOCK_SHIFT) + y;
+                    if (SGP_CollisionStreamTile(&stream, tx, ty) != reference_tile(tx, ty)) all_match = false;
+                }
+            }
+        }
+    }
+    print_test_result("Decoded blocks match raw", true, all_match);
+}
+
+void test_triggers() {
+    printf("\n=== Trigger Index ===\n");
+    SGPTriggerLayer layer;
+    print_test_result("Emitted triggers are sorted", true, SGP_TriggerLayerInit(&layer, demo_triggers, demo_TRIGGER_COUNT));
+    print_test_result("Layer holds every trigger", true, demo_trigger_layer.count == demo_TRIGGER_COUNT);
+
+    const u16 coin = SGP_TriggerLayerFind(&demo_trigger_layer, 27, 5);
+    print_test_result("Coin found with its type", true, coin != SGP_TRIGGER_NONE && demo_triggers[coin].type == 3);
+    print_test_result("Empty tile has no trigger", true, SGP_TriggerLayerFind(&demo_trigger_layer, 28, 5) == SGP_TRIGGER_NONE);
+
+    // Spikes fill the pit at 16px per tile: x 528..575, y 192..207
+    SGPBox pit = { 528, 192, 48, 16 };
+    u16 hits[8];
+    print_test_result("Pit box finds three spikes", true, SGP_TriggerLayerQuery(&demo_trigger_layer, &pit, hits, 8) == 3);
+}
+
+// Compares a big-endian .bin against a host table of `bytes`-wide values
+static bool bin_matches(const char* path, const void* data, u32 count, unsigned bytes) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    bool match = true;
+    for (u32 i = 0; i < count && match; i++) {
+        u32 v = 0;
+        for (unsigned b = 0; b < bytes; b++) {
+            const int c = fgetc(f);
+            if (c == EOF) match = false;
+            v = (v << 8) | (u32)(c & 0xFF);
+        }
+        const u32 expected = (bytes == 1) ? ((const u8*)data)[i] : (bytes == 2) ? ((const u16*)data)[i] : ((const u32*)data)[i];
+        if (v != expected) match = false;
+    }
+    if (fgetc(f) != EOF) match = false;
+    fclose(f);
+    return match;
+}
+
+void test_binary_tables() {
+    printf("\n=== rescomp Binary Tables (CSV input) ===\n");
+    print_test_result("Tiles match", true, bin_matches("out/demo_bin_tiles.bin", demo_tiles, sizeof(demo_tiles), 1));
+    print_test_result("Row offsets match", true, bin_matches("out/demo_bin_row_offsets.bin", demo_level.row_offsets, demo_HEIGHT, 2));
+    print_test_result("Packed rows match", true,
+                      bin_matches("out/demo_bin_solid_bits.bin", demo_level.solid_bits, demo_HEIGHT * ((demo_WIDTH + 15) >> 4), 2));
+
+    u16 block_map[demo_BLOCKS_H << demo_BLOCK_MAP_SHIFT];
+    for (u16 i = 0; i < (demo_BLOCKS_H << demo_BLOCK_MAP_SHIFT); i++) block_map[i] = demo_block_map[i];
+    print_test_result("Block map matches", true, bin_matches("out/demo_bin_block_map.bin", block_map, demo_BLOCKS_H << demo_BLOCK_MAP_SHIFT, 2));
+    print_test_result("Block patterns match", true,
+                      bin_matches("out/demo_bin_block_patterns.bin", demo_block_patterns,
+                                  demo_BLOCK_PATTERNS * SGP_COLLISION_BLOCK_TILES * SGP_COLLISION_BLOCK_TILES, 1));
+    print_test_result("Stream RLE matches", true, bin_matches("out/demo_bin_stream_rle.bin", demo_stream_rle, sizeof(demo_stream_rle), 1));
+    print_test_result("Stream offsets match", true,
+                      bin_matches("out/demo_bin_stream_offsets.bin", demo_stream_offsets, demo_BLOCKS_W * demo_BLOCKS_H, 4));
+    print_test_result("Triggers match", true, bin_matches("out/demo_bin_triggers.bin", demo_triggers, demo_TRIGGER_COUNT * 4, 2));
+}
+
+int main() {
+    printf("=== SGP Level Compiler Check ===\n");
+
+    test_raw_level();
+    test_blocks_level();
+    test_stream_level();
+    test_triggers();
+    test_binary_tables();
+
+    // Summary
+    printf("\n=== Test Summary ===\n");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_run - tests_passed);
+
+    if (tests_passed == tests_run) {
+        printf("\n✓ All level compiler checks passed!\n");
+        return 0;
+    } else {
+        printf("\n✗ Some level compiler checks failed!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,617 @@
+/*
+ * sgp_levelc.c - Host-side level collision compiler for SGP
+ *
+ * Reads a collision layer from a CSV grid or a Tiled .tmx map (CSV layer format) and emits
+ * ready-to-query SGP tables, so a game links them straight from ROM with no preprocessing at
+ * boot. The tables are produced by the same sgp.h builders the game queries with:
+ *
+ *   raw       byte-per-tile collision_data with the prepared layout (SGP_LevelCollisionPrepare)
+ *   packed    1 bit per tile rows for the raw level (SGP_PackCollisionRows)
+ *   blocks    block map + unique block patterns (SGP_LevelBlocksBuild)
+ *   stream    RLE blocks + offsets for SGP_CollisionStreamInit (SGP_CollisionStreamEncode)
+ *   triggers  sorted trigger index (SGP_TriggerSort) from a second grid or layer
+ *
+ * Output is C (<out>.c + <out>.h) by default, or big-endian .bin files with a rescomp .res
+ * and an <out>_level.h attach header with --bin.
+ *
+ * Build with: make   (from tools/; pass TILE_SHIFT=3 for 8px collision tiles)
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../tests/sgp_test.h"
+
+#define LEVELC_RAW (1 << 0)
+#define LEVELC_PACKED (1 << 1)
+#define LEVELC_BLOCKS (1 << 2)
+#define LEVELC_STREAM (1 << 3)
+#define LEVELC_TRIGGERS (1 << 4)
+#define LEVELC_TILED_FLIP_MASK 0x1FFFFFFFUL // Tiled stores flip flags in the top GID bits
+
+// Collision grid read from the input
+typedef struct
+{
+    u16 width;
+    u16 height;
+    u8 *cells;
+} LevelGrid;
+
+typedef struct
+{
+    const char *input;
+    const char *out;
+    const char *name;
+    const char *layer;
+    const char *trigger_input;
+    const char *trigger_layer;
+    unsigned formats;
+    unsigned long firstgid;
+    bool binary;
+    bool bin_output;
+    u8 pad;
+} LevelOptions;
+
+static void die(const char *message, const char *detail)
+{
+    fprintf(stderr, "sgp_levelc: %s%s%s\n", message, detail ? ": " : "", detail ? detail : "");
+    exit(1);
+}
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        die("cannot open", path);
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (!text || fread(text, 1, (size_t)size, f) != (size_t)size)
+        die("cannot read", path);
+    text[size] = '\0';
+    fclose(f);
+    return text;
+}
+
+static bool has_suffix(const char *s, const char *suffix)
+{
+    const size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+//----------------------------------------------------------------------------------
+// Input: CSV grids and Tiled CSV layers
+//----------------------------------------------------------------------------------
+// Tiled GID (or plain CSV value) to a collision byte: 0 stays empty, firstgid maps to 1
+static u8 cell_value(unsigned long gid, const LevelOptions *opt, bool binary)
+{
+    gid &= LEVELC_TILED_FLIP_MASK;
+    if (gid == 0)
+        return 0;
+    if (gid < opt->firstgid)
+        die("value below --firstgid", NULL);
+    const unsigned long value = gid - opt->firstgid + 1;
+    if (value > 255)
+        die("collision value over 255 (use --binary or --firstgid)", NULL);
+    return binary ? (u8)SOLID_TILE : (u8)value;
+}
+
+// Parses comma/whitespace separated rows up to `end` (NULL = end of text)
+static void parse_csv(const char *text, const char *end, LevelGrid *grid, const LevelOptions *opt, bool binary)
+{
+    size_t capacity = 1024, count = 0;
+    u8 *cells = malloc(capacity);
+    u16 width = 0, height = 0, row_count = 0;
+    const char *p = text;
+    if (!end)
+        end = text + strlen(text);
+
+    while (p < end)
+    {
+        if (*p >= '0' && *p <= '9')
+        {
+            char *next;
+            const unsigned long gid = strtoul(p, &next, 10);
+            if (count == capacity)
+                cells = realloc(cells, capacity *= 2);
+            cells[count++] = cell_value(gid, opt, binary);
+            row_count++;
+            p = next;
+            continue;
+        }
+        if (*p == '\n' && row_count > 0)
+        {
+            if (width == 0)
+                width = row_count;
+            else if (row_count != width)
+                die("rows have different lengths", NULL);
+            height++;
+            row_count = 0;
+        }
+        else if (*p != ',' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            die("unexpected character in CSV data", NULL);
+        p++;
+    }
+    if (row_count > 0)
+    {
+        if (width == 0)
+            width = row_count;
+        else if (row_count != width)
+            die("rows have different lengths", NULL);
+        height++;
+    }
+    if (width == 0 || height == 0)
+        die("empty collision grid", NULL);
+    grid->width = width;
+    grid->height = height;
+    grid->cells = cells;
+}
+
+// Value of attribute `name` inside one tag, copied into dst
+static bool tag_attribute(const char *tag, const char *tag_end, const char *name, char *dst, size_t size)
+{
+    char key[64];
+    snprintf(key, sizeof(key), " %s=\"", name);
+    const char *p = strstr(tag, key);
+    if (!p || p > tag_end)
+        return false;
+    p += strlen(key);
+    size_t n = 0;
+    while (*p && *p != '"' && n + 1 < size)
+        dst[n++] = *p++;
+    dst[n] = '\0';
+    return true;
+}
+
+// Finds a <layer> by name (NULL = first) and parses its CSV <data>
+static void parse_tmx(const char *text, const char *layer_name, LevelGrid *grid, const LevelOptions *opt, bool binary)
+{
+    for (const char *tag = strstr(text, "<layer"); tag; tag = strstr(tag + 1, "<layer"))
+    {
+        const char *tag_end = strchr(tag, '>');
+        char name[128] = "", value[32];
+        if (!tag_end)
+            break;
+        tag_attribute(tag, tag_end, "name", name, sizeof(name));
+        if (layer_name && strcmp(name, layer_name) != 0)
+            continue;
+
+        const char *data = strstr(tag_end, "<data");
+        const char *data_end = data ? strchr(data, '>') : NULL;
+        const char *close = data_end ? strstr(data_end, "</data>") : NULL;
+        if (!close)
+            die("layer has no <data>", name);
+        if (!tag_attribute(data, data_end, "encoding", value, sizeof(value)) || strcmp(value, "csv") != 0)
+            die("layer data is not CSV (set Tile Layer Format to CSV in Tiled)", name);
+        parse_csv(data_end + 1, close, grid, opt, binary);
+
+        if (tag_attribute(tag, tag_end, "width", value, sizeof(value)) && (u16)atoi(value) != grid->width)
+            die("layer width does not match its data", name);
+        return;
+    }
+    die("layer not found", layer_name ? layer_name : "(first layer)");
+}
+
+// Collision grids honour --binary; trigger grids keep their values as trigger types
+static void read_grid(const char *path, const char *layer, LevelGrid *grid, const LevelOptions *opt, bool binary)
+{
+    char *text = read_file(path);
+    if (has_suffix(path, ".tmx"))
+        parse_tmx(text, layer, grid, opt, binary);
+    else
+        parse_csv(text, NULL, grid, opt, binary);
+    free(text);
+}
+
+// Copy of a grid padded to whole collision blocks on the right and bottom
+static LevelGrid pad_to_blocks(const LevelGrid *grid, u8 pad)
+{
+    LevelGrid out;
+    out.width = (u16)((grid->width + SGP_COLLISION_BLOCK_MASK) & ~SGP_COLLISION_BLOCK_MASK);
+    out.height = (u16)((grid->height + SGP_COLLISION_BLOCK_MASK) & ~SGP_COLLISION_BLOCK_MASK);
+    out.cells = malloc((size_t)out.width * out.height);
+    for (u32 y = 0; y < out.height; y++)
+        for (u32 x = 0; x < out.width; x++)
+            out.cells[y * out.width + x] = (x < grid->width && y < grid->height) ? grid->cells[y * grid->width + x] : pad;
+    if (out.width != grid->width || out.height != grid->height)
+        fprintf(stderr, "sgp_levelc: block formats padded to %ux%u tiles\n", out.width, out.height);
+    return out;
+}
+
+//----------------------------------------------------------------------------------
+// Output helpers
+//----------------------------------------------------------------------------------
+static FILE *open_output(const char *base, const char *suffix)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s%s", base, suffix);
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        die("cannot write", path);
+    return f;
+}
+
+static const char *base_name(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// C array of `count` values of `bytes` each (1, 2 or 4)
+static void emit_array(FILE *f, const char *type, const char *name, const char *suffix, const void *data, u32 count, unsigned bytes)
+{
+    const unsigned per_line = (bytes == 1) ? 16 : 8;
+    fprintf(f, "const %s %s%s[%lu] = {", type, name, suffix, (unsigned long)count);
+    for (u32 i = 0; i < count; i++)
+    {
+        if (i % per_line == 0)
+            fprintf(f, "\n   ");
+        if (bytes == 1)
+            fprintf(f, " 0x%02X,", ((const u8 *)data)[i]);
+        else if (bytes == 2)
+            fprintf(f, " 0x%04X,", ((const u16 *)data)[i]);
+        else
+            fprintf(f, " 0x%08lX,", (unsigned long)((const u32 *)data)[i]);
+    }
+    fprintf(f, "\n};\n\n");
+}
+
+// Big-endian binary table for rescomp BIN resources
+static void emit_bin(const char *out, const char *suffix, const void *data, u32 count, unsigned bytes)
+{
+    char file_suffix[64];
+    snprintf(file_suffix, sizeof(file_suffix), "%s.bin", suffix);
+    FILE *f = open_output(out, file_suffix);
+    for (u32 i = 0; i < count; i++)
+    {
+        const u32 v = (bytes == 1) ? ((const u8 *)data)[i] : (bytes == 2) ? ((const u16 *)data)[i] : ((const u32 *)data)[i];
+        for (int shift = (int)(bytes - 1) * 8; shift >= 0; shift -= 8)
+            fputc((int)((v >> shift) & 0xFF), f);
+    }
+    fclose(f);
+}
+
+// Table as a C array declared in the header, or as a .bin listed in the .res
+static void emit_table(FILE *c_file, FILE *h_file, FILE *res, const LevelOptions *opt, const char *type, const char *suffix, const void *data, u32 count, unsigned bytes)
+{
+    if (opt->bin_output)
+    {
+        emit_bin(opt->out, suffix, data, count, bytes);
+        fprintf(res, "BIN %s%s \"%s%s.bin\" 2\n", opt->name, suffix, base_name(opt->out), suffix);
+    }
+    else
+    {
+        emit_array(c_file, type, opt->name, suffix, data, count, bytes);
+        fprintf(h_file, "extern const %s %s%s[%lu];\n", type, opt->name, suffix, (unsigned long)count);
+    }
+}
+
+// Pointer to a table: the C symbol, or a cast of the u8 array rescomp emits for a BIN resource
+static const char *table_ref(const LevelOptions *opt, const char *type, const char *suffix, char dst[256])
+{
+    if (opt->bin_output)
+        snprintf(dst, 256, "(const %s *)%s%s", type, opt->name, suffix);
+    else
+        snprintf(dst, 256, "%s%s", opt->name, suffix);
+    return dst;
+}
+
+static void prepare_flag_names(u8 flags, char *dst, size_t size)
+{
+    snprintf(dst, size, "SGP_LEVEL_PREPARED%s%s",
+             (flags & SGP_LEVEL_POW2_ROWS) ? " | SGP_LEVEL_POW2_ROWS" : "",
+             (flags & SGP_LEVEL_ROW_TABLE) ? " | SGP_LEVEL_ROW_TABLE" : "");
+}
+
+// Compile-time checks that the game's SGP configuration matches the tables
+static void emit_layout_checks(FILE *f, const char *name, u16 width, u16 height)
+{
+    fprintf(f, "#if defined(SGP_LEVEL_ROW_SHIFT) && SGP_LEVEL_ROW_LENGTH != %u\n", width);
+    fprintf(f, "#error \"%s: SGP_LEVEL_ROW_SHIFT does not match the %u tile row length\"\n#endif\n", name, width);
+    fprintf(f, "#if defined(SGP_LEVEL_ROWS) && SGP_LEVEL_ROWS != %u\n", height);
+    fprintf(f, "#error \"%s: SGP_LEVEL_ROWS does not match the %u rows\"\n#endif\n", name, height);
+}
+
+//----------------------------------------------------------------------------------
+// Compiler
+//----------------------------------------------------------------------------------
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: sgp_levelc [options] input.csv|input.tmx -o out -n name\n"
+            "  -o OUT             output base path (writes OUT.c and OUT.h)\n"
+            "  -n NAME            C symbol prefix\n"
+            "  -f LIST            formats: raw,packed,blocks,stream,triggers (default raw,packed)\n"
+            "  --layer NAME       .tmx collision layer (default: first layer)\n"
+            "  --triggers FILE    CSV grid or .tmx whose nonzero cells become triggers (type = value)\n"
+            "  --trigger-layer N  .tmx layer for --triggers\n"
+            "  --firstgid N       Tiled GID that maps to collision value 1 (default 1)\n"
+            "  --binary           every nonzero cell becomes SOLID_TILE\n"
+            "  --pad N            value for cells added to round block formats up (default 0)\n"
+            "  --bin              big-endian .bin tables + OUT.res for rescomp + OUT_level.h\n"
+            "Tables match SGP_COLLISION_TILE_SHIFT %d (rebuild with TILE_SHIFT=N for another size).\n",
+            SGP_COLLISION_TILE_SHIFT);
+    exit(1);
+}
+
+static unsigned parse_formats(const char *list)
+{
+    unsigned formats = 0;
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    for (char *item = strtok(buffer, ","); item; item = strtok(NULL, ","))
+    {
+        if (strcmp(item, "raw") == 0)
+            formats |= LEVELC_RAW;
+        else if (strcmp(item, "packed") == 0)
+            formats |= LEVELC_RAW | LEVELC_PACKED;
+        else if (strcmp(item, "blocks") == 0)
+            formats |= LEVELC_BLOCKS;
+        else if (strcmp(item, "stream") == 0)
+            formats |= LEVELC_STREAM;
+        else if (strcmp(item, "triggers") == 0)
+            formats |= LEVELC_TRIGGERS;
+        else
+            die("unknown format", item);
+    }
+    return formats;
+}
+
+static void parse_options(int argc, char **argv, LevelOptions *opt)
+{
+    memset(opt, 0, sizeof(*opt));
+    opt->formats = LEVELC_RAW | LEVELC_PACKED;
+    opt->firstgid = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--binary") == 0)
+            opt->binary = true;
+        else if (strcmp(arg, "--bin") == 0)
+            opt->bin_output = true;
+        else if (arg[0] == '-' && !value)
+            usage();
+        else if (strcmp(arg, "-o") == 0)
+            opt->out = argv[++i];
+        else if (strcmp(arg, "-n") == 0)
+            opt->name = argv[++i];
+        else if (strcmp(arg, "-f") == 0)
+            opt->formats = parse_formats(argv[++i]);
+        else if (strcmp(arg, "--layer") == 0)
+            opt->layer = argv[++i];
+        else if (strcmp(arg, "--triggers") == 0)
+            opt->trigger_input = argv[++i];
+        else if (strcmp(arg, "--trigger-layer") == 0)
+            opt->trigger_layer = argv[++i];
+        else if (strcmp(arg, "--firstgid") == 0)
+            opt->firstgid = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(arg, "--pad") == 0)
+            opt->pad = (u8)strtoul(argv[++i], NULL, 10);
+        else if (arg[0] == '-')
+            usage();
+        else
+            opt->input = arg;
+    }
+    if (!opt->input || !opt->out || !opt->name || opt->firstgid == 0)
+        usage();
+    if ((opt->formats & LEVELC_TRIGGERS) && !opt->trigger_input)
+        die("the triggers format needs --triggers", NULL);
+    if (opt->trigger_input && !(opt->formats & LEVELC_TRIGGERS))
+        opt->formats |= LEVELC_TRIGGERS;
+}
+
+int main(int argc, char **argv)
+{
+    LevelOptions opt;
+    LevelGrid grid;
+    parse_options(argc, argv, &opt);
+    read_grid(opt.input, opt.layer, &grid, &opt, opt.binary);
+    const u32 tiles = (u32)grid.width * grid.height;
+    const char *name = opt.name;
+
+    FILE *h = open_output(opt.out, opt.bin_output ? "_level.h" : ".h");
+    FILE *c = opt.bin_output ? NULL : open_output(opt.out, ".c");
+    FILE *res = opt.bin_output ? open_output(opt.out, ".res") : NULL;
+
+    fprintf(h, "/* Generated by sgp_levelc from %s - do not edit */\n", base_name(opt.input));
+    char guard[128];
+    size_t g = 0;
+    for (; name[g] && g + 1 < sizeof(guard); g++)
+        guard[g] = (char)toupper((unsigned char)name[g]);
+    guard[g] = '\0';
+    fprintf(h, "#ifndef %s_LEVEL_H\n#define %s_LEVEL_H\n\n#include \"sgp.h\"\n", guard, guard);
+    if (opt.bin_output)
+        fprintf(h, "#include \"%s.h\" // rescomp output for %s.res\n", base_name(opt.out), base_name(opt.out));
+    fprintf(h, "\n#define %s_WIDTH %u  // Tiles\n#define %s_HEIGHT %u\n\n", name, grid.width, name, grid.height);
+    if (c)
+        fprintf(c, "/* Generated by sgp_levelc from %s - do not edit */\n#include \"%s.h\"\n\n", base_name(opt.input), base_name(opt.out));
+    fprintf(c ? c : h, "#if SGP_COLLISION_TILE_SHIFT != %d\n#error \"%s: tables built for SGP_COLLISION_TILE_SHIFT %d\"\n#endif\n\n",
+            SGP_COLLISION_TILE_SHIFT, name, SGP_COLLISION_TILE_SHIFT);
+    if (res)
+        fprintf(res, "// Generated by sgp_levelc from %s - do not edit\n", base_name(opt.input));
+
+    if (opt.formats & LEVELC_RAW)
+    {
+        if (tiles > 0xFFFF)
+            die("raw and packed levels are limited to 65535 tiles (use blocks or stream)", NULL);
+        static u16 row_offsets[0x10000];
+        SGPLevelCollisionData level = { .row_length = grid.width, .data_length = (u16)tiles, .collision_data = grid.cells };
+        const bool pow2 = (grid.width & (grid.width - 1)) == 0;
+        SGP_LevelCollisionPrepare(&level, pow2 ? NULL : row_offsets);
+        char flags[96], offsets_ref[256], bits_ref[256];
+        prepare_flag_names(level.prepare_flags, flags, sizeof(flags));
+        table_ref(&opt, "u16", "_row_offsets", offsets_ref);
+        table_ref(&opt, "u16", "_solid_bits", bits_ref);
+
+        emit_table(c, h, res, &opt, "u8", "_tiles", grid.cells, tiles, 1);
+        if (!pow2)
+            emit_table(c, h, res, &opt, "u16", "_row_offsets", row_offsets, level.total_rows, 2);
+        u16 *bits = NULL;
+        if (opt.formats & LEVELC_PACKED)
+        {
+            const u32 words = (u32)SGP_LevelBitRowWords(grid.width) * grid.height;
+            bits = calloc(words, sizeof(u16));
+            SGP_PackCollisionRows(grid.cells, grid.width, grid.height, bits);
+            emit_table(c, h, res, &opt, "u16", "_solid_bits", bits, words, 2);
+        }
+
+        if (!opt.bin_output)
+        {
+            fprintf(h, "extern const SGPLevelCollisionData %s_level; // Prepared%s\n", name, bits ? ", packed rows" : "");
+            emit_layout_checks(c, name, grid.width, grid.height);
+            fprintf(c, "const SGPLevelCollisionData %s_level = {\n", name);
+            fprintf(c, "    .row_length = %u,\n    .data_length = %lu,\n    .collision_data = %s_tiles,\n", grid.width, (unsigned long)tiles, name);
+            fprintf(c, "    .total_rows = %u,\n    .prepare_flags = %s,\n    .row_shift = %u,\n", level.total_rows, flags, level.row_shift);
+            fprintf(c, "    .row_offsets = %s,\n    .solid_bits = %s,\n};\n\n", pow2 ? "NULL" : offsets_ref,
+                    bits ? bits_ref : "NULL");
+        }
+        else
+        {
+            emit_layout_checks(h, name, grid.width, grid.height);
+            fprintf(h, "// Fills a level from the ROM tables: prepared layout%s, no runtime preprocessing\n", bits ? " and packed rows" : "");
+            fprintf(h, "static inline void %s_attach_level(SGPLevelCollisionData *level)\n{\n", name);
+            fprintf(h, "    level->row_length = %u;\n    level->data_length = %lu;\n    level->collision_data = %s_tiles;\n", grid.width, (unsigned long)tiles, name);
+            fprintf(h, "    level->total_rows = %u;\n    level->prepare_flags = %s;\n    level->row_shift = %u;\n", level.total_rows, flags, level.row_shift);
+            fprintf(h, "    level->row_offsets = %s;\n", pow2 ? "NULL" : offsets_ref);
+            fprintf(h, "    level->solid_bits = %s;\n}\n\n", bits ? bits_ref : "NULL");
+        }
+        free(bits);
+    }
+
+    if (opt.formats & (LEVELC_BLOCKS | LEVELC_STREAM))
+    {
+        const LevelGrid padded = pad_to_blocks(&grid, opt.pad);
+        const u16 blocks_w = padded.width >> SGP_COLLISION_BLOCK_SHIFT;
+        const u16 blocks_h = padded.height >> SGP_COLLISION_BLOCK_SHIFT;
+        const u32 block_count = (u32)blocks_w * blocks_h;
+        const u32 block_size = SGP_COLLISION_BLOCK_TILES * SGP_COLLISION_BLOCK_TILES;
+        if (blocks_w > SGP_COLLISION_MAX_BLOCKS || blocks_h > SGP_COLLISION_MAX_BLOCKS || blocks_w > 256)
+            die("level exceeds SGP_COLLISION_MAX_BLOCKS blocks per axis", NULL);
+        fprintf(h, "#define %s_BLOCKS_W %u  // Level size in collision blocks (padded)\n#define %s_BLOCKS_H %u\n\n", name, blocks_w, name, blocks_h);
+
+        if (opt.formats & LEVELC_BLOCKS)
+        {
+            u8 map_shift = 0;
+            while ((1u << map_shift) < blocks_w)
+                map_shift++;
+            const u32 map_entries = (u32)blocks_h << map_shift;
+            SGPBlockIndex *block_map = calloc(map_entries, sizeof(SGPBlockIndex));
+            // Every block may be unique, up to what a block map entry can index (65535 at 256x256 blocks)
+            const u16 capacity = (block_count > SGP_BLOCK_INDEX_MAX_PATTERNS) ? SGP_BLOCK_INDEX_MAX_PATTERNS : (u16)block_count;
+            u8 *patterns = malloc((u32)capacity * block_size);
+            const u16 pattern_count = SGP_LevelBlocksBuild(padded.cells, padded.width, padded.height, block_map, map_shift, patterns, capacity);
+            if (pattern_count == 0)
+                die("level has more unique collision blocks than a block map can index", NULL);
+            u16 *map16 = malloc(map_entries * sizeof(u16));
+            for (u32 i = 0; i < map_entries; i++)
+                map16[i] = block_map[i];
+
+            const char *index_type = opt.bin_output ? "u16" : "SGPBlockIndex";
+            if (opt.bin_output)
+                fprintf(h, "#ifdef SGP_BLOCK_INDEX_U8\n#error \"%s: --bin block maps are u16, build without SGP_BLOCK_INDEX_U8\"\n#endif\n", name);
+            else if (pattern_count > 256)
+                fprintf(c, "#ifdef SGP_BLOCK_INDEX_U8\n#error \"%s: %u block patterns do not fit SGP_BLOCK_INDEX_U8\"\n#endif\n", name, pattern_count);
+            if (opt.bin_output)
+                emit_table(c, h, res, &opt, index_type, "_block_map", map16, map_entries, 2);
+            else
+            {
+                // SGPBlockIndex width is chosen by the game's build, so emit plain values
+                fprintf(c, "const SGPBlockIndex %s_block_map[%lu] = {", name, (unsigned long)map_entries);
+                for (u32 i = 0; i < map_entries; i++)
+                    fprintf(c, "%s %u,", (i % 16 == 0) ? "\n   " : "", map16[i]);
+                fprintf(c, "\n};\n\n");
+                fprintf(h, "extern const SGPBlockIndex %s_block_map[%lu];\n", name, (unsigned long)map_entries);
+            }
+            emit_table(c, h, res, &opt, "u8", "_block_patterns", patterns, (u32)pattern_count * block_size, 1);
+            fprintf(h, "#define %s_BLOCK_MAP_SHIFT %u\n#define %s_BLOCK_PATTERNS %u  // Unique blocks\n\n", name, map_shift, name, pattern_count);
+
+            if (!opt.bin_output)
+            {
+                fprintf(h, "extern const SGPLevelCollisionData %s_blocks_level; // Deduplicated\n", name);
+                emit_layout_checks(c, name, padded.width, padded.height);
+                fprintf(c, "const SGPLevelCollisionData %s_blocks_level = {\n", name);
+                fprintf(c, "    .row_length = %u,\n    .total_rows = %u,\n    .prepare_flags = SGP_LEVEL_PREPARED,\n", padded.width, padded.height);
+                fprintf(c, "    .block_map = %s_block_map,\n    .block_patterns = %s_block_patterns,\n    .block_map_shift = %u,\n};\n\n", name, name, map_shift);
+            }
+            else
+            {
+                fprintf(h, "static inline bool %s_attach_blocks(SGPLevelCollisionData *level)\n{\n", name);
+                fprintf(h, "    return SGP_LevelBlocksInit(level, (const SGPBlockIndex *)%s_block_map, %u, %s_block_patterns, %u, %u);\n}\n\n",
+                        name, map_shift, name, blocks_w, blocks_h);
+            }
+            fprintf(stderr, "sgp_levelc: %lu blocks, %u unique patterns\n", (unsigned long)block_count, pattern_count);
+            free(block_map);
+            free(map16);
+            free(patterns);
+        }
+
+        if (opt.formats & LEVELC_STREAM)
+        {
+            char rle_ref[256], offsets_ref[256];
+            u8 *rle = malloc(block_count * block_size * 2);
+            u32 *offsets = malloc(block_count * sizeof(u32));
+            const u32 rle_size = SGP_CollisionStreamEncode(padded.cells, padded.width, padded.height, rle, offsets);
+            emit_table(c, h, res, &opt, "u8", "_stream_rle", rle, rle_size, 1);
+            emit_table(c, h, res, &opt, "u32", "_stream_offsets", offsets, block_count, 4);
+            // The stream holds the RAM cache, so it is attached at load time rather than emitted
+            fprintf(h, "#define %s_attach_stream(level, stream) \\\n    SGP_CollisionStreamInit((level), (stream), %s, %s, %u, %u)\n\n",
+                    name, table_ref(&opt, "u8", "_stream_rle", rle_ref), table_ref(&opt, "u32", "_stream_offsets", offsets_ref), blocks_w, blocks_h);
+            fprintf(stderr, "sgp_levelc: %lu tiles stream as %lu bytes\n", (unsigned long)((u32)padded.width * padded.height), (unsigned long)rle_size);
+            free(rle);
+            free(offsets);
+        }
+        free(padded.cells);
+    }
+
+    if (opt.formats & LEVELC_TRIGGERS)
+    {
+        LevelGrid marks;
+        read_grid(opt.trigger_input, opt.trigger_layer, &marks, &opt, false);
+        if (marks.width != grid.width || marks.height != grid.height)
+            die("trigger grid size differs from the collision grid", opt.trigger_input);
+        u16 count = 0;
+        SGPTrigger *triggers = malloc((size_t)tiles * sizeof(SGPTrigger));
+        for (u16 y = 0; y < marks.height; y++)
+        {
+            for (u16 x = 0; x < marks.width; x++)
+            {
+                const u8 type = marks.cells[(u32)y * marks.width + x];
+                if (!type)
+                    continue;
+                if (count == SGP_TRIGGER_NONE - 1)
+                    die("too many triggers", NULL);
+                triggers[count] = (SGPTrigger){ y, x, type, count };
+                count++;
+            }
+        }
+        SGP_TriggerSort(triggers, count);
+        if (opt.bin_output)
+        {
+            emit_table(c, h, res, &opt, "u16", "_triggers", triggers, (u32)count * 4, 2);
+            fprintf(h, "static inline bool %s_attach_triggers(SGPTriggerLayer *layer)\n{\n", name);
+            fprintf(h, "    return SGP_TriggerLayerInit(layer, (const SGPTrigger *)%s_triggers, %u);\n}\n\n", name, count);
+        }
+        else
+        {
+            fprintf(c, "const SGPTrigger %s_triggers[%u] = {\n", name, count ? count : 1);
+            for (u16 i = 0; i < count; i++)
+                fprintf(c, "    { %u, %u, %u, %u },\n", triggers[i].tile_y, triggers[i].tile_x, triggers[i].type, triggers[i].id);
+            fprintf(c, "};\n\nconst SGPTriggerLayer %s_trigger_layer = { %s_triggers, %u };\n\n", name, name, count);
+            fprintf(h, "extern const SGPTrigger %s_triggers[];\nextern const SGPTriggerLayer %s_trigger_layer; // Sorted, type = cell value, id = row-major order\n", name, name);
+        }
+        fprintf(h, "#define %s_TRIGGER_COUNT %u\n\n", name, count);
+        free(triggers);
+        free(marks.cells);
+    }
+
+    fprintf(h, "#endif\n");
+    fclose(h);
+    if (c)
+        fclose(c);
+    if (res)
+        fclose(res);
+    free(grid.cells);
+    return 0;
+}